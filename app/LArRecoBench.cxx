@@ -0,0 +1,369 @@
+/**
+ *  @file   LArReco/app/LArRecoBench.cxx
+ *
+ *  @brief  Implementation of the lar reco throughput benchmark
+ *
+ *  $Log: $
+ */
+
+#include "Api/PandoraApi.h"
+
+#include "larpandoracontent/LArControlFlow/MultiPandoraApi.h"
+
+#include "LArRecoBench.h"
+#include "PfoColumnFormat.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+
+using namespace pandora;
+using namespace lar_reco;
+
+int main(int argc, char *argv[])
+{
+    BenchParameters benchParameters;
+
+    if (!ParseBenchCommandLine(argc, argv, benchParameters))
+        return 1;
+
+    BenchResults benchResults;
+
+    try
+    {
+        RunBench(benchParameters, benchResults);
+    }
+    catch (const StatusCodeException &statusCodeException)
+    {
+        std::cerr << "Pandora StatusCodeException: " << statusCodeException.ToString() << statusCodeException.GetBackTrace() << std::endl;
+        return 1;
+    }
+
+    StringVector slowdowns;
+
+    if (!benchParameters.m_baselineFileName.empty() && !CompareWithBaseline(benchParameters, benchResults, slowdowns))
+        return 1;
+
+    const std::string report(MakeBenchReport(benchParameters, benchResults, slowdowns));
+
+    if (benchParameters.m_reportFileName.empty())
+    {
+        std::cout << report;
+    }
+    else
+    {
+        std::ofstream reportFile(benchParameters.m_reportFileName);
+        reportFile << report;
+
+        if (!reportFile)
+        {
+            std::cerr << "LArRecoBench, unable to write report " << benchParameters.m_reportFileName << std::endl;
+            return 1;
+        }
+    }
+
+    for (const std::string &slowdown : slowdowns)
+        std::cerr << "LArRecoBench, slowdown relative to baseline: " << slowdown << std::endl;
+
+    // A distinct exit code lets scripts tell a slowdown from a failure
+    return slowdowns.empty() ? 0 : 2;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+void RunBench(const BenchParameters &benchParameters, BenchResults &benchResults)
+{
+    EventFileList eventFileList;
+    unsigned int firstEvent(0), nEventsToProcess(0);
+    std::string outputFileName;
+
+    if (!PrepareEventDivision(benchParameters.m_parameters, eventFileList, firstEvent, nEventsToProcess, outputFileName) || (0 == nEventsToProcess))
+        throw StatusCodeException(STATUS_CODE_NOT_INITIALIZED);
+
+    // Events are read by the benchmark itself, so that every iteration reconstructs exactly the same sample
+    std::vector<const Pandora*> primaryPandoraList;
+    StringVector outputFileNames;
+    const std::chrono::steady_clock::time_point startupBegin(std::chrono::steady_clock::now());
+
+    try
+    {
+        CreatePandoraInstanceSets(benchParameters.m_parameters, outputFileName, "_bench", 1, nullptr, primaryPandoraList, outputFileNames);
+    }
+    catch (const StatusCodeException &)
+    {
+        for (const Pandora *const pPrimaryPandora : primaryPandoraList)
+            MultiPandoraApi::DeletePandoraInstances(pPrimaryPandora);
+
+        throw;
+    }
+
+    benchResults.m_startupTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startupBegin).count();
+    benchResults.m_nEvents = nEventsToProcess;
+
+    const Pandora *const pPrimaryPandora(primaryPandoraList.front());
+    const unsigned int endEvent(firstEvent + nEventsToProcess);
+    DoubleVector latencies;
+    double totalTime(0.);
+
+    try
+    {
+        ProcessBenchEvents(pPrimaryPandora, eventFileList, firstEvent, std::min(endEvent, firstEvent + benchParameters.m_nWarmUpEvents), nullptr);
+
+        for (unsigned int iIteration = 0; iIteration < benchParameters.m_nIterations; ++iIteration)
+        {
+            const std::chrono::steady_clock::time_point iterationBegin(std::chrono::steady_clock::now());
+            ProcessBenchEvents(pPrimaryPandora, eventFileList, firstEvent, endEvent, &latencies);
+            totalTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - iterationBegin).count();
+        }
+    }
+    catch (const StatusCodeException &)
+    {
+        MultiPandoraApi::DeletePandoraInstances(pPrimaryPandora);
+        throw;
+    }
+
+    // The benchmark output repeats the sample once per iteration, so is of no further use
+    MultiPandoraApi::DeletePandoraInstances(pPrimaryPandora);
+
+    for (const std::string &benchFileName : outputFileNames)
+    {
+        std::remove(benchFileName.c_str());
+        std::remove(GetColumnFileName(benchFileName).c_str());
+    }
+
+    benchResults.m_peakRss = GetPeakResidentSetSize();
+
+    if (latencies.empty())
+        return;
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto getPercentile = [&latencies](const double percentile)
+    {
+        const size_t rank(static_cast<size_t>(std::ceil(percentile / 100. * latencies.size())));
+        return latencies.at((rank > 0) ? rank - 1 : 0);
+    };
+
+    benchResults.m_eventsPerSecond = (totalTime > 0.) ? latencies.size() / totalTime : 0.;
+    benchResults.m_meanLatency = std::accumulate(latencies.begin(), latencies.end(), 0.) / latencies.size();
+    benchResults.m_p50Latency = getPercentile(50.);
+    benchResults.m_p90Latency = getPercentile(90.);
+    benchResults.m_p99Latency = getPercentile(99.);
+    benchResults.m_maxLatency = latencies.back();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ProcessBenchEvents(const Pandora *const pPrimaryPandora, const EventFileList &eventFileList, const unsigned int beginEvent,
+    const unsigned int endEvent, DoubleVector *const pLatencies)
+{
+    // Events are read in order, so only the first event of a pass, or of a file, seeks; the others continue from the last event read
+    EventFileCursor eventFileCursor(*pPrimaryPandora, eventFileList);
+
+    for (unsigned int event = beginEvent; event < endEvent; ++event)
+    {
+        const std::chrono::steady_clock::time_point eventBegin(std::chrono::steady_clock::now());
+        eventFileCursor.ReadEvent(event);
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*pPrimaryPandora));
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(*pPrimaryPandora));
+
+        if (pLatencies)
+            pLatencies->push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - eventBegin).count());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+double GetPeakResidentSetSize()
+{
+    // On linux, ru_maxrss is reported in kilobytes
+    struct rusage resourceUsage;
+
+    if (0 != getrusage(RUSAGE_SELF, &resourceUsage))
+        return 0.;
+
+    return resourceUsage.ru_maxrss / 1024.;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool CompareWithBaseline(const BenchParameters &benchParameters, const BenchResults &benchResults, StringVector &slowdowns)
+{
+    std::ifstream baselineFile(benchParameters.m_baselineFileName);
+    std::stringstream baseline;
+    baseline << baselineFile.rdbuf();
+
+    if (!baselineFile)
+    {
+        std::cerr << "LArRecoBench, unable to read baseline " << benchParameters.m_baselineFileName << std::endl;
+        return false;
+    }
+
+    // Throughput should not fall; every other quantity should not rise
+    const std::vector<std::pair<std::string, double>> quantities{{"eventsPerSecond", benchResults.m_eventsPerSecond},
+        {"startupTime", benchResults.m_startupTime}, {"meanLatency", benchResults.m_meanLatency}, {"p50Latency", benchResults.m_p50Latency},
+        {"p90Latency", benchResults.m_p90Latency}, {"p99Latency", benchResults.m_p99Latency}, {"peakRss", benchResults.m_peakRss}};
+
+    for (const auto &quantity : quantities)
+    {
+        double baselineValue(0.);
+
+        if (!ReadReportValue(baseline.str(), quantity.first, baselineValue) || (baselineValue <= 0.))
+            continue;
+
+        const double change((quantity.second - baselineValue) / baselineValue);
+        const bool isSlower(("eventsPerSecond" == quantity.first) ? (change < -benchParameters.m_tolerance) : (change > benchParameters.m_tolerance));
+
+        if (isSlower)
+            slowdowns.push_back(quantity.first + " " + std::to_string(baselineValue) + " -> " + std::to_string(quantity.second));
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool ReadReportValue(const std::string &report, const std::string &key, double &value)
+{
+    const std::string quotedKey("\"" + key + "\"");
+    const size_t keyPosition(report.find(quotedKey));
+
+    if (std::string::npos == keyPosition)
+        return false;
+
+    const size_t colonPosition(report.find(':', keyPosition + quotedKey.size()));
+
+    if (std::string::npos == colonPosition)
+        return false;
+
+    const char *const pBegin(report.c_str() + colonPosition + 1);
+    char *pEnd(nullptr);
+    value = std::strtod(pBegin, &pEnd);
+
+    return (pEnd != pBegin);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string MakeBenchReport(const BenchParameters &benchParameters, const BenchResults &benchResults, const StringVector &slowdowns)
+{
+    std::ostringstream report;
+    report << "{" << std::endl
+           << "  \"settingsFile\": \"" << benchParameters.m_parameters.m_settingsFile << "\"," << std::endl
+           << "  \"eventFileList\": \"" << benchParameters.m_parameters.m_eventFileNameList << "\"," << std::endl
+           << "  \"nEvents\": " << benchResults.m_nEvents << "," << std::endl
+           << "  \"nWarmUpEvents\": " << benchParameters.m_nWarmUpEvents << "," << std::endl
+           << "  \"nIterations\": " << benchParameters.m_nIterations << "," << std::endl
+           << "  \"startupTime\": " << benchResults.m_startupTime << "," << std::endl
+           << "  \"eventsPerSecond\": " << benchResults.m_eventsPerSecond << "," << std::endl
+           << "  \"meanLatency\": " << benchResults.m_meanLatency << "," << std::endl
+           << "  \"p50Latency\": " << benchResults.m_p50Latency << "," << std::endl
+           << "  \"p90Latency\": " << benchResults.m_p90Latency << "," << std::endl
+           << "  \"p99Latency\": " << benchResults.m_p99Latency << "," << std::endl
+           << "  \"maxLatency\": " << benchResults.m_maxLatency << "," << std::endl
+           << "  \"peakRss\": " << benchResults.m_peakRss << "," << std::endl
+           << "  \"units\": {\"startupTime\": \"s\", \"latency\": \"ms\", \"peakRss\": \"MB\"}," << std::endl
+           << "  \"baselineFile\": \"" << benchParameters.m_baselineFileName << "\"," << std::endl
+           << "  \"slowdowns\": [";
+
+    for (unsigned int iSlowdown = 0; iSlowdown < slowdowns.size(); ++iSlowdown)
+        report << ((iSlowdown > 0) ? ", " : "") << "\"" << slowdowns.at(iSlowdown) << "\"";
+
+    report << "]" << std::endl << "}" << std::endl;
+    return report.str();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool ParseBenchCommandLine(int argc, char *argv[], BenchParameters &benchParameters)
+{
+    if (1 == argc)
+        return PrintBenchOptions();
+
+    int c(0);
+    std::string recoOption;
+    Parameters &parameters(benchParameters.m_parameters);
+
+    while ((c = getopt(argc, argv, "r:i:e:g:n:s:w:k:o:b:x:c:h")) != -1)
+    {
+        switch (c)
+        {
+        case 'r':
+            recoOption = optarg;
+            break;
+        case 'i':
+            parameters.m_settingsFile = optarg;
+            break;
+        case 'e':
+            parameters.m_eventFileNameList = optarg;
+            break;
+        case 'g':
+            parameters.m_geometryFileName = optarg;
+            break;
+        case 'n':
+            parameters.m_nEventsToProcess = atoi(optarg);
+            break;
+        case 's':
+            parameters.m_nEventsToSkip = atoi(optarg);
+            break;
+        case 'w':
+            benchParameters.m_nWarmUpEvents = static_cast<unsigned int>(std::max(atoi(optarg), 0));
+            break;
+        case 'k':
+            benchParameters.m_nIterations = static_cast<unsigned int>(std::max(atoi(optarg), 1));
+            break;
+        case 'o':
+            benchParameters.m_reportFileName = optarg;
+            break;
+        case 'b':
+            benchParameters.m_baselineFileName = optarg;
+            break;
+        case 'x':
+            benchParameters.m_tolerance = static_cast<float>(atof(optarg)) / 100.f;
+            break;
+        case 'c':
+            parameters.m_cacheDirectory = optarg;
+            break;
+        case 'h':
+        default:
+            return PrintBenchOptions();
+        }
+    }
+
+    return ProcessRecoOption(recoOption, parameters);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool PrintBenchOptions()
+{
+    std::cout << std::endl << "./bin/LArRecoBench " << std::endl
+              << "    -r RecoOption          (required) [Full, AllHitsCR, AllHitsNu, CRRemHitsSliceCR, CRRemHitsSliceNu, AllHitsSliceCR, AllHitsSliceNu]" << std::endl
+              << "    -i Settings            (required) [algorithm description: xml]" << std::endl
+              << "    -e EventFileList       (required) [colon-separated list of files: xml/pndr]" << std::endl
+              << "    -g GeometryFile        (optional) [detector geometry description: xml/pndr]" << std::endl
+              << "    -n NEventsInSample     (optional) [no. of events in the benchmark sample, default all]" << std::endl
+              << "    -s NEventsToSkip       (optional) [no. of events to skip in first file]" << std::endl
+              << "    -w NWarmUpEvents       (optional) [no. of untimed events to process first, default 1]" << std::endl
+              << "    -k NIterations         (optional) [no. of timed iterations over the sample, default 3]" << std::endl
+              << "    -o ReportFile          (optional) [json report, printed if not set]" << std::endl
+              << "    -b BaselineFile        (optional) [json report from an earlier run, to compare against]" << std::endl
+              << "    -x TolerancePercent    (optional) [change relative to baseline above which to flag a slowdown, default 5]" << std::endl
+              << "    -c CacheDirectory      (optional) [directory in which to cache binary copies of xml geometry]" << std::endl << std::endl;
+
+    return false;
+}
+
+} // namespace lar_reco
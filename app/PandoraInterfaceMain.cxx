@@ -0,0 +1,59 @@
+/**
+ *  @file   LArReco/app/PandoraInterfaceMain.cxx
+ *
+ *  @brief  Entry point for the lar reco application
+ *
+ *  $Log: $
+ */
+
+#include "PandoraInterface.h"
+
+#include <cstdio>
+
+#ifdef MONITORING
+#include "TApplication.h"
+#endif
+
+using namespace lar_reco;
+
+int main(int argc, char *argv[])
+{
+    Parameters parameters;
+
+    if (!ParseCommandLine(argc, argv, parameters))
+        return 1;
+
+    if ((parameters.m_nShards > 1) && !ApplyShard(parameters))
+        return 1;
+
+    std::string temporaryEventFile;
+
+    if ((parameters.m_selectedEvent >= 0) && !ApplyEventSelection(parameters, temporaryEventFile))
+        return 1;
+
+    // Worker processes inherit the handlers, so each stops cleanly if the batch system signals the whole process group
+    InstallStopSignalHandlers();
+
+    if (parameters.m_shouldResume)
+        return ProcessEventsWithResume(parameters);
+
+    if (parameters.m_nWorkerProcesses > 1)
+        return ProcessEventsInWorkers(parameters);
+
+    if (parameters.m_nWorkerThreads > 1)
+        return ProcessEventsInThreads(parameters);
+
+    if (parameters.m_nReadAheadEvents > 0)
+        return ProcessEventsWithReadAhead(parameters);
+
+#ifdef MONITORING
+    TApplication *pTApplication = new TApplication("LArReco", &argc, argv);
+    pTApplication->SetReturnFromRun(kTRUE);
+#endif
+    const int errorNo(RunPandora(parameters));
+
+    if (!temporaryEventFile.empty())
+        std::remove(temporaryEventFile.c_str());
+
+    return errorNo;
+}
@@ -0,0 +1,174 @@
+/**
+ *  @file   LArReco/app/PfoColumnCheck.cxx
+ *
+ *  @brief  Implementation of the columnar pfo file round-trip check
+ *
+ *  $Log: $
+ */
+
+#include "PfoColumnCheck.h"
+#include "PfoEventTreeWriter.h"
+
+#include "TBranchElement.h"
+#include "TFile.h"
+#include "TLeaf.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+using namespace pandora;
+using namespace lar_reco;
+
+int main(int argc, char *argv[])
+{
+    if ((argc < 3) || (argc > 4))
+    {
+        std::cout << std::endl << "Usage: " << argv[0] << " RootFile ColumnFile [TreeName]" << std::endl << std::endl
+                  << "    Compares the pfo tree in RootFile (default tree name PFOs) with the columnar file ColumnFile, written together" << std::endl
+                  << "    by MyTrackShowerIdAlgorithm with the OutputFormat setting Both, and exits with status 1 if they differ" << std::endl << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        const unsigned int nDifferences(ComparePfoOutputs(argv[1], (argc > 3) ? argv[3] : "PFOs", argv[2]));
+
+        if (nDifferences > 0)
+        {
+            std::cout << "PfoColumnCheck: found " << nDifferences << " differences" << std::endl;
+            return 1;
+        }
+    }
+    catch (const StatusCodeException &statusCodeException)
+    {
+        std::cerr << "Pandora StatusCodeException: " << statusCodeException.ToString() << statusCodeException.GetBackTrace() << std::endl;
+        return 1;
+    }
+
+    std::cout << "PfoColumnCheck: outputs match" << std::endl;
+    return 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+unsigned int ComparePfoOutputs(const std::string &rootFileName, const std::string &treeName, const std::string &columnFileName)
+{
+    std::unique_ptr<TFile> pRootFile(TFile::Open(rootFileName.c_str(), "READ"));
+
+    if (!pRootFile || pRootFile->IsZombie())
+    {
+        std::cout << "PfoColumnCheck: unable to open " << rootFileName << std::endl;
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+    }
+
+    TTree *pTree(nullptr);
+    pRootFile->GetObject(treeName.c_str(), pTree);
+
+    if (!pTree)
+    {
+        std::cout << "PfoColumnCheck: no tree " << treeName << " in " << rootFileName << std::endl;
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+    }
+
+    if (PfoEventTreeWriter::IsEventTree(pTree))
+    {
+        std::cout << "PfoColumnCheck: tree " << treeName << " has the event layout, whereas the columnar file holds a row per pfo" << std::endl;
+        throw StatusCodeException(STATUS_CODE_NOT_ALLOWED);
+    }
+
+    const PfoColumnReader columnReader(columnFileName);
+    unsigned int nDifferences(0);
+
+    if (static_cast<uint64_t>(pTree->GetEntries()) != columnReader.GetNRows())
+    {
+        std::cout << "PfoColumnCheck: tree has " << pTree->GetEntries() << " entries, columnar file has " << columnReader.GetNRows() << " rows" << std::endl;
+        return 1;
+    }
+
+    TIter branchIter(pTree->GetListOfBranches());
+
+    while (const TBranch *const pBranch = static_cast<TBranch*>(branchIter()))
+    {
+        if (!columnReader.HasColumn(pBranch->GetName()))
+        {
+            std::cout << "PfoColumnCheck: branch " << pBranch->GetName() << " has no column" << std::endl;
+            ++nDifferences;
+        }
+    }
+
+    for (const std::string &name : columnReader.GetColumnNames())
+    {
+        if (!pTree->GetBranch(name.c_str()))
+        {
+            std::cout << "PfoColumnCheck: column " << name << " has no branch" << std::endl;
+            ++nDifferences;
+            continue;
+        }
+
+        switch (columnReader.GetColumnType(name))
+        {
+        case COLUMN_FLOAT32:
+            nDifferences += CompareBranch<float>(pTree, columnReader, name);
+            break;
+        case COLUMN_INT32:
+            nDifferences += CompareBranch<int>(pTree, columnReader, name);
+            break;
+        case COLUMN_UINT32:
+            nDifferences += CompareBranch<unsigned int>(pTree, columnReader, name);
+            break;
+        default:
+            throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+        }
+    }
+
+    return nDifferences;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+unsigned int CompareBranch(TTree *const pTree, const PfoColumnReader &columnReader, const std::string &name)
+{
+    TBranch *const pBranch(pTree->GetBranch(name.c_str()));
+    const bool isVector(nullptr != dynamic_cast<TBranchElement*>(pBranch));
+    const TLeaf *const pLeaf(static_cast<TLeaf*>(pBranch->GetListOfLeaves()->At(0)));
+
+    // Vector branches are read through a pointer owned by root, scalar and fixed size array branches into a local buffer
+    std::vector<T> *pVector(nullptr);
+    std::vector<T> buffer(isVector ? 0 : std::max(1, pLeaf->GetLenStatic()));
+    pTree->SetBranchAddress(name.c_str(), isVector ? static_cast<void*>(&pVector) : static_cast<void*>(buffer.data()));
+
+    unsigned int nDifferences(0);
+
+    for (uint64_t row = 0; row < columnReader.GetNRows(); ++row)
+    {
+        pBranch->GetEntry(row);
+
+        const ColumnView<T> columnValues(columnReader.GetRowValues<T>(name, row));
+        const std::vector<T> &treeValues(isVector ? *pVector : buffer);
+
+        // Compare bit patterns, so that identical nan values match
+        if ((treeValues.size() != columnValues.size()) ||
+            (!treeValues.empty() && (0 != std::memcmp(treeValues.data(), columnValues.begin(), treeValues.size() * sizeof(T)))))
+        {
+            if (0 == nDifferences)
+                std::cout << "PfoColumnCheck: column " << name << " differs from the tree, first at row " << row << std::endl;
+
+            ++nDifferences;
+        }
+    }
+
+    pTree->ResetBranchAddresses();
+    delete pVector;
+
+    return nDifferences;
+}
+
+} // namespace lar_reco
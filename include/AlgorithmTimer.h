@@ -0,0 +1,185 @@
+/**
+ *  @file   LArReco/include/AlgorithmTimer.h
+ *
+ *  @brief  Header file for the algorithm timer class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_ALGORITHM_TIMER_H
+#define LAR_RECO_ALGORITHM_TIMER_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include <mutex>
+#include <thread>
+
+namespace pandora {class Pandora; class TiXmlElement;}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  AlgorithmTimer class, recording the wall and cpu time spent in each top-level algorithm, of each pandora instance, for each event
+ *
+ *  Timing relies upon marker algorithms, which are inserted around every top-level algorithm in instrumented copies of the settings files
+ */
+class AlgorithmTimer
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  reportFileName the name of the file to which to write the timing summary, in json format if the extension is .json, else csv
+     */
+    AlgorithmTimer(const std::string &reportFileName);
+
+    /**
+     *  @brief  Destructor, removing any instrumented settings files
+     */
+    ~AlgorithmTimer();
+
+    /**
+     *  @brief  Get an instrumented copy of a top-level settings file, creating it (and copies of any worker instance settings) if required
+     *
+     *  @param  settingsFile the path to the original settings file
+     *
+     *  @return the path to the instrumented settings file
+     */
+    const std::string &GetInstrumentedSettingsFile(const std::string &settingsFile);
+
+    /**
+     *  @brief  Record a timing checkpoint for a pandora instance
+     *
+     *  @param  pPandora the address of the pandora instance
+     *  @param  instanceLabel the label identifying the instance settings
+     *  @param  algorithmName the name of the algorithm completed since the last checkpoint, or empty at the start of the algorithm list
+     */
+    void Mark(const pandora::Pandora *const pPandora, const std::string &instanceLabel, const std::string &algorithmName);
+
+    /**
+     *  @brief  Close any open events and write the timing summary to the report file
+     */
+    void WriteReport();
+
+    static const std::string MARKER_ALGORITHM_TYPE;         ///< The type name under which the marker algorithm is registered
+    static const std::string MASTER_ALGORITHM_TYPE;         ///< The type name under which the timing master algorithm is registered
+
+private:
+    /**
+     *  @brief  TimePoint class, a pair of wall and cpu clock readings
+     */
+    class TimePoint
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  wallTime the wall time, in seconds
+         *  @param  cpuTime the thread cpu time, in seconds
+         */
+        TimePoint(const double wallTime = 0., const double cpuTime = 0.);
+
+        double      m_wallTime;                             ///< The wall time, in seconds
+        double      m_cpuTime;                              ///< The thread cpu time, in seconds
+    };
+
+    typedef std::map<std::string, TimePoint> TimePointMap;
+    typedef std::map<const pandora::Pandora*, TimePoint> CheckpointMap;
+    typedef std::map<std::thread::id, TimePointMap> EventTimeMap;
+    typedef std::map<std::string, std::pair<pandora::DoubleVector, pandora::DoubleVector>> SampleMap;
+
+    /**
+     *  @brief  Get the current wall and thread cpu times
+     *
+     *  @return the time point
+     */
+    static TimePoint Now();
+
+    /**
+     *  @brief  Move the accumulated times for an event into the per-event samples
+     *
+     *  @param  threadId the id of the thread that processed the event
+     */
+    void CloseEvent(const std::thread::id threadId);
+
+    /**
+     *  @brief  Instrument a settings file, writing the copy to the instrumented settings directory, named after the original file and a hash
+     *          of its full path
+     *
+     *  @param  settingsFile the path to the original settings file
+     *
+     *  @return the path to the instrumented settings file
+     */
+    std::string InstrumentSettingsFile(const std::string &settingsFile);
+
+    /**
+     *  @brief  Instrument the worker instance settings named in a master algorithm xml block, and redirect the block to the copies
+     *
+     *  @param  pMasterElement the master algorithm xml element
+     */
+    void InstrumentMasterAlgorithm(pandora::TiXmlElement *const pMasterElement);
+
+    /**
+     *  @brief  Get the name by which the master algorithm, searching the given directories, finds a file at an absolute path
+     *
+     *  @param  absolutePath the absolute path of the file
+     *  @param  searchDirectories the directories the master algorithm searches, in order
+     *
+     *  @return the path relative to the first of the directories that exists
+     */
+    static std::string GetSearchRelativePath(const std::string &absolutePath, const pandora::StringVector &searchDirectories);
+
+    /**
+     *  @brief  Escape a string for a json string literal
+     *
+     *  @param  text the string
+     *
+     *  @return the escaped string
+     */
+    static std::string EscapeJson(const std::string &text);
+
+    /**
+     *  @brief  Make the xml element for a marker algorithm
+     *
+     *  @param  instanceLabel the label identifying the instance settings
+     *  @param  algorithmName the name of the algorithm timed by the marker, or empty at the start of the algorithm list
+     *
+     *  @return the xml element
+     */
+    static pandora::TiXmlElement MakeMarkerElement(const std::string &instanceLabel, const std::string &algorithmName);
+
+    /**
+     *  @brief  Get a percentile of a list of samples, using the nearest-rank method
+     *
+     *  @param  sortedSamples the samples, in ascending order
+     *  @param  percentile the percentile
+     *
+     *  @return the percentile value
+     */
+    static double GetPercentile(const pandora::DoubleVector &sortedSamples, const double percentile);
+
+    std::string         m_reportFileName;                   ///< The name of the file to which to write the timing summary
+    std::string         m_settingsDirectory;                ///< The directory holding instrumented settings files
+    std::string         m_primaryLabel;                     ///< The label of the top-level settings, whose first checkpoint starts each event
+    pandora::StringVector m_settingsFileNames;              ///< The instrumented settings files written
+    std::map<std::string, std::string> m_settingsFileMap;   ///< Map from original to instrumented top-level settings files
+    CheckpointMap       m_checkpointMap;                    ///< The last checkpoint for each pandora instance
+    EventTimeMap        m_eventTimeMap;                     ///< The times accumulated for the event in progress on each thread
+    SampleMap           m_sampleMap;                        ///< The per-event wall and cpu times for each instance label and algorithm
+    std::mutex          m_mutex;                            ///< Guards the timing records, which may be shared between threads
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline AlgorithmTimer::TimePoint::TimePoint(const double wallTime, const double cpuTime) :
+    m_wallTime(wallTime),
+    m_cpuTime(cpuTime)
+{
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_ALGORITHM_TIMER_H
@@ -0,0 +1,77 @@
+/**
+ *  @file   LArReco/include/ConfigurationCache.h
+ *
+ *  @brief  Header file for the configuration cache class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_CONFIGURATION_CACHE_H
+#define LAR_RECO_CONFIGURATION_CACHE_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  ConfigurationCache class, holding binary copies of xml geometry files, keyed by a hash of the file contents
+ */
+class ConfigurationCache
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  cacheDirectory the directory in which to hold the cached files, which is created if required
+     */
+    ConfigurationCache(const std::string &cacheDirectory);
+
+    /**
+     *  @brief  Get the cached copy of a geometry file, creating it if required
+     *
+     *  @param  geometryFileName the name of the original geometry file, which is returned unchanged unless in xml format
+     *
+     *  @return the name of the cached geometry file, in binary format
+     */
+    std::string GetCachedGeometryFile(const std::string &geometryFileName) const;
+
+private:
+    /**
+     *  @brief  Get a hash of the contents of a file
+     *
+     *  @param  fileName the file name
+     *
+     *  @return the hash, as a hexadecimal string, or an empty string if the file cannot be read
+     */
+    static std::string GetFileHash(const std::string &fileName);
+
+    /**
+     *  @brief  Make a directory, if it does not already exist
+     *
+     *  @param  directory the directory
+     */
+    static void MakeDirectory(const std::string &directory);
+
+    /**
+     *  @brief  Get a temporary name, in the same directory, under which to write a cached file before moving it into place
+     *
+     *  @param  fileName the cached file name
+     *
+     *  @return the temporary file name, which keeps the extension of the cached file name
+     */
+    static std::string GetTemporaryFileName(const std::string &fileName);
+
+    /**
+     *  @brief  Move a file written under a temporary name into place, atomically replacing any copy written by a concurrent job
+     *
+     *  @param  temporaryFileName the temporary file name
+     *  @param  fileName the cached file name
+     */
+    static void Commit(const std::string &temporaryFileName, const std::string &fileName);
+
+    std::string                 m_cacheDirectory;               ///< The directory in which to hold the cached files
+};
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_CONFIGURATION_CACHE_H
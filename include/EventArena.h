@@ -0,0 +1,205 @@
+/**
+ *  @file   LArReco/include/EventArena.h
+ *
+ *  @brief  Header file for the event arena class and its allocator.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_EVENT_ARENA_H
+#define LAR_RECO_EVENT_ARENA_H 1
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  EventArena class, a monotonic memory resource for short-lived, per-event containers
+ *
+ *  Allocation advances a position within the current block, and deallocation does nothing. All memory is released in bulk by Reset,
+ *  once every container using the arena has been destroyed; the blocks are kept, so that later events need not return to the heap.
+ */
+class EventArena
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  blockSize the size of each block requested from the heap, in bytes, unless a single allocation requires more
+     */
+    EventArena(const std::size_t blockSize = 1 << 20);
+
+    /**
+     *  @brief  Deleted copy constructor
+     */
+    EventArena(const EventArena &) = delete;
+
+    /**
+     *  @brief  Deleted assignment operator
+     */
+    EventArena &operator=(const EventArena &) = delete;
+
+    /**
+     *  @brief  Allocate memory from the arena
+     *
+     *  @param  size the number of bytes
+     *  @param  alignment the required alignment, a power of two
+     *
+     *  @return the address of the memory
+     */
+    void *Allocate(const std::size_t size, const std::size_t alignment);
+
+    /**
+     *  @brief  Release all memory allocated from the arena, keeping the blocks for reuse
+     */
+    void Reset();
+
+    /**
+     *  @brief  Get the number of bytes allocated since the last reset, including alignment padding
+     *
+     *  @return the number of bytes
+     */
+    std::size_t GetBytesAllocated() const;
+
+private:
+    typedef std::unique_ptr<char[]> Block;
+    typedef std::vector<Block> BlockList;
+    typedef std::vector<std::size_t> SizeList;
+
+    std::size_t     m_blockSize;                ///< The size of each block requested from the heap, in bytes
+    BlockList       m_blockList;                ///< The blocks
+    SizeList        m_blockSizeList;            ///< The size of each block, in bytes
+    std::size_t     m_currentBlock;             ///< The index of the block from which memory is currently allocated
+    std::size_t     m_position;                 ///< The position of the next free byte in the current block
+    std::size_t     m_bytesAllocated;           ///< The number of bytes allocated since the last reset
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  ArenaAllocator class template, a standard library allocator drawing memory from an event arena
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  eventArena the event arena from which to allocate
+     */
+    ArenaAllocator(EventArena &eventArena) noexcept;
+
+    /**
+     *  @brief  Converting constructor, for an allocator of another type drawing from the same arena
+     *
+     *  @param  other the other allocator
+     */
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept;
+
+    /**
+     *  @brief  Allocate memory for a number of objects
+     *
+     *  @param  n the number of objects
+     *
+     *  @return the address of the memory
+     */
+    T *allocate(const std::size_t n);
+
+    /**
+     *  @brief  Deallocate memory, which is only reclaimed when the arena is reset
+     */
+    void deallocate(T *const, const std::size_t) noexcept;
+
+    /**
+     *  @brief  Get the address of the event arena
+     *
+     *  @return the address of the event arena
+     */
+    EventArena *GetEventArena() const noexcept;
+
+private:
+    EventArena     *m_pEventArena;              ///< The address of the event arena
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept;
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline std::size_t EventArena::GetBytesAllocated() const
+{
+    return m_bytesAllocated;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline ArenaAllocator<T>::ArenaAllocator(EventArena &eventArena) noexcept :
+    m_pEventArena(&eventArena)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+template <typename U>
+inline ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U> &other) noexcept :
+    m_pEventArena(other.GetEventArena())
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline T *ArenaAllocator<T>::allocate(const std::size_t n)
+{
+    return static_cast<T*>(m_pEventArena->Allocate(n * sizeof(T), alignof(T)));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void ArenaAllocator<T>::deallocate(T *const, const std::size_t) noexcept
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline EventArena *ArenaAllocator<T>::GetEventArena() const noexcept
+{
+    return m_pEventArena;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept
+{
+    return (lhs.GetEventArena() == rhs.GetEventArena());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_EVENT_ARENA_H
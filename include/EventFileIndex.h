@@ -0,0 +1,108 @@
+/**
+ *  @file   LArReco/include/EventFileIndex.h
+ *
+ *  @brief  Header file for the event file index class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_EVENT_FILE_INDEX_H
+#define LAR_RECO_EVENT_FILE_INDEX_H 1
+
+#include <ios>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  EventFileIndex class, mapping event numbers to the byte ranges of the event containers in a pandora binary file
+ *
+ *  The index is built by hopping between container headers, without decoding any events, and is kept in a sidecar file alongside the
+ *  event file, so that it is built only once. The sidecar records the size and modification time of the event file, and is rebuilt if
+ *  either changes.
+ */
+class EventFileIndex
+{
+public:
+    /**
+     *  @brief  Constructor, reading the sidecar index file if it is up to date, else building the index and writing the sidecar
+     *
+     *  @param  fileName the name of the pandora binary event file
+     */
+    EventFileIndex(const std::string &fileName);
+
+    /**
+     *  @brief  Whether an event file can be indexed, i.e. whether it is in pandora binary format
+     *
+     *  @param  fileName the event file name
+     *
+     *  @return whether the file can be indexed
+     */
+    static bool IsIndexable(const std::string &fileName);
+
+    /**
+     *  @brief  Get the number of events in the file
+     *
+     *  @return the number of events
+     */
+    unsigned int GetNEvents() const;
+
+    /**
+     *  @brief  Copy a single event, without decoding it, to a new pandora binary file holding only that event
+     *
+     *  @param  eventNumber the number of the event in the indexed file
+     *  @param  outputFileName the name of the file to write
+     */
+    void WriteEventFile(const unsigned int eventNumber, const std::string &outputFileName) const;
+
+private:
+    /**
+     *  @brief  EventLocation class, the byte range of an event container
+     */
+    class EventLocation
+    {
+    public:
+        std::streamoff  m_offset;                   ///< The offset of the start of the container header from the start of the file
+        std::streamoff  m_size;                     ///< The size of the container, including its header
+    };
+
+    typedef std::vector<EventLocation> EventLocationList;
+
+    /**
+     *  @brief  Read the sidecar index file
+     *
+     *  @param  fileSize the current size of the event file
+     *  @param  modificationTime the current modification time of the event file
+     *
+     *  @return success, false if the sidecar is missing, unreadable or out of date
+     */
+    bool ReadIndex(const std::streamoff fileSize, const long modificationTime);
+
+    /**
+     *  @brief  Build the index by reading the container headers of the event file
+     *
+     *  @param  fileSize the current size of the event file
+     */
+    void BuildIndex(const std::streamoff fileSize);
+
+    /**
+     *  @brief  Write the sidecar index file, moving it into place only once complete
+     *
+     *  @param  fileSize the current size of the event file
+     *  @param  modificationTime the current modification time of the event file
+     */
+    void WriteIndex(const std::streamoff fileSize, const long modificationTime) const;
+
+    static const std::string    INDEX_FILE_SUFFIX;          ///< The suffix added to an event file name to give its sidecar index file name
+    static const std::string    INDEX_FORMAT_TAG;           ///< The tag, including format version, heading a sidecar index file
+
+    std::string                 m_fileName;                 ///< The name of the event file
+    EventLocationList           m_eventLocationList;        ///< The byte range of each event, in order
+};
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_EVENT_FILE_INDEX_H
@@ -0,0 +1,228 @@
+/**
+ *  @file   LArReco/include/HitEncoder.h
+ *
+ *  @brief  Header file for the hit encoder class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_HIT_ENCODER_H
+#define LAR_RECO_HIT_ENCODER_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include <list>
+#include <ostream>
+
+namespace pandora { class TiXmlHandle; }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  HitEncoder class, quantising the hit values of each pfo to 16 bit integer codes relative to the range of the values in the pfo,
+ *          i.e. its bounding box for coordinates. Settings are read from a HitEncoding block, encoding being disabled if it is absent
+ *
+ *  <HitEncoding>
+ *      <Encoding>FixedPoint</Encoding>             FixedPoint (each value as its code) or Delta (the first code, then each difference modulo 2^16)
+ *      <CoordinatePrecision>0.01</CoordinatePrecision>     the quantisation step of coordinates and their errors, in cm
+ *      <EnergyPrecision>0.000001</EnergyPrecision>         the quantisation step of energies, in GeV
+ *      <ReportErrors>true</ReportErrors>           report the largest and rms quantisation error of each quantity when the file is closed
+ *  </HitEncoding>
+ *
+ *  A value is encoded as code = round((value - min) / step), and decoded as min + code * step, with min and step written for each pfo. The
+ *  step is the given precision, unless the range of the values in the pfo needs more than 2^16 steps, when it is the range divided by 65535.
+ *  The quantisation error is therefore at most half a step, plus float rounding.
+ */
+class HitEncoder
+{
+public:
+    typedef std::vector<unsigned short> CodeVector;
+
+    /**
+     *  @brief  EncodedQuantity class, a hit quantity of the current pfo and its encoding
+     */
+    class EncodedQuantity
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  name the name of the quantity
+         *  @param  ppValues the address of the pointer to the values to encode
+         *  @param  precision the quantisation step
+         */
+        EncodedQuantity(const std::string &name, const pandora::FloatVector *const *const ppValues, const float precision);
+
+        std::string                 m_name;             ///< The name of the quantity
+        const pandora::FloatVector  *const *m_ppValues; ///< The address of the pointer to the values to encode, followed as it is reassigned
+        float                       m_precision;        ///< The quantisation step, unless the range of the values needs a larger one
+        CodeVector                  m_codes;            ///< The codes of the values
+        CodeVector                  *m_pCodes;          ///< The address of the codes, for binding to a branch
+        float                       m_min;              ///< The smallest value, from which codes count up
+        float                       m_step;             ///< The quantisation step of the current pfo
+        unsigned long long          m_nValues;          ///< The number of values encoded, for the error report
+        double                      m_maxError;         ///< The largest absolute quantisation error, for the error report
+        double                      m_sumSquaredErrors; ///< The sum of squared quantisation errors, for the error report
+    };
+
+    /**
+     *  @brief  Default constructor
+     */
+    HitEncoder();
+
+    /**
+     *  @brief  Read the settings from the HitEncoding block, if any, below an xml element
+     *
+     *  @param  xmlHandle the handle of the element containing the HitEncoding block
+     *
+     *  @return STATUS_CODE_SUCCESS, or STATUS_CODE_INVALID_PARAMETER if a setting is not recognised or out of range
+     */
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle &xmlHandle);
+
+    /**
+     *  @brief  Whether encoding is enabled, by a HitEncoding block
+     *
+     *  @return boolean
+     */
+    bool IsEnabled() const;
+
+    /**
+     *  @brief  Whether codes are delta encoded
+     *
+     *  @return boolean
+     */
+    bool IsDelta() const;
+
+    /**
+     *  @brief  Get the quantisation step of coordinates
+     *
+     *  @return the step
+     */
+    float GetCoordinatePrecision() const;
+
+    /**
+     *  @brief  Get the quantisation step of energies
+     *
+     *  @return the step
+     */
+    float GetEnergyPrecision() const;
+
+    /**
+     *  @brief  Whether to report the quantisation errors
+     *
+     *  @return boolean
+     */
+    bool ShouldReportErrors() const;
+
+    /**
+     *  @brief  Add a quantity to encode with each pfo
+     *
+     *  @param  name the name of the quantity
+     *  @param  ppValues the address of the pointer to the values to encode, which must outlive the encoder
+     *  @param  precision the quantisation step
+     *
+     *  @return the quantity, at an address fixed for the lifetime of the encoder
+     */
+    EncodedQuantity &AddQuantity(const std::string &name, const pandora::FloatVector *const *const ppValues, const float precision);
+
+    /**
+     *  @brief  Encode the current values of every quantity, accumulating the quantisation errors if they are to be reported
+     */
+    void Encode();
+
+    /**
+     *  @brief  Print the number of values and the largest and rms quantisation error of each quantity
+     *
+     *  @param  stream the stream to print to
+     */
+    void PrintErrorReport(std::ostream &stream) const;
+
+    /**
+     *  @brief  Encode a set of values
+     *
+     *  @param  values the values
+     *  @param  precision the quantisation step, unless the range of the values needs a larger one
+     *  @param  isDelta whether to delta encode the codes
+     *  @param  codes to receive the codes
+     *  @param  min to receive the smallest value
+     *  @param  step to receive the quantisation step
+     */
+    static void Encode(const pandora::FloatVector &values, const float precision, const bool isDelta, CodeVector &codes, float &min, float &step);
+
+    /**
+     *  @brief  Decode a set of values
+     *
+     *  @param  codes the codes
+     *  @param  min the smallest value
+     *  @param  step the quantisation step
+     *  @param  isDelta whether the codes are delta encoded
+     *  @param  values to receive the values
+     */
+    static void Decode(const CodeVector &codes, const float min, const float step, const bool isDelta, pandora::FloatVector &values);
+
+private:
+    typedef std::list<EncodedQuantity> EncodedQuantityList;
+
+    bool                    m_isEnabled;            ///< Whether encoding is enabled
+    bool                    m_isDelta;              ///< Whether codes are delta encoded
+    float                   m_coordinatePrecision;  ///< The quantisation step of coordinates
+    float                   m_energyPrecision;      ///< The quantisation step of energies
+    bool                    m_reportErrors;         ///< Whether to report the quantisation errors
+    EncodedQuantityList     m_quantityList;         ///< The quantities, in a list so that their addresses stay fixed
+    pandora::FloatVector    m_decodedValues;        ///< The decoded values, reused when measuring the quantisation errors
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool HitEncoder::IsEnabled() const
+{
+    return m_isEnabled;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool HitEncoder::IsDelta() const
+{
+    return m_isDelta;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float HitEncoder::GetCoordinatePrecision() const
+{
+    return m_coordinatePrecision;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float HitEncoder::GetEnergyPrecision() const
+{
+    return m_energyPrecision;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool HitEncoder::ShouldReportErrors() const
+{
+    return m_reportErrors;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void HitEncoder::Decode(const CodeVector &codes, const float min, const float step, const bool isDelta, pandora::FloatVector &values)
+{
+    values.resize(codes.size());
+    unsigned short code(0);
+
+    for (unsigned int iValue = 0; iValue < codes.size(); ++iValue)
+    {
+        code = isDelta ? static_cast<unsigned short>(code + codes[iValue]) : codes[iValue];
+        values[iValue] = min + code * step;
+    }
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_HIT_ENCODER_H
@@ -0,0 +1,217 @@
+/**
+ *  @file   LArReco/include/HitImageBuilder.h
+ *
+ *  @brief  Header file for the hit image builder class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_HIT_IMAGE_BUILDER_H
+#define LAR_RECO_HIT_IMAGE_BUILDER_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+namespace pandora { class TiXmlHandle; }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  HitImageBuilder class, binning the hits of a pfo in a two dimensional view into an image of drift (rows) by wire (columns) pixels,
+ *          each pixel holding the summed hit energy. Settings are read from a HitImages block, images being disabled if it is absent
+ *
+ *  <HitImages>
+ *      <NDriftPixels>64</NDriftPixels>     the number of pixel rows
+ *      <NWirePixels>64</NWirePixels>       the number of pixel columns
+ *      <WirePitch>0.3</WirePitch>          the pixel size along the wire coordinate, in cm, defaulting to the wire pitch of each view
+ *      <DriftPitch>0.3</DriftPitch>        the pixel size along the drift coordinate, in cm, defaulting to the pixel size along the wire coordinate
+ *      <CropAround>Vertex</CropAround>     centre the image on the projected pfo Vertex, else the energy-weighted Centroid of its hits
+ *      <Storage>Sparse</Storage>           Sparse (the indices and values of non-empty pixels, in row-major order) or Dense (every pixel)
+ *  </HitImages>
+ *
+ *  Pixel index row * NWirePixels + column counts up from the pixel at the image origin, the lowest drift and wire coordinates. Sparse
+ *  indices are ascending, so hold the pixels in CSR order, with the row of each pixel given by its index divided by NWirePixels.
+ */
+class HitImageBuilder
+{
+public:
+    /**
+     *  @brief  Default constructor
+     */
+    HitImageBuilder();
+
+    /**
+     *  @brief  Read the settings from the HitImages block, if any, below an xml element
+     *
+     *  @param  xmlHandle the handle of the element containing the HitImages block
+     *
+     *  @return STATUS_CODE_SUCCESS, or STATUS_CODE_INVALID_PARAMETER if a setting is not recognised or out of range
+     */
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle &xmlHandle);
+
+    /**
+     *  @brief  Whether images are enabled, by a HitImages block
+     *
+     *  @return boolean
+     */
+    bool IsEnabled() const;
+
+    /**
+     *  @brief  Whether images are stored sparsely
+     *
+     *  @return boolean
+     */
+    bool IsSparse() const;
+
+    /**
+     *  @brief  Whether images are centred on the pfo vertex, where there is one, rather than the hit centroid
+     *
+     *  @return boolean
+     */
+    bool ShouldCropAroundVertex() const;
+
+    /**
+     *  @brief  Get the number of pixel rows, along the drift coordinate
+     *
+     *  @return the number of rows
+     */
+    unsigned int GetNDriftPixels() const;
+
+    /**
+     *  @brief  Get the number of pixel columns, along the wire coordinate
+     *
+     *  @return the number of columns
+     */
+    unsigned int GetNWirePixels() const;
+
+    /**
+     *  @brief  Get the pixel size along the wire coordinate
+     *
+     *  @param  viewWirePitch the wire pitch of the view, used if no pixel size was given
+     *
+     *  @return the pixel size
+     */
+    float GetWirePitch(const float viewWirePitch) const;
+
+    /**
+     *  @brief  Get the pixel size along the drift coordinate
+     *
+     *  @param  wirePitch the pixel size along the wire coordinate, used if no pixel size was given
+     *
+     *  @return the pixel size
+     */
+    float GetDriftPitch(const float wirePitch) const;
+
+    /**
+     *  @brief  Get the energy-weighted centroid of a set of hits, or their mean position if they carry no energy
+     *
+     *  @param  pDriftCoords the drift coordinates
+     *  @param  pWireCoords the wire coordinates
+     *  @param  pEnergies the energies
+     *  @param  nHits the number of hits
+     *  @param  driftCentroid to receive the drift coordinate of the centroid
+     *  @param  wireCentroid to receive the wire coordinate of the centroid
+     */
+    static void GetCentroid(const float *const pDriftCoords, const float *const pWireCoords, const float *const pEnergies, const unsigned int nHits,
+        float &driftCentroid, float &wireCentroid);
+
+    /**
+     *  @brief  Bin a set of hits into an image centred on a given position, hits outside the image being dropped
+     *
+     *  @param  pDriftCoords the drift coordinates
+     *  @param  pWireCoords the wire coordinates
+     *  @param  pEnergies the energies
+     *  @param  nHits the number of hits
+     *  @param  driftCentre the drift coordinate of the image centre
+     *  @param  wireCentre the wire coordinate of the image centre
+     *  @param  driftPitch the pixel size along the drift coordinate
+     *  @param  wirePitch the pixel size along the wire coordinate
+     *  @param  driftOrigin to receive the drift coordinate of the lower edge of the image
+     *  @param  wireOrigin to receive the wire coordinate of the lower edge of the image
+     *  @param  pixelIndices to receive the indices of the non-empty pixels if sparse, else cleared
+     *  @param  pixelValues to receive the values of the non-empty pixels if sparse, else of every pixel
+     */
+    void Build(const float *const pDriftCoords, const float *const pWireCoords, const float *const pEnergies, const unsigned int nHits,
+        const float driftCentre, const float wireCentre, const float driftPitch, const float wirePitch, float &driftOrigin, float &wireOrigin,
+        pandora::IntVector &pixelIndices, pandora::FloatVector &pixelValues);
+
+private:
+    /**
+     *  @brief  Compute the pixel index of each hit, or -1 for hits outside the image
+     *
+     *  @param  pDriftCoords the drift coordinates
+     *  @param  pWireCoords the wire coordinates
+     *  @param  nHits the number of hits
+     *  @param  driftOrigin the drift coordinate of the lower edge of the image
+     *  @param  wireOrigin the wire coordinate of the lower edge of the image
+     *  @param  driftPitch the pixel size along the drift coordinate
+     *  @param  wirePitch the pixel size along the wire coordinate
+     */
+    void ComputeHitPixels(const float *const pDriftCoords, const float *const pWireCoords, const unsigned int nHits, const float driftOrigin,
+        const float wireOrigin, const float driftPitch, const float wirePitch);
+
+    bool                        m_isEnabled;            ///< Whether images are enabled
+    bool                        m_isSparse;             ///< Whether images are stored sparsely
+    bool                        m_cropAroundVertex;     ///< Whether images are centred on the pfo vertex, rather than the hit centroid
+    unsigned int                m_nDriftPixels;         ///< The number of pixel rows
+    unsigned int                m_nWirePixels;          ///< The number of pixel columns
+    float                       m_wirePitch;            ///< The pixel size along the wire coordinate, or zero for the wire pitch of the view
+    float                       m_driftPitch;           ///< The pixel size along the drift coordinate, or zero for the wire pixel size
+    pandora::IntVector          m_hitPixels;            ///< The pixel index of each hit, reused between images
+    pandora::FloatVector        m_pixelSums;            ///< The summed energy of every pixel, kept zeroed between sparse images
+    std::vector<unsigned char>  m_isPixelFilled;        ///< Whether each pixel has received a hit, kept cleared between sparse images
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool HitImageBuilder::IsEnabled() const
+{
+    return m_isEnabled;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool HitImageBuilder::IsSparse() const
+{
+    return m_isSparse;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool HitImageBuilder::ShouldCropAroundVertex() const
+{
+    return m_cropAroundVertex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int HitImageBuilder::GetNDriftPixels() const
+{
+    return m_nDriftPixels;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int HitImageBuilder::GetNWirePixels() const
+{
+    return m_nWirePixels;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float HitImageBuilder::GetWirePitch(const float viewWirePitch) const
+{
+    return ((m_wirePitch > 0.f) ? m_wirePitch : viewWirePitch);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float HitImageBuilder::GetDriftPitch(const float wirePitch) const
+{
+    return ((m_driftPitch > 0.f) ? m_driftPitch : wirePitch);
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_HIT_IMAGE_BUILDER_H
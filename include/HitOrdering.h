@@ -0,0 +1,118 @@
+/**
+ *  @file   LArReco/include/HitOrdering.h
+ *
+ *  @brief  Header file for the hit ordering class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_HIT_ORDERING_H
+#define LAR_RECO_HIT_ORDERING_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  Hit orders
+ */
+enum HitOrder
+{
+    HIT_ORDER_INPUT = 0,            ///< The order of the pfo hit lists
+    HIT_ORDER_WIRE_DRIFT = 1,       ///< By wire (z) coordinate, then drift (x) coordinate, then y for 3D hits
+    HIT_ORDER_MORTON = 2,           ///< By Morton code, interleaving the coordinates quantised across the bounding box of the hits
+    HIT_ORDER_VERTEX_DISTANCE = 3   ///< By distance from the (projected) pfo vertex, falling back to wire then drift order without one
+};
+
+/**
+ *  @brief  HitOrdering class, sorting the hits of a pfo in a view and applying the same permutation to each of its hit value vectors. Sorts
+ *          are stable, so hits with equal keys keep their input order
+ */
+class HitOrdering
+{
+public:
+    /**
+     *  @brief  Default constructor
+     */
+    HitOrdering();
+
+    /**
+     *  @brief  Set the order, by name
+     *
+     *  @param  orderName the order name, Input, WireDrift, Morton or VertexDistance
+     *
+     *  @return STATUS_CODE_SUCCESS, or STATUS_CODE_INVALID_PARAMETER if the name is not recognised
+     */
+    pandora::StatusCode SetOrder(const std::string &orderName);
+
+    /**
+     *  @brief  Get the order
+     *
+     *  @return the order
+     */
+    HitOrder GetOrder() const;
+
+    /**
+     *  @brief  Whether hits are reordered, i.e. the order is not the input order
+     *
+     *  @return boolean
+     */
+    bool IsEnabled() const;
+
+    /**
+     *  @brief  Find the permutation sorting a set of hits, to be applied by Apply
+     *
+     *  @param  pXCoords the x (drift) coordinates
+     *  @param  pYCoords the y coordinates, or nullptr for hits in a two dimensional view
+     *  @param  pZCoords the z (wire) coordinates
+     *  @param  nHits the number of hits
+     *  @param  pVertex the address of the x, y and z coordinates of the vertex, or nullptr if there is none; for two dimensional views, the
+     *          projected vertex, its y coordinate unused
+     */
+    void Sort(const float *const pXCoords, const float *const pYCoords, const float *const pZCoords, const unsigned int nHits, const float *const pVertex);
+
+    /**
+     *  @brief  Reorder a vector of hit values by the permutation found by the last call to Sort
+     *
+     *  @param  values the values, one per hit, or an empty vector to leave unchanged
+     */
+    void Apply(pandora::FloatVector &values);
+
+private:
+    /**
+     *  @brief  Spread the lowest 21 bits of a value so that two zero bits follow each, for interleaving three coordinates
+     *
+     *  @param  value the value
+     *
+     *  @return the spread bits
+     */
+    static uint64_t SpreadBits(const uint64_t value);
+
+    HitOrder                m_order;            ///< The order
+    pandora::UIntVector     m_permutation;      ///< The input index of the hit at each sorted position
+    std::vector<uint64_t>   m_mortonCodes;      ///< The Morton code of each hit, reused between pfos
+    pandora::FloatVector    m_distances;        ///< The squared distance of each hit from the vertex, reused between pfos
+    pandora::FloatVector    m_sortedValues;     ///< The reordered values, swapped with each vector as it is reordered
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline HitOrder HitOrdering::GetOrder() const
+{
+    return m_order;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool HitOrdering::IsEnabled() const
+{
+    return (HIT_ORDER_INPUT != m_order);
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_HIT_ORDERING_H
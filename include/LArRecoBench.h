@@ -0,0 +1,166 @@
+/**
+ *  @file   LArReco/include/LArRecoBench.h
+ *
+ *  @brief  Header file for the lar reco throughput benchmark.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_BENCH_H
+#define LAR_RECO_BENCH_H 1
+
+#include "PandoraInterface.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  BenchParameters class
+ */
+class BenchParameters
+{
+public:
+    /**
+     *  @brief Default constructor
+     */
+    BenchParameters();
+
+    Parameters          m_parameters;                   ///< The reconstruction parameters, describing the settings and the event sample
+    unsigned int        m_nWarmUpEvents;                ///< The number of events from the sample to process, untimed, before the timed iterations
+    unsigned int        m_nIterations;                  ///< The number of timed iterations over the event sample
+    std::string         m_reportFileName;               ///< The name of the json report file, the report is printed if empty
+    std::string         m_baselineFileName;             ///< The name of a json report against which to compare, if any
+    float               m_tolerance;                    ///< The fractional change, relative to the baseline, above which to flag a slowdown
+};
+
+/**
+ *  @brief  BenchResults class
+ */
+class BenchResults
+{
+public:
+    /**
+     *  @brief Default constructor
+     */
+    BenchResults();
+
+    unsigned int        m_nEvents;                      ///< The number of events in the sample
+    double              m_startupTime;                  ///< The time to create and configure the pandora instances, in seconds
+    double              m_eventsPerSecond;              ///< The throughput over the timed iterations, including event reading
+    double              m_meanLatency;                  ///< The mean time to read and reconstruct an event, in milliseconds
+    double              m_p50Latency;                   ///< The median time to read and reconstruct an event, in milliseconds
+    double              m_p90Latency;                   ///< The 90th percentile time to read and reconstruct an event, in milliseconds
+    double              m_p99Latency;                   ///< The 99th percentile time to read and reconstruct an event, in milliseconds
+    double              m_maxLatency;                   ///< The longest time to read and reconstruct an event, in milliseconds
+    double              m_peakRss;                      ///< The peak resident set size of the process, in megabytes
+};
+
+/**
+ *  @brief  Create pandora instances, process the warm-up events, then time repeated iterations over the event sample
+ *
+ *  @param  benchParameters the benchmark parameters
+ *  @param  benchResults to receive the benchmark results
+ */
+void RunBench(const BenchParameters &benchParameters, BenchResults &benchResults);
+
+/**
+ *  @brief  Read and reconstruct a contiguous range of events, optionally recording the time taken for each
+ *
+ *  @param  pPrimaryPandora the address of the primary pandora instance
+ *  @param  eventFileList the list of input event files
+ *  @param  beginEvent the number of the first event to process, counting across the whole file list
+ *  @param  endEvent one past the number of the last event to process
+ *  @param  pLatencies if not null, to receive the time taken for each event, in milliseconds
+ */
+void ProcessBenchEvents(const pandora::Pandora *const pPrimaryPandora, const EventFileList &eventFileList, const unsigned int beginEvent,
+    const unsigned int endEvent, pandora::DoubleVector *const pLatencies);
+
+/**
+ *  @brief  Get the peak resident set size of the process
+ *
+ *  @return the peak resident set size, in megabytes
+ */
+double GetPeakResidentSetSize();
+
+/**
+ *  @brief  Compare benchmark results with those in a baseline report
+ *
+ *  @param  benchParameters the benchmark parameters
+ *  @param  benchResults the benchmark results
+ *  @param  slowdowns to receive a description of each quantity that is worse than the baseline by more than the tolerance
+ *
+ *  @return success in reading the baseline
+ */
+bool CompareWithBaseline(const BenchParameters &benchParameters, const BenchResults &benchResults, pandora::StringVector &slowdowns);
+
+/**
+ *  @brief  Read a numeric value from a json report written by this benchmark
+ *
+ *  @param  report the report contents
+ *  @param  key the key of the value
+ *  @param  value to receive the value
+ *
+ *  @return success
+ */
+bool ReadReportValue(const std::string &report, const std::string &key, double &value);
+
+/**
+ *  @brief  Write the benchmark report, in json format
+ *
+ *  @param  benchParameters the benchmark parameters
+ *  @param  benchResults the benchmark results
+ *  @param  slowdowns the slowdowns relative to the baseline, if any
+ *
+ *  @return the report
+ */
+std::string MakeBenchReport(const BenchParameters &benchParameters, const BenchResults &benchResults, const pandora::StringVector &slowdowns);
+
+/**
+ *  @brief  Parse the command line arguments, setting the benchmark parameters
+ *
+ *  @param  argc argument count
+ *  @param  argv argument vector
+ *  @param  benchParameters to receive the benchmark parameters
+ *
+ *  @return success
+ */
+bool ParseBenchCommandLine(int argc, char *argv[], BenchParameters &benchParameters);
+
+/**
+ *  @brief  Print the list of configurable options
+ *
+ *  @return false, to force abort
+ */
+bool PrintBenchOptions();
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline BenchParameters::BenchParameters() :
+    m_nWarmUpEvents(1),
+    m_nIterations(3),
+    m_reportFileName(""),
+    m_baselineFileName(""),
+    m_tolerance(0.05f)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline BenchResults::BenchResults() :
+    m_nEvents(0),
+    m_startupTime(0.),
+    m_eventsPerSecond(0.),
+    m_meanLatency(0.),
+    m_p50Latency(0.),
+    m_p90Latency(0.),
+    m_p99Latency(0.),
+    m_maxLatency(0.),
+    m_peakRss(0.)
+{
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_BENCH_H
@@ -0,0 +1,129 @@
+/**
+ *  @file   LArReco/include/Logger.h
+ *
+ *  @brief  Header file for the logger class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_LOGGER_H
+#define LAR_RECO_LOGGER_H 1
+
+#include "Pandora/StatusCodes.h"
+
+#include <sstream>
+#include <string>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  Write a message, built with stream insertion, if the logger is enabled at the given level. The message is only built if enabled.
+ */
+#define LAR_RECO_LOG(logger, logLevel, message)                                                                     \
+    {                                                                                                               \
+        if ((logger).IsEnabled(logLevel))                                                                           \
+        {                                                                                                           \
+            std::ostringstream logStream;                                                                           \
+            logStream << message << '\n';                                                                           \
+            (logger).Write(logStream.str());                                                                        \
+        }                                                                                                           \
+    }
+
+/**
+ *  @brief  Write a debug message, removed entirely from builds defining LAR_RECO_NO_DEBUG_LOGGING
+ */
+#ifdef LAR_RECO_NO_DEBUG_LOGGING
+    #define LAR_RECO_LOG_DEBUG(logger, message) {}
+#else
+    #define LAR_RECO_LOG_DEBUG(logger, message) LAR_RECO_LOG(logger, lar_reco::LOG_DEBUG, message)
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  Log levels, in increasing order of verbosity
+ */
+enum LogLevel
+{
+    LOG_ERROR,
+    LOG_WARNING,
+    LOG_INFO,
+    LOG_DEBUG
+};
+
+/**
+ *  @brief  Logger class, filtering messages by level and passing them to a buffered sink, written to standard output by a background thread
+ *
+ *  All loggers in the process share the sink, so messages from different pandora instances are never interleaved mid-line. The sink
+ *  thread starts on first use, and a forked worker starts a sink of its own, leaving any messages pending at the fork to the parent.
+ */
+class Logger
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  logLevel the most verbose level to write
+     */
+    Logger(const LogLevel logLevel = LOG_INFO);
+
+    /**
+     *  @brief  Set the most verbose level to write, by name
+     *
+     *  @param  logLevelName the level name, Error, Warning, Info or Debug, case insensitive
+     *
+     *  @return STATUS_CODE_SUCCESS, or STATUS_CODE_INVALID_PARAMETER if the name is not recognised
+     */
+    pandora::StatusCode SetLogLevel(const std::string &logLevelName);
+
+    /**
+     *  @brief  Whether messages at a given level are written; always false for debug messages if LAR_RECO_NO_DEBUG_LOGGING is defined
+     *
+     *  @param  logLevel the level
+     *
+     *  @return whether messages at the level are written
+     */
+    bool IsEnabled(const LogLevel logLevel) const;
+
+    /**
+     *  @brief  Pass a complete message to the sink, without further filtering
+     *
+     *  @param  message the message, including any trailing newline
+     */
+    void Write(const std::string &message) const;
+
+    /**
+     *  @brief  Block until all messages passed to the sink have been written, e.g. before leaving a process with _exit
+     */
+    static void Flush();
+
+    /**
+     *  @brief  Get the logger shared by helper classes that have no configured level, which writes all but debug messages
+     *
+     *  @return the logger
+     */
+    static const Logger &GetDefault();
+
+private:
+    class Sink;
+
+    LogLevel        m_logLevel;                 ///< The most verbose level to write
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool Logger::IsEnabled(const LogLevel logLevel) const
+{
+#ifdef LAR_RECO_NO_DEBUG_LOGGING
+    if (LOG_DEBUG == logLevel)
+        return false;
+#endif
+    return (logLevel <= m_logLevel);
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_LOGGER_H
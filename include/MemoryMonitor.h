@@ -0,0 +1,127 @@
+/**
+ *  @file   LArReco/include/MemoryMonitor.h
+ *
+ *  @brief  Header file for the memory monitor class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_MEMORY_MONITOR_H
+#define LAR_RECO_MEMORY_MONITOR_H 1
+
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  MemoryMonitor class, recording the resident set size and heap in use around the processing and reset of each event
+ */
+class MemoryMonitor
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  reportFileName the name of the file to which to write the per-event records, in json format if the extension is .json, else csv
+     *  @param  nLargestEvents the number of events with the largest memory growth to list in the summary
+     */
+    MemoryMonitor(const std::string &reportFileName, const unsigned int nLargestEvents = 10);
+
+    /**
+     *  @brief  Record the memory in use before processing an event
+     *
+     *  @param  event the event number
+     */
+    void BeginEvent(const unsigned int event);
+
+    /**
+     *  @brief  Record the memory in use after processing the current event, before it is reset
+     */
+    void EndEventProcessing();
+
+    /**
+     *  @brief  Record the memory still in use after the current event has been reset
+     */
+    void EndEvent();
+
+    /**
+     *  @brief  Print a summary, naming the events with the largest memory growth, and write the per-event records to the report file
+     */
+    void WriteReport() const;
+
+private:
+    /**
+     *  @brief  EventRecord class, holding memory measurements for a single event, in megabytes
+     */
+    class EventRecord
+    {
+    public:
+        /**
+         *  @brief  Default constructor
+         */
+        EventRecord();
+
+        /**
+         *  @brief  Get the resident set size retained after the event was reset
+         *
+         *  @return the retained resident set size
+         */
+        double GetRetainedRss() const;
+
+        /**
+         *  @brief  Get the heap in use retained after the event was reset
+         *
+         *  @return the retained heap in use
+         */
+        double GetRetainedHeap() const;
+
+        unsigned int    m_event;                    ///< The event number
+        double          m_rssBefore;                ///< The resident set size before processing
+        double          m_rssPeak;                  ///< The peak resident set size during processing
+        double          m_rssAfterProcessing;       ///< The resident set size after processing, before reset
+        double          m_rssAfterReset;            ///< The resident set size after reset
+        double          m_heapBefore;               ///< The heap in use before processing
+        double          m_heapAfterProcessing;      ///< The heap in use after processing, before reset
+        double          m_heapAfterReset;           ///< The heap in use after reset
+    };
+
+    typedef std::vector<EventRecord> EventRecordList;
+
+    /**
+     *  @brief  Get the current resident set size of the process
+     *
+     *  @return the resident set size, in megabytes
+     */
+    static double GetResidentSetSize();
+
+    /**
+     *  @brief  Get the peak resident set size of the process, since it was last reset
+     *
+     *  @return the peak resident set size, in megabytes
+     */
+    static double GetPeakResidentSetSize();
+
+    /**
+     *  @brief  Reset the peak resident set size of the process to its current value, where supported by the kernel
+     */
+    static void ResetPeakResidentSetSize();
+
+    /**
+     *  @brief  Get the heap memory allocated and not yet freed
+     *
+     *  @return the heap in use, in megabytes
+     */
+    static double GetHeapInUse();
+
+    std::string         m_reportFileName;           ///< The name of the file to which to write the per-event records
+    unsigned int        m_nLargestEvents;           ///< The number of events with the largest memory growth to list in the summary
+    EventRecord         m_currentEventRecord;       ///< The record for the event in progress
+    EventRecordList     m_eventRecordList;          ///< The per-event records, for completed events
+};
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_MEMORY_MONITOR_H
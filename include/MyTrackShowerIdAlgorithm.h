@@ -10,6 +10,21 @@
 
 #include "Pandora/ExternallyConfiguredAlgorithm.h"
 #include "larpandoracontent/LArHelpers/LArMCParticleHelper.h"
+#include "larpandoracontent/LArPersistency/EventReadingAlgorithm.h"
+#include "EventArena.h"
+#include "HitEncoder.h"
+#include "HitImageBuilder.h"
+#include "HitOrdering.h"
+#include "Logger.h"
+#include "OutputCheckpoint.h"
+#include "OutputTuning.h"
+#include "PfoFeatureBuilder.h"
+#include "PfoColumnWriter.h"
+#include "PfoEntryIndex.h"
+#include "PfoEventTreeWriter.h"
+#include "PfoHitCache.h"
+#include "PfoTaskPool.h"
+#include "WriteBehindQueue.h"
 #include "TFile.h"
 #include "TTree.h"
 
@@ -26,6 +41,16 @@ struct ViewHits
     int					        nHitsMcp;			///< total number of hits for the (best matched) Monte Carlo particle
 };
 
+struct HitImage
+{
+    pandora::IntVector          *pPixelIndices;     ///< indices of the non-empty pixels, for sparse images
+    pandora::FloatVector        *pPixelValues;      ///< summed hit energy of the non-empty pixels if sparse, else of every pixel
+    float                       driftOrigin;        ///< drift coord of the lower edge of the image
+    float                       wireOrigin;         ///< wire coord of the lower edge of the image
+    float                       driftPitch;         ///< pixel size along the drift coord
+    float                       wirePitch;          ///< pixel size along the wire coord
+};
+
 /**
  *  @brief  MyTrackShowerIdAlgorithm class
  */
@@ -41,6 +66,21 @@ public:
         pandora::Algorithm *CreateAlgorithm() const;
     };
 
+    /**
+     *  @brief  External track shower id parameters class
+     */
+    class ExternalTrackShowerIdParameters : public lar_content::EventReadingAlgorithm::ExternalEventReadingParameters
+    {
+    public:
+        /**
+         *  @brief  Default constructor
+         */
+        ExternalTrackShowerIdParameters();
+
+        std::string     m_outputFileName;           ///< Name of output file, overriding the OutputFile setting if non-empty
+        unsigned int    m_firstEventId;             ///< The event id to assign to the first processed event
+    };
+
     /**
      *  @brief  Constructor
      */
@@ -50,40 +90,314 @@ public:
      */
     ~MyTrackShowerIdAlgorithm();
 
+    /**
+     *  @brief  Get a file name (without extension) from a file path
+     *
+     *  @param  filePath the file path
+     *
+     *  @return the file name
+     */
+    static std::string GetFileName(const std::string &filePath);
+
 private:
+    /**
+     *  @brief  MCFoldingNode class, an MC particle in the flattened hierarchy below an incident MC particle
+     */
+    class MCFoldingNode
+    {
+    public:
+        const pandora::MCParticle   *m_pMCParticle;         ///< The MC particle
+        int                         m_parentIndex;          ///< The index of the parent node, or -1 for the incident MC particle
+        unsigned int                m_hierarchyTier;        ///< The hierarchy tier, relative to the incident MC particle
+        bool                        m_isShowerProduct;      ///< Whether the MC particle descends from a shower particle
+        const pandora::CaloHitList  *m_pDirectCaloHits;     ///< The hits of the MC particle itself, or nullptr if none
+        unsigned int                m_nCaloHits;            ///< The number of direct hits, plus those folded in from unmapped descendants
+        bool                        m_isMapped;             ///< Whether the MC particle is mapped, i.e. receives its own selective map entry
+        pandora::CaloHitList        *m_pTargetCaloHits;     ///< The selective map hit list into which the direct hits are folded, if any
+    };
+
+    /**
+     *  @brief  PfoRecord class, the values of a pfo built by a task of the pfo task pool, then swapped into the bound variables to be written
+     */
+    class PfoRecord
+    {
+    public:
+        /**
+         *  @brief  Constructor, allocating the vectors
+         */
+        PfoRecord();
+
+        /**
+         *  @brief  Destructor, freeing the vectors
+         */
+        ~PfoRecord();
+
+        /**
+         *  @brief  Deleted copy constructor and assignment, as the record owns its vectors
+         */
+        PfoRecord(const PfoRecord &) = delete;
+        PfoRecord &operator=(const PfoRecord &) = delete;
+
+        const pandora::ParticleFlowObject   *m_pPfo;                ///< The pfo
+        unsigned int                        m_pfoId;                ///< The pfo id
+        int                                 m_parentPfoId;          ///< The parent pfo id
+        unsigned int                        m_hierarchyTier;        ///< The pfo hierarchy tier
+        pandora::IntVector                  *m_pDaughterPfoIds;     ///< The daughter pfo ids
+        bool                                m_hasVertex;            ///< Whether the pfo has a vertex
+        float                               m_vertex[3];            ///< The pfo vertex, if any
+        ViewHits                            m_UViewHits;            ///< U view calo hits
+        ViewHits                            m_VViewHits;            ///< V view calo hits
+        ViewHits                            m_WViewHits;            ///< W view calo hits
+        ViewHits                            m_ThreeDViewHits;       ///< 3D view calo hits
+        HitImage                            m_UHitImage;            ///< U view hit image
+        HitImage                            m_VHitImage;            ///< V view hit image
+        HitImage                            m_WHitImage;            ///< W view hit image
+        lar_reco::PfoFeatures               m_UFeatures;            ///< U view pfo features
+        lar_reco::PfoFeatures               m_VFeatures;            ///< V view pfo features
+        lar_reco::PfoFeatures               m_WFeatures;            ///< W view pfo features
+        lar_reco::PfoFeatures               m_ThreeDFeatures;       ///< 3D view pfo features
+        int                                 m_mcPdgCode;            ///< truth particle for this PFO
+        float                               m_mcpMomentum;          ///< truth particle momentum
+        unsigned int                        m_mcHierarchyTier;      ///< truth particle hierarchy tier
+        int                                 m_mcParentPdgCode;      ///< truth parent particle for this PFO
+        pandora::IntVector                  *m_pMcDaughterPdgCodes; ///< truth daughter particles for this PFO
+    };
+
+    /**
+     *  @brief  RecordWorkspace class, the configured builders with their scratch memory, one per worker of the pfo task pool
+     */
+    class RecordWorkspace
+    {
+    public:
+        lar_reco::HitOrdering               m_hitOrdering;          ///< The hit ordering
+        lar_reco::PfoFeatureBuilder         m_pfoFeatureBuilder;    ///< The pfo feature builder
+        lar_reco::HitImageBuilder           m_hitImageBuilder;      ///< The hit image builder
+    };
+
+    typedef std::vector<std::unique_ptr<PfoRecord>> PfoRecordList;
+    typedef std::vector<RecordWorkspace> RecordWorkspaceList;
+    typedef std::list<const pandora::MCParticle*, lar_reco::ArenaAllocator<const pandora::MCParticle*>> ArenaMCParticleList;
+    typedef std::array<unsigned int, 3> ViewHitCounts;
+    typedef std::unordered_map<const pandora::MCParticle*, ViewHitCounts> MCParticleToViewHitCountsMap;
+    typedef std::unordered_multimap<const pandora::CaloHit*, const pandora::MCParticle*> CaloHitToMCParticlesMap;
+    typedef std::vector<MCFoldingNode, lar_reco::ArenaAllocator<MCFoldingNode>> MCFoldingNodeVector;
+
     pandora::StatusCode Run();
     pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
 
-    unsigned int WritePfo(const pandora::ParticleFlowObject *const pPfo, const unsigned int pfoId = 0, const int parentPfoId = -1, const unsigned int hierarchyTier = 0);
-    void GetCaloHitInfo(const pandora::ParticleFlowObject *const pPfo, pandora::HitType hitType, ViewHits &viewHits);
-    std::string GetFileName(const std::string& filePath);
-    void GetIncidentMCPs(const pandora::MCParticleList *const pMCParticleList, pandora::MCParticleList &parentMCNuList);
+
+    /**
+     *  @brief  Add a record for a pfo and, first, for each of its descendants, allocating the pfo ids in the order the records are written
+     *
+     *  @param  pPfo the pfo
+     *  @param  pfoId the pfo id
+     *  @param  parentPfoId the parent pfo id, or -1 for none
+     *  @param  hierarchyTier the pfo hierarchy tier
+     *
+     *  @return the number of records added, i.e. one plus the number of descendants
+     */
+    unsigned int AddPfoRecords(const pandora::ParticleFlowObject *const pPfo, const unsigned int pfoId = 0, const int parentPfoId = -1, const unsigned int hierarchyTier = 0);
+
+    /**
+     *  @brief  Get the next unused record of the event, reusing the records of earlier events
+     *
+     *  @return the record
+     */
+    PfoRecord &GetNextPfoRecord();
+
+    /**
+     *  @brief  Build the records of the event, across the pfo task pool if there is one, then write them in the order they were added
+     */
+    void WritePfoRecords();
+
+    /**
+     *  @brief  Build the record of a pfo: its vertex, hits, truth match, features and images. Reads only event state that is fixed while
+     *          records are built, so records may be built concurrently, each with its own workspace
+     *
+     *  @param  record the record, its pfo and ids set
+     *  @param  workspace the workspace of the worker building the record
+     */
+    void BuildPfoRecord(PfoRecord &record, RecordWorkspace &workspace) const;
+
+    /**
+     *  @brief  Swap the values of a built record into the bound variables, and write them to the selected outputs
+     *
+     *  @param  record the record, left holding the previous contents of the bound vectors for reuse
+     */
+    void FillPfoRecord(PfoRecord &record);
+
+    void GetCaloHitInfo(const pandora::ParticleFlowObject *const pPfo, pandora::HitType hitType, ViewHits &viewHits, lar_reco::HitOrdering &hitOrdering,
+        const pandora::CartesianVector *const pVertex = nullptr) const;
+    void GetIncidentMCPs(const pandora::MCParticleList *const pMCParticleList, ArenaMCParticleList &parentMCNuList);
     void Mapper(
         const lar_content::LArMCParticleHelper::MCContributionMap &basicMap, 
         const pandora::MCParticle *const pMCParticle, 
-        const bool isShowerProduct, 
-        const unsigned int hierarchyTier, 
-        pandora::CaloHitList &caloHitsToMerge, 
         lar_content::LArMCParticleHelper::MCContributionMap &selectiveMap);
-    void GetBestMatchedMCParticleInfo(const pandora::ParticleFlowObject *const pPfo, ViewHits &UView, ViewHits &VView, ViewHits &WView);
-    void PrintMCParticles(const lar_content::LArMCParticleHelper::MCContributionMap &mcContributionMap, const unsigned int minHits = 1) const;
-    void PrintMCParticle(const pandora::MCParticle *const pMCParticle, const lar_content::LArMCParticleHelper::MCContributionMap &mcToTrueHitListMap, const unsigned int depth = 0, const unsigned int minHits = 1, bool printDaughters = true) const;
+    bool IsMapped(const MCFoldingNode &node) const;
+    void GetBestMatchedMCParticleInfo(const pandora::ParticleFlowObject *const pPfo, PfoRecord &record) const;
+    void CountFoldedHits();
+    ViewHitCounts CountSharedHits(const pandora::ParticleFlowObject *const pPfo, const pandora::MCParticle *const pMCParticle) const;
+    void PrintMCParticles(const lar_content::LArMCParticleHelper::MCContributionMap &mcContributionMap, std::ostream &stream, const unsigned int minHits = 1) const;
+    void PrintMCParticle(const pandora::MCParticle *const pMCParticle, const lar_content::LArMCParticleHelper::MCContributionMap &mcToTrueHitListMap, std::ostream &stream, const unsigned int depth = 0, const unsigned int minHits = 1, bool printDaughters = true) const;
     void GetPfoToHitsMap(const pandora::PfoList &pPfoList, lar_content::LArMCParticleHelper::PfoContributionMap &pfoToHitsMap);
 
+    /**
+     *  @brief  Bind a variable to a branch of the root tree and/or a column of the columnar file, as selected by the OutputFormat setting
+     *
+     *  @param  name the branch and column name
+     *  @param  pAddress the address of the variable
+     *
+     *  @return the address from which the outputs read the variable, a shadow copy in write-behind mode
+     */
+    template <typename T>
+    T *AddBranch(const std::string &name, T *const pAddress);
+
+    /**
+     *  @brief  Bind a pointer to a vector to a branch and/or column, as for AddBranch
+     *
+     *  @param  name the branch and column name
+     *  @param  ppAddress the address of the pointer to the vector
+     *  @param  offsetsName the name of the offsets branch used by the event layout, shared by vectors of the same length for every pfo
+     *
+     *  @return the address from which the outputs read the pointer, a shadow copy in write-behind mode
+     */
+    template <typename T>
+    std::vector<T> **AddBranch(const std::string &name, std::vector<T> **const ppAddress, const std::string &offsetsName);
+
+    /**
+     *  @brief  Bind a pointer to a vector to a branch of the root tree only, for value types the columnar file does not hold
+     *
+     *  @param  name the branch name
+     *  @param  ppAddress the address of the pointer to the vector
+     *  @param  offsetsName the name of the offsets branch used by the event layout, shared by vectors of the same length for every pfo
+     *
+     *  @return the address from which the tree reads the pointer, a shadow copy in write-behind mode
+     */
+    template <typename T>
+    std::vector<T> **AddRootBranch(const std::string &name, std::vector<T> **const ppAddress, const std::string &offsetsName);
+
+    /**
+     *  @brief  Bind a vector of hit values to a branch, or, if hit encoding is enabled, its codes and their range to the name with the
+     *          suffixes Codes, Min and Step
+     *
+     *  @param  name the branch name
+     *  @param  ppAddress the address of the pointer to the vector
+     *  @param  offsetsName the name of the offsets branch used by the event layout
+     *  @param  precision the quantisation step, if hit encoding is enabled
+     */
+    void AddHitBranch(const std::string &name, pandora::FloatVector **const ppAddress, const std::string &offsetsName, const float precision);
+
+    /**
+     *  @brief  Bind an event-level variable, written once per entry by the event layout, but for every pfo otherwise
+     *
+     *  @param  name the branch and column name
+     *  @param  pAddress the address of the variable
+     *
+     *  @return the address from which the outputs read the variable, a shadow copy in write-behind mode
+     */
+    template <typename T>
+    T *AddEventBranch(const std::string &name, T *const pAddress);
+
+    /**
+     *  @brief  Write the current pfo variables to the selected outputs, or queue them for the output thread in write-behind mode
+     */
+    void FillOutputs();
+
+    /**
+     *  @brief  Build the hit image of a pfo in a two dimensional view, centred as selected by the HitImages block
+     *
+     *  @param  viewHits the hits of the pfo in the view
+     *  @param  hitType the view
+     *  @param  pVertex the address of the pfo vertex, or nullptr if the pfo has none
+     *  @param  hitImageBuilder the hit image builder
+     *  @param  hitImage to receive the image
+     */
+    void BuildHitImage(const ViewHits &viewHits, const pandora::HitType hitType, const pandora::CartesianVector *const pVertex,
+        lar_reco::HitImageBuilder &hitImageBuilder, HitImage &hitImage) const;
+
+    /**
+     *  @brief  Compute the summary features of a pfo in a two dimensional view
+     *
+     *  @param  viewHits the hits of the pfo in the view
+     *  @param  hitType the view
+     *  @param  pVertex the address of the pfo vertex, or nullptr if the pfo has none
+     *  @param  pfoFeatureBuilder the pfo feature builder
+     *  @param  features to receive the features
+     */
+    void ComputeViewFeatures(const ViewHits &viewHits, const pandora::HitType hitType, const pandora::CartesianVector *const pVertex,
+        lar_reco::PfoFeatureBuilder &pfoFeatureBuilder, lar_reco::PfoFeatures &features) const;
+
+    /**
+     *  @brief  Bind the summary features of a view to scalar branches
+     *
+     *  @param  viewName the view name, appended to each branch name
+     *  @param  axisNames the names of the principal axis components, one per dimension
+     *  @param  features the features
+     */
+    void AddFeatureBranches(const std::string &viewName, const pandora::StringVector &axisNames, lar_reco::PfoFeatures &features);
+
+    /**
+     *  @brief  End the current event in the selected outputs, or queue the end of event for the output thread in write-behind mode
+     */
+    void EndOutputEvent();
+
+    /**
+     *  @brief  Write the pfo variables to the selected outputs, called by the output thread in write-behind mode
+     */
+    void WriteOutputs();
+
+    /**
+     *  @brief  End the event in the selected outputs, called by the output thread in write-behind mode
+     */
+    void WriteEndEvent();
+
     // Member variables here
     std::string     m_caloHitListName;          ///< Name of input calo hit list
     std::string     m_mcParticleListName;       ///< Name of input MC particle list
     std::string     m_pfoListName;              ///< Name of input PFO list
     unsigned int    m_mcMappingMinHits;         ///< Minimum number of hits for a MC particle to be mapped
+    lar_reco::Logger m_logger;                  ///< The logger, at the level given by the LogLevel setting
 
     std::string		m_treeName; 		        ///< Name of output tree
     std::string		m_fileName; 		        ///< Name of output file
     TFile			*m_pTFile;                  ///< ROOT tree file
     TTree			*m_pPfoTree;                ///< PFO tree
+    bool            m_writeEventLayout;         ///< Whether the tree holds one entry per event, rather than one entry per pfo
+    lar_reco::PfoEventTreeWriter *m_pEventTreeWriter; ///< The event layout tree writer
+    lar_reco::PfoEntryIndex m_pfoEntryIndex;    ///< The (eventId, pfoId) index of the pfo layout tree, maintained as the tree is filled
+    TTree           *m_pIndexTree;              ///< The tree to which the index is written, an event at a time
+    unsigned int    m_checkpointEvents;         ///< The number of events between checkpoints of the root output, zero to disable
+    float           m_checkpointMegabytes;      ///< The megabytes of pfo data filled between checkpoints of the root output, zero to disable
+    lar_reco::OutputCheckpoint *m_pOutputCheckpoint; ///< The checkpointing of the root output, if enabled
+    const unsigned int *m_pOutputEventId;       ///< The event id as read by the outputs
+    const unsigned int *m_pOutputPfoId;         ///< The pfo id as read by the outputs
+    unsigned int    m_writeBehindQueueSize;     ///< The number of pfo records the write-behind queue holds, zero to write synchronously
+    lar_reco::WriteBehindQueue *m_pWriteBehindQueue; ///< The queue to the output thread, in write-behind mode
+    bool            m_writeRootOutput;          ///< Whether to write the root tree
+    bool            m_writeColumnOutput;        ///< Whether to write the columnar file
+    std::string     m_columnFileName;           ///< Name of the columnar output file
+    lar_reco::PfoColumnWriter *m_pColumnWriter; ///< The columnar file writer
+    lar_reco::OutputTuning m_outputTuning;      ///< The root output settings, from the OutputTuning block
+    lar_reco::HitImageBuilder m_hitImageBuilder; ///< The hit image builder, enabled by the HitImages block
+    lar_reco::HitOrdering m_hitOrdering;        ///< The ordering of the hits of each pfo, from the HitOrder setting
+    lar_reco::HitEncoder m_hitEncoder;          ///< The hit value encoder, enabled by the HitEncoding block
+    unsigned int    m_isHitEncodingDelta;       ///< Whether the encoded hit values are delta encoded, as written to the outputs
+    lar_reco::PfoFeatureBuilder m_pfoFeatureBuilder; ///< The pfo feature builder, enabled by the PfoFeatures block
+    unsigned int    m_nPfoThreads;              ///< The number of threads building the pfo records of an event, including the algorithm thread
+    lar_reco::PfoTaskPool *m_pPfoTaskPool;      ///< The pool building the pfo records, if more than one thread
+    RecordWorkspaceList m_recordWorkspaces;     ///< The workspace of each worker building the pfo records
+    PfoRecordList   m_pfoRecords;               ///< The pfo records, reused between events
+    unsigned int    m_nPfoRecords;              ///< The number of pfo records used by the current event
+    float           m_imageDriftPitches[3];     ///< The U, V and W hit image drift pitches of the current event
+    float           m_imageWirePitches[3];      ///< The U, V and W hit image wire pitches of the current event
 
     lar_content::LArMCParticleHelper::MCContributionMap m_selectiveMap;                     ///< Bespoke mapping of MCParticles to associated Calohits
     lar_content::LArMCParticleHelper::PfoToMCParticleHitSharingMap m_pfoToMCHitSharingMap;  ///< Mapping from PFOs to associated MCParticles and their shared hits
     const pandora::MCParticle *m_incidentMcp;
+    MCParticleToViewHitCountsMap m_mcToViewHitCountsMap;                                    ///< The U, V and W hit counts of each folded MCParticle
+    CaloHitToMCParticlesMap m_caloHitToFoldedMCMap;                                         ///< The folded MCParticles to which each hit belongs
+    lar_reco::PfoHitCache m_pfoHitCache;                                                    ///< The hits of every pfo in the event, gathered once per event
+    lar_reco::EventArena m_eventArena;                                                      ///< Memory for the per-event working lists, released in bulk each event
 
     // PFO tree variables
     unsigned int        m_EventId;              ///< Current event id
@@ -96,6 +410,15 @@ private:
     ViewHits            m_VViewHits;            ///< V view calo hits
     ViewHits            m_WViewHits;            ///< W view calo hits
     ViewHits            m_ThreeDViewHits;       ///< 3D view calo hits
+    HitImage            m_UHitImage;            ///< U view hit image
+    HitImage            m_VHitImage;            ///< V view hit image
+    HitImage            m_WHitImage;            ///< W view hit image
+    unsigned int        m_nImageDriftPixels;    ///< The number of hit image pixel rows
+    unsigned int        m_nImageWirePixels;     ///< The number of hit image pixel columns
+    lar_reco::PfoFeatures m_UFeatures;          ///< U view pfo features
+    lar_reco::PfoFeatures m_VFeatures;          ///< V view pfo features
+    lar_reco::PfoFeatures m_WFeatures;          ///< W view pfo features
+    lar_reco::PfoFeatures m_ThreeDFeatures;     ///< 3D view pfo features
     unsigned int        m_mcNuanceCode;         ///< Interaction type
     int                 m_mcPdgCode;            ///< truth particle for this PFO
     float               m_mcpMomentum;          ///< truth particle momentum
@@ -111,4 +434,88 @@ inline pandora::Algorithm *MyTrackShowerIdAlgorithm::Factory::CreateAlgorithm()
     return new MyTrackShowerIdAlgorithm();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline T *MyTrackShowerIdAlgorithm::AddBranch(const std::string &name, T *const pAddress)
+{
+    T *const pOutputAddress(m_pWriteBehindQueue ? m_pWriteBehindQueue->Bind(pAddress) : pAddress);
+
+    if (m_pEventTreeWriter)
+    {
+        m_pEventTreeWriter->Branch(name, pOutputAddress);
+    }
+    else if (m_pPfoTree)
+    {
+        m_pPfoTree->Branch(name.c_str(), pOutputAddress);
+    }
+
+    if (m_pColumnWriter)
+        m_pColumnWriter->Branch(name, pOutputAddress);
+
+    return pOutputAddress;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline std::vector<T> **MyTrackShowerIdAlgorithm::AddBranch(const std::string &name, std::vector<T> **const ppAddress, const std::string &offsetsName)
+{
+    std::vector<T> **const ppOutputAddress(this->AddRootBranch(name, ppAddress, offsetsName));
+
+    if (m_pColumnWriter)
+        m_pColumnWriter->Branch(name, ppOutputAddress);
+
+    return ppOutputAddress;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline std::vector<T> **MyTrackShowerIdAlgorithm::AddRootBranch(const std::string &name, std::vector<T> **const ppAddress, const std::string &offsetsName)
+{
+    std::vector<T> **const ppOutputAddress(m_pWriteBehindQueue ? m_pWriteBehindQueue->Bind(ppAddress) : ppAddress);
+
+    if (m_pEventTreeWriter)
+    {
+        m_pEventTreeWriter->Branch(name, ppOutputAddress, offsetsName);
+    }
+    else if (m_pPfoTree)
+    {
+        m_pPfoTree->Branch(name.c_str(), ppOutputAddress);
+    }
+
+    return ppOutputAddress;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline T *MyTrackShowerIdAlgorithm::AddEventBranch(const std::string &name, T *const pAddress)
+{
+    T *const pOutputAddress(m_pWriteBehindQueue ? m_pWriteBehindQueue->BindEvent(pAddress) : pAddress);
+
+    if (m_pEventTreeWriter)
+    {
+        m_pEventTreeWriter->EventBranch(name, pOutputAddress);
+    }
+    else if (m_pPfoTree)
+    {
+        m_pPfoTree->Branch(name.c_str(), pOutputAddress);
+    }
+
+    if (m_pColumnWriter)
+        m_pColumnWriter->Branch(name, pOutputAddress);
+
+    return pOutputAddress;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline MyTrackShowerIdAlgorithm::ExternalTrackShowerIdParameters::ExternalTrackShowerIdParameters() :
+    m_outputFileName(""),
+    m_firstEventId(0)
+{
+}
+
 #endif // #ifndef MY_TRACK_SHOWER_ID_ALGORITHM_H
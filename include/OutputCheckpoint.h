@@ -0,0 +1,132 @@
+/**
+ *  @file   LArReco/include/OutputCheckpoint.h
+ *
+ *  @brief  Header file for the output checkpoint class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_OUTPUT_CHECKPOINT_H
+#define LAR_RECO_OUTPUT_CHECKPOINT_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include "TTree.h"
+
+class TFile;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  OutputCheckpoint class, periodically saving a pfo tree, and any index tree, to its file, along with a record of the events saved
+ *
+ *  A checkpoint auto-saves the trees, then appends a record of the last complete event to a checkpoint tree, named after the pfo tree with
+ *  the suffix Checkpoint, which is auto-saved last. The file of a killed job can then be recovered by root, and holds every event up to
+ *  the last checkpoint. Its trees may also hold entries written after the checkpoint, which a resumed job discards.
+ */
+class OutputCheckpoint
+{
+public:
+    /**
+     *  @brief  Record class, the state of the outputs at the end of an event
+     */
+    class Record
+    {
+    public:
+        unsigned int            m_nextEventId;          ///< The id of the first event not saved
+        Long64_t                m_nEntries;             ///< The number of pfo tree entries saved
+        Long64_t                m_nIndexEntries;        ///< The number of index tree entries saved
+    };
+
+    /**
+     *  @brief  Constructor, creating the checkpoint tree in the current root directory
+     *
+     *  @param  pfoTreeName the name of the pfo tree
+     *  @param  pPfoTree the address of the pfo tree
+     *  @param  pIndexTree the address of the index tree, or nullptr if there is none
+     *  @param  nEventsPerCheckpoint the number of events between checkpoints, zero to disable the event count
+     *  @param  nBytesPerCheckpoint the number of uncompressed bytes filled between checkpoints, zero to disable the byte count
+     *  @param  firstEventId the id of the first event to be written
+     */
+    OutputCheckpoint(const std::string &pfoTreeName, TTree *const pPfoTree, TTree *const pIndexTree, const unsigned int nEventsPerCheckpoint,
+        const Long64_t nBytesPerCheckpoint, const unsigned int firstEventId);
+
+    /**
+     *  @brief  Deleted copy constructor and assignment, as the checkpoint tree holds the address of the record
+     */
+    OutputCheckpoint(const OutputCheckpoint &) = delete;
+    OutputCheckpoint &operator=(const OutputCheckpoint &) = delete;
+
+    /**
+     *  @brief  Note the end of an event, once its entries are filled, writing a checkpoint if one is due
+     *
+     *  @param  nextEventId the id of the next event
+     */
+    void EndEvent(const unsigned int nextEventId);
+
+    /**
+     *  @brief  Write a checkpoint, covering the events up to the last call to EndEvent
+     */
+    void Write();
+
+    /**
+     *  @brief  Get the number of checkpoints written
+     *
+     *  @return the number of checkpoints
+     */
+    unsigned int GetNCheckpoints() const;
+
+    /**
+     *  @brief  Read the last checkpoint of a pfo tree from a file
+     *
+     *  @param  pTFile the address of the file
+     *  @param  pfoTreeName the name of the pfo tree
+     *  @param  record to receive the last checkpoint record
+     *
+     *  @return whether the file holds a checkpoint for the tree
+     */
+    static bool Read(TFile *const pTFile, const std::string &pfoTreeName, Record &record);
+
+    /**
+     *  @brief  Get the name of the checkpoint tree of a pfo tree
+     *
+     *  @param  pfoTreeName the name of the pfo tree
+     *
+     *  @return the name of the checkpoint tree
+     */
+    static std::string GetCheckpointTreeName(const std::string &pfoTreeName);
+
+    /**
+     *  @brief  Whether a tree is a checkpoint tree, rather than a tree of pfos, events or entries
+     *
+     *  @param  pTree the address of the tree
+     *
+     *  @return boolean
+     */
+    static bool IsCheckpointTree(const TTree *const pTree);
+
+private:
+    TTree                       *m_pPfoTree;            ///< The pfo tree
+    TTree                       *m_pIndexTree;          ///< The index tree, if any
+    TTree                       *m_pCheckpointTree;     ///< The checkpoint tree
+    unsigned int                m_nEventsPerCheckpoint; ///< The number of events between checkpoints, if non-zero
+    Long64_t                    m_nBytesPerCheckpoint;  ///< The number of uncompressed bytes filled between checkpoints, if non-zero
+    unsigned int                m_nEventsSinceCheckpoint; ///< The number of events ended since the last checkpoint
+    Long64_t                    m_nBytesAtCheckpoint;   ///< The uncompressed bytes filled in the pfo tree at the last checkpoint
+    unsigned int                m_nCheckpoints;         ///< The number of checkpoints written
+    Record                      m_lastEvent;            ///< The state of the outputs at the end of the last event
+    Record                      m_treeRecord;           ///< The record bound to the checkpoint tree
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int OutputCheckpoint::GetNCheckpoints() const
+{
+    return m_nCheckpoints;
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_OUTPUT_CHECKPOINT_H
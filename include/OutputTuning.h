@@ -0,0 +1,132 @@
+/**
+ *  @file   LArReco/include/OutputTuning.h
+ *
+ *  @brief  Header file for the output tuning class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_OUTPUT_TUNING_H
+#define LAR_RECO_OUTPUT_TUNING_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include <ostream>
+
+class TFile;
+class TTree;
+
+namespace pandora { class TiXmlHandle; }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  OutputTuning class, holding the root output settings read from an OutputTuning block, each left at the root default if absent
+ *
+ *  <OutputTuning>
+ *      <CompressionAlgorithm>ZSTD</CompressionAlgorithm>   ZLIB, LZMA, LZ4 or ZSTD
+ *      <CompressionLevel>5</CompressionLevel>              0 (uncompressed) to 9
+ *      <BasketSize>256000</BasketSize>                     the buffer size of every branch, in bytes
+ *      <AutoFlush>-30000000</AutoFlush>                    as TTree::SetAutoFlush, positive in entries, negative in bytes
+ *      <AutoSave>-300000000</AutoSave>                     as TTree::SetAutoSave, positive in entries, negative in bytes
+ *      <ImplicitMT>true</ImplicitMT>                       compress baskets using root implicit multithreading
+ *      <ImplicitMTThreads>4</ImplicitMTThreads>            the number of implicit multithreading threads, zero for root to choose
+ *      <ReportBranchSizes>true</ReportBranchSizes>         report the bytes written by each branch when the file is closed
+ *  </OutputTuning>
+ */
+class OutputTuning
+{
+public:
+    /**
+     *  @brief  Default constructor
+     */
+    OutputTuning();
+
+    /**
+     *  @brief  Read the settings from the OutputTuning block, if any, below an xml element
+     *
+     *  @param  xmlHandle the handle of the element containing the OutputTuning block
+     *
+     *  @return STATUS_CODE_SUCCESS, or STATUS_CODE_INVALID_PARAMETER if a setting is not recognised or out of range
+     */
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle &xmlHandle);
+
+    /**
+     *  @brief  Apply the compression settings to a file; must be called before any trees are created in the file
+     *
+     *  @param  pTFile the address of the file
+     */
+    void ApplyToFile(TFile *const pTFile) const;
+
+    /**
+     *  @brief  Apply the basket size, auto flush and auto save settings to a tree; must be called after its branches are created
+     *
+     *  @param  pTree the address of the tree
+     */
+    void ApplyToTree(TTree *const pTree) const;
+
+    /**
+     *  @brief  Enable root implicit multithreading, if requested
+     */
+    void EnableImplicitMT() const;
+
+    /**
+     *  @brief  Whether a compression algorithm or level was given
+     *
+     *  @return boolean
+     */
+    bool HasCompressionSettings() const;
+
+    /**
+     *  @brief  Get the combined compression settings, as passed to TFile::SetCompressionSettings, with root defaults for any not given
+     *
+     *  @return the compression settings
+     */
+    int GetCompressionSettings() const;
+
+    /**
+     *  @brief  Whether to report the bytes written by each branch
+     *
+     *  @return boolean
+     */
+    bool ShouldReportBranchSizes() const;
+
+    /**
+     *  @brief  Print the uncompressed and compressed bytes written by each branch of a tree, largest first
+     *
+     *  @param  pTree the address of the tree, whose baskets should have been written
+     *  @param  stream the stream to print to
+     */
+    static void PrintBranchSizes(TTree *const pTree, std::ostream &stream);
+
+private:
+    int                 m_compressionAlgorithm;         ///< The root compression algorithm, or -1 for the root default
+    int                 m_compressionLevel;             ///< The compression level, or -1 for the root default
+    int                 m_basketSize;                   ///< The branch buffer size, in bytes, or zero for the root default
+    long long           m_autoFlush;                    ///< The auto flush setting, or zero for the root default
+    long long           m_autoSave;                     ///< The auto save setting, or zero for the root default
+    bool                m_implicitMT;                   ///< Whether to enable root implicit multithreading
+    unsigned int        m_nImplicitMTThreads;           ///< The number of implicit multithreading threads, zero for root to choose
+    bool                m_reportBranchSizes;            ///< Whether to report the bytes written by each branch
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool OutputTuning::HasCompressionSettings() const
+{
+    return ((m_compressionAlgorithm >= 0) || (m_compressionLevel >= 0));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool OutputTuning::ShouldReportBranchSizes() const
+{
+    return m_reportBranchSizes;
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_OUTPUT_TUNING_H
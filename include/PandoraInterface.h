@@ -10,13 +10,21 @@
 
 #include "Pandora/PandoraInputTypes.h"
 
-namespace pandora {class Pandora;}
+#include "OutputCheckpoint.h"
+
+#include <atomic>
+
+namespace pandora {class Pandora; class FileReader; class TiXmlDocument; class TiXmlElement;}
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 namespace lar_reco
 {
 
+class AlgorithmTimer;
+class MemoryMonitor;
+class OutputTuning;
+
 /**
  *  @brief  Parameters class
  */
@@ -31,9 +39,21 @@ public:
     std::string         m_settingsFile;                 ///< The path to the pandora settings file (mandatory parameter)
     std::string         m_eventFileNameList;            ///< Colon-separated list of file names to be processed
     std::string         m_geometryFileName;             ///< Name of the file containing geometry information
+    std::string         m_outputFileName;               ///< Name of the MyTrackShowerIdAlgorithm output file, overriding the settings (optional)
+    std::string         m_timingReportFile;             ///< Name of the per-algorithm timing report file, timing disabled if empty (optional)
+    std::string         m_memoryReportFile;             ///< Name of the per-event memory report file, memory tracking disabled if empty (optional)
+    std::string         m_cacheDirectory;               ///< Directory in which to cache binary copies of xml geometry, disabled if empty (optional)
 
     int                 m_nEventsToProcess;             ///< The number of events to process (default all events in file)
     bool                m_shouldDisplayEventNumber;     ///< Whether event numbers should be displayed (default false)
+    int                 m_nWorkerProcesses;             ///< The number of worker processes between which to divide the events (default 1)
+    int                 m_nWorkerThreads;               ///< The number of threads, each with its own pandora instances, sharing the events (default 1)
+    int                 m_nReadAheadEvents;             ///< The number of events to decode in the background ahead of reconstruction (default 0)
+    unsigned int        m_firstEventId;                 ///< The event id to assign to the first processed event (default 0)
+    unsigned int        m_shardIndex;                   ///< The index of the shard of the events to process, counting from zero (default 0)
+    unsigned int        m_nShards;                      ///< The number of shards into which to divide the events (default 1)
+    int                 m_selectedEvent;                ///< The single event to process, numbered across the whole file list (default -1, all events)
+    bool                m_shouldResume;                 ///< Whether to continue from the last checkpoint of an existing output file (default false)
 
     bool                m_shouldRunAllHitsCosmicReco;   ///< Whether to run all hits cosmic-ray reconstruction
     bool                m_shouldRunStitching;           ///< Whether to stitch cosmic-ray muons crossing between volumes
@@ -47,21 +67,215 @@ public:
     pandora::InputInt   m_nEventsToSkip;                ///< The number of events to skip
 };
 
+/**
+ *  @brief  EventFile class, describing an input event file
+ */
+class EventFile
+{
+public:
+    std::string         m_fileName;                     ///< The event file name
+    unsigned int        m_nEvents;                      ///< The number of events in the file
+    unsigned int        m_firstEvent;                   ///< The number of the first event in the file, counting across the whole file list
+};
+
+typedef std::vector<EventFile> EventFileList;
+
+/**
+ *  @brief  EventFileCursor class, reading events of an event file list into a pandora instance. The file reader is kept between
+ *          events, so that reading events in increasing order costs a single pass over each file, later events in the same file being
+ *          reached by skipping forward from the last event read, rather than by scanning again from the start of the file
+ */
+class EventFileCursor
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pandora the pandora instance into which to read events
+     *  @param  eventFileList the list of input event files, which must outlive the cursor
+     */
+    EventFileCursor(const pandora::Pandora &pandora, const EventFileList &eventFileList);
+
+    /**
+     *  @brief  Destructor
+     */
+    ~EventFileCursor();
+
+    /**
+     *  @brief  Deleted copy constructor and assignment, as the cursor owns its file reader
+     */
+    EventFileCursor(const EventFileCursor &) = delete;
+    EventFileCursor &operator=(const EventFileCursor &) = delete;
+
+    /**
+     *  @brief  Read an event
+     *
+     *  @param  event the event number, counting across the whole file list
+     */
+    void ReadEvent(const unsigned int event);
+
+private:
+    const pandora::Pandora      &m_pandora;             ///< The pandora instance into which to read events
+    const EventFileList         &m_eventFileList;       ///< The list of input event files
+    pandora::FileReader         *m_pFileReader;         ///< The file reader, if a file has been opened
+    unsigned int                m_readerFile;           ///< The index of the file open in the reader
+    unsigned int                m_readerEvent;          ///< The event in the file at which the reader is positioned
+};
+
+/**
+ *  @brief  Create pandora instances and process events, handling any exceptions raised along the way
+ *
+ *  @param  parameters the application parameters
+ *
+ *  @return the exit code
+ */
+int RunPandora(const Parameters &parameters);
+
+/**
+ *  @brief  Install handlers for SIGTERM and SIGUSR1, each asking event processing to stop cleanly once the current event is complete, so that
+ *          the output files are written and closed as usual
+ */
+void InstallStopSignalHandlers();
+
+/**
+ *  @brief  Get the signal that asked event processing to stop
+ *
+ *  @return the signal number, or zero if no stop has been requested
+ */
+int GetStopSignal();
+
+/**
+ *  @brief  Get the exit code of a run, which is 128 plus the signal number if a run that otherwise succeeded was stopped by a signal
+ *
+ *  @param  errorNo the exit code, were processing not stopped
+ *
+ *  @return the exit code
+ */
+int GetStoppedExitCode(const int errorNo);
+
+/**
+ *  @brief  Get the name of a file derived from another, by inserting a suffix ahead of the extension
+ *
+ *  @param  fileName the original file name
+ *  @param  suffix the suffix
+ *
+ *  @return the derived file name
+ */
+std::string GetDerivedFileName(const std::string &fileName, const std::string &suffix);
+
+/**
+ *  @brief  Restrict the parameters to the requested shard of the events, giving the shard its own output file names
+ *
+ *  @param  parameters the application parameters, to be modified
+ *
+ *  @return success
+ */
+bool ApplyShard(Parameters &parameters);
+
+/**
+ *  @brief  Restrict the parameters to the single selected event, giving it its own output file name. Binary input files are indexed, so that
+ *          the event can be copied straight to a temporary event file, rather than reached by reading through the file list
+ *
+ *  @param  parameters the application parameters, to be modified
+ *  @param  temporaryFileName to receive the name of any temporary event file created, to be removed once processing is complete
+ *
+ *  @return success
+ */
+bool ApplyEventSelection(Parameters &parameters, std::string &temporaryFileName);
+
+/**
+ *  @brief  Restrict the parameters to a contiguous range of events, numbered across the whole file list
+ *
+ *  @param  eventFileList the list of input event files
+ *  @param  firstEvent the number of the first event that the parameters would otherwise process
+ *  @param  beginEvent the number of the first event in the range
+ *  @param  endEvent one past the number of the last event in the range
+ *  @param  parameters the application parameters, to be modified
+ */
+void SetEventRange(const EventFileList &eventFileList, const unsigned int firstEvent, const unsigned int beginEvent, const unsigned int endEvent,
+    Parameters &parameters);
+
+/**
+ *  @brief  Divide the events between forked worker processes, each running its own pandora instances, then merge their output files
+ *
+ *  @param  parameters the application parameters
+ *
+ *  @return the exit code
+ */
+int ProcessEventsInWorkers(const Parameters &parameters);
+
+/**
+ *  @brief  Share the events between threads, each owning its own pandora instances, then merge their output files in event order
+ *
+ *  @param  parameters the application parameters
+ *
+ *  @return the exit code
+ */
+int ProcessEventsInThreads(const Parameters &parameters);
+
+/**
+ *  @brief  Reconstruct events in order, while a background thread decodes the following events into spare sets of pandora instances
+ *
+ *  @param  parameters the application parameters
+ *
+ *  @return the exit code
+ */
+int ProcessEventsWithReadAhead(const Parameters &parameters);
+
+/**
+ *  @brief  Continue an interrupted job from the last checkpoint of its output file, processing the remaining events into a separate file,
+ *          then merging the two. Without an output file, all events are processed as usual
+ *
+ *  @param  parameters the application parameters
+ *
+ *  @return the exit code
+ */
+int ProcessEventsWithResume(const Parameters &parameters);
+
+/**
+ *  @brief  Process events taken from a queue shared between threads, reading each event directly into the supplied pandora instance
+ *
+ *  @param  parameters the application parameters
+ *  @param  pPrimaryPandora the address of the primary pandora instance, owned by the calling thread
+ *  @param  eventFileList the list of input event files
+ *  @param  endEvent one past the number of the last event to process
+ *  @param  nextEvent the head of the shared queue, holding the number of the next event to process
+ *  @param  processedEvents to receive the numbers of the events processed, in order
+ */
+void ProcessEventQueue(const Parameters &parameters, const pandora::Pandora *const pPrimaryPandora, const EventFileList &eventFileList,
+    const unsigned int endEvent, std::atomic<unsigned int> &nextEvent, pandora::UIntVector &processedEvents);
+
 /**
  *  @brief  Create pandora instances
  * 
  *  @param  parameters the parameters
  *  @param  pPrimaryPandora to receive the address of the primary pandora instance
+ *  @param  pAlgorithmTimer the address of the algorithm timer with which to instrument the settings, or nullptr to disable timing
  */
-void CreatePandoraInstances(const Parameters &parameters, const pandora::Pandora *&pPrimaryPandora);
+void CreatePandoraInstances(const Parameters &parameters, const pandora::Pandora *&pPrimaryPandora, AlgorithmTimer *const pAlgorithmTimer = nullptr);
+
+/**
+ *  @brief  Create several independent sets of pandora instances, into which events will be read by the caller
+ *
+ *  @param  parameters the application parameters
+ *  @param  outputFileName the name of the merged output file, from which the name of the output file for each set is derived
+ *  @param  suffix the suffix, followed by the set number, to add to the stem of the output file name for each set
+ *  @param  nSets the number of sets of pandora instances to create
+ *  @param  pAlgorithmTimer the address of the algorithm timer with which to instrument the settings, or nullptr to disable timing
+ *  @param  primaryPandoraList to receive the addresses of the primary pandora instances, to be deleted by the caller even upon failure
+ *  @param  outputFileNames to receive the names of the output files for each set
+ */
+void CreatePandoraInstanceSets(const Parameters &parameters, const std::string &outputFileName, const std::string &suffix, const unsigned int nSets,
+    AlgorithmTimer *const pAlgorithmTimer, std::vector<const pandora::Pandora*> &primaryPandoraList, pandora::StringVector &outputFileNames);
 
 /**
  *  @brief  Process events using the supplied pandora instances
  *
  *  @param  parameters the application parameters
  *  @param  pPrimaryPandora the address of the primary pandora instance
+ *  @param  pMemoryMonitor the address of the memory monitor with which to record each event, or nullptr to disable memory tracking
  */
-void ProcessEvents(const Parameters &parameters, const pandora::Pandora *const pPrimaryPandora);
+void ProcessEvents(const Parameters &parameters, const pandora::Pandora *const pPrimaryPandora, MemoryMonitor *const pMemoryMonitor = nullptr);
 
 /**
  *  @brief  Parse the command line arguments, setting the application parameters
@@ -81,6 +295,16 @@ bool ParseCommandLine(int argc, char *argv[], Parameters &parameters);
  */
 bool PrintOptions();
 
+/**
+ *  @brief  Parse a shard option string, of the form i/N, setting the shard index and number of shards
+ *
+ *  @param  shardOption the shard option string
+ *  @param  parameters to receive the application parameters
+ *
+ *  @return success
+ */
+bool ParseShardOption(const std::string &shardOption, Parameters &parameters);
+
 /**
  *  @brief  Process the provided reco option string to perform high-level steering
  *
@@ -91,6 +315,194 @@ bool PrintOptions();
  */
 bool ProcessRecoOption(const std::string &recoOption, Parameters &parameters);
 
+/**
+ *  @brief  Prepare to divide events between parallel workers, identifying the events to process and the name of the merged output file
+ *
+ *  @param  parameters the application parameters
+ *  @param  eventFileList to receive the list of input event files
+ *  @param  firstEvent to receive the number of the first event to process
+ *  @param  nEventsToProcess to receive the number of events to process
+ *  @param  outputFileName to receive the name of the merged output file
+ *
+ *  @return success
+ */
+bool PrepareEventDivision(const Parameters &parameters, EventFileList &eventFileList, unsigned int &firstEvent, unsigned int &nEventsToProcess,
+    std::string &outputFileName);
+
+/**
+ *  @brief  Get the list of input event files, counting the events in each
+ *
+ *  @param  eventFileNameList the colon-separated list of event file names
+ *  @param  eventFileList to receive the list of event files
+ */
+void GetEventFileList(const std::string &eventFileNameList, EventFileList &eventFileList);
+
+/**
+ *  @brief  Find the file containing a given event
+ *
+ *  @param  eventFileList the list of input event files
+ *  @param  event the event number, counting across the whole file list
+ *
+ *  @return the index of the file in the list
+ */
+unsigned int FindEventFile(const EventFileList &eventFileList, const unsigned int event);
+
+/**
+ *  @brief  Count the events in an event file, using the sidecar event index for binary files
+ *
+ *  @param  pandora a pandora instance with which to read the file
+ *  @param  fileName the event file name
+ *
+ *  @return the number of events
+ */
+unsigned int CountEvents(const pandora::Pandora &pandora, const std::string &fileName);
+
+/**
+ *  @brief  Whether an event file contains an event with the specified number
+ *
+ *  @param  pandora a pandora instance with which to read the file
+ *  @param  fileName the event file name
+ *  @param  eventNumber the event number
+ *
+ *  @return boolean
+ */
+bool HasEvent(const pandora::Pandora &pandora, const std::string &fileName, const unsigned int eventNumber);
+
+/**
+ *  @brief  Create a reader for an xml or binary event file, configured to create lar objects
+ *
+ *  @param  pandora the pandora instance into which to read events
+ *  @param  fileName the event file name
+ *
+ *  @return the address of the new file reader, ownership passed to the caller
+ */
+pandora::FileReader *CreateEventFileReader(const pandora::Pandora &pandora, const std::string &fileName);
+
+/**
+ *  @brief  Get the name of the file to which MyTrackShowerIdAlgorithm will write its output
+ *
+ *  @param  parameters the application parameters
+ *
+ *  @return the output file name
+ */
+std::string GetOutputFileName(const Parameters &parameters);
+
+/**
+ *  @brief  Read the OutputTuning settings of MyTrackShowerIdAlgorithm, so that merged output files are written in the same way
+ *
+ *  @param  parameters the application parameters
+ *  @param  outputTuning to receive the output tuning, left unchanged if there is no OutputTuning block
+ */
+void ReadOutputTuning(const Parameters &parameters, OutputTuning &outputTuning);
+
+/**
+ *  @brief  Load the settings file and find the element of the first MyTrackShowerIdAlgorithm in the top-level settings
+ *
+ *  @param  parameters the application parameters
+ *  @param  xmlDocument the document into which to load the settings file
+ *
+ *  @return the address of the algorithm element, or nullptr if there is none
+ */
+pandora::TiXmlElement *FindTrackShowerIdSettings(const Parameters &parameters, pandora::TiXmlDocument &xmlDocument);
+
+/**
+ *  @brief  Merge the trees in a list of root files into a single output file
+ *
+ *  @param  inputFileNames the input file names
+ *  @param  outputFileName the output file name
+ *  @param  outputTuning the output tuning, whose compression settings are used for the output file
+ *
+ *  @return success
+ */
+bool MergeOutputFiles(const pandora::StringVector &inputFileNames, const std::string &outputFileName, const OutputTuning &outputTuning);
+
+/**
+ *  @brief  Write the entry indices of pfo trees merged by MergeOutputFiles, concatenating the index of each input file
+ *
+ *  @param  inputFileNames the input file names, in the order in which they were merged
+ *  @param  pfoTreeNames the names of the indexed pfo trees
+ *  @param  outputFileName the merged output file name
+ *
+ *  @return success
+ */
+bool MergeEntryIndices(const pandora::StringVector &inputFileNames, const pandora::StringVector &pfoTreeNames, const std::string &outputFileName);
+
+/**
+ *  @brief  Merge the output files of several sets of pandora instances in event order, numbering events by their position in the input
+ *
+ *  @param  parameters the application parameters
+ *  @param  firstEvent the number of the first event processed, counting across the whole file list
+ *  @param  inputFileNames the output file names for each set, which are removed once merged
+ *  @param  eventLists for each set, the numbers of the events processed, in order
+ *  @param  outputFileName the merged output file name
+ *
+ *  @return the exit code
+ */
+int MergeOutputFilesByEvent(const Parameters &parameters, const unsigned int firstEvent, const pandora::StringVector &inputFileNames,
+    const std::vector<pandora::UIntVector> &eventLists, const std::string &outputFileName);
+
+/**
+ *  @brief  Merge the trees in a list of root files into a single output file, interleaving entries in order of event id
+ *
+ *  @param  inputFileNames the input file names
+ *  @param  eventIdLists for each input file, the final event id of each event in the file, indexed by the event id stored in the file
+ *  @param  outputFileName the output file name
+ *  @param  outputTuning the output tuning, applied to the output file and trees
+ *
+ *  @return success
+ */
+bool MergeOutputFilesInEventOrder(const pandora::StringVector &inputFileNames, const std::vector<pandora::UIntVector> &eventIdLists,
+    const std::string &outputFileName, const OutputTuning &outputTuning);
+
+/**
+ *  @brief  Merge a list of columnar pfo files into a single output file
+ *
+ *  @param  inputFileNames the input file names
+ *  @param  eventIdLists if empty, rows are concatenated in file order; otherwise, for each input file, the final event id of each event
+ *          in the file, indexed by the event id stored in the file, with rows interleaved in order of final event id
+ *  @param  outputFileName the output file name
+ *
+ *  @return success
+ */
+bool MergeColumnFiles(const pandora::StringVector &inputFileNames, const std::vector<pandora::UIntVector> &eventIdLists,
+    const std::string &outputFileName);
+
+/**
+ *  @brief  Read the last checkpoint of the pfo tree in an output file
+ *
+ *  @param  fileName the output file name
+ *  @param  record to receive the last checkpoint record
+ *
+ *  @return whether the file could be opened, and holds a checkpoint
+ */
+bool ReadOutputCheckpoint(const std::string &fileName, OutputCheckpoint::Record &record);
+
+/**
+ *  @brief  Merge the set-aside output of an interrupted job with that of the job resuming it, removing both once merged. Files with no
+ *          checkpoint are ignored, as are columnar files unless every merged root file has one
+ *
+ *  @param  checkpointFileName the set-aside output file name
+ *  @param  resumedFileName the output file name of the resuming job
+ *  @param  outputFileName the merged output file name
+ *  @param  outputTuning the output tuning, applied to the output file and trees
+ *
+ *  @return success
+ */
+bool MergeResumedOutputFiles(const std::string &checkpointFileName, const std::string &resumedFileName, const std::string &outputFileName,
+    const OutputTuning &outputTuning);
+
+/**
+ *  @brief  Merge the trees in a list of checkpointed root files into a single, checkpointed output file, concatenating the entries of each
+ *          file up to its last checkpoint
+ *
+ *  @param  inputFileNames the input file names, in event order
+ *  @param  outputFileName the output file name
+ *  @param  outputTuning the output tuning, applied to the output file and trees
+ *
+ *  @return success
+ */
+bool MergeCheckpointedOutputFiles(const pandora::StringVector &inputFileNames, const std::string &outputFileName, const OutputTuning &outputTuning);
+
 /**
  *  @brief  Process list of external, commandline parameters to be passed to specific algorithms
  *
@@ -106,8 +518,20 @@ inline Parameters::Parameters() :
     m_settingsFile(""),
     m_eventFileNameList(""),
     m_geometryFileName(""),
+    m_outputFileName(""),
+    m_timingReportFile(""),
+    m_memoryReportFile(""),
+    m_cacheDirectory(""),
     m_nEventsToProcess(-1),
     m_shouldDisplayEventNumber(false),
+    m_nWorkerProcesses(1),
+    m_nWorkerThreads(1),
+    m_nReadAheadEvents(0),
+    m_firstEventId(0),
+    m_shardIndex(0),
+    m_nShards(1),
+    m_selectedEvent(-1),
+    m_shouldResume(false),
     m_shouldRunAllHitsCosmicReco(true),
     m_shouldRunStitching(true),
     m_shouldRunCosmicHitRemoval(true),
@@ -0,0 +1,45 @@
+/**
+ *  @file   LArReco/include/PfoColumnCheck.h
+ *
+ *  @brief  Header file for the columnar pfo file round-trip check.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_PFO_COLUMN_CHECK_H
+#define LAR_RECO_PFO_COLUMN_CHECK_H 1
+
+#include "PfoColumnReader.h"
+
+class TTree;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  Compare a root pfo tree with a columnar pfo file written alongside it, i.e. with the OutputFormat setting Both
+ *
+ *  @param  rootFileName the root file name
+ *  @param  treeName the tree name
+ *  @param  columnFileName the columnar file name
+ *
+ *  @return the number of differences found, counting a missing branch, column or row as a difference
+ */
+unsigned int ComparePfoOutputs(const std::string &rootFileName, const std::string &treeName, const std::string &columnFileName);
+
+/**
+ *  @brief  Compare a single branch of a root pfo tree, holding a scalar, fixed size array or vector, with a column, value by value
+ *
+ *  @param  pTree the address of the tree
+ *  @param  columnReader the columnar file reader
+ *  @param  name the branch and column name
+ *
+ *  @return the number of rows that differ
+ */
+template <typename T>
+unsigned int CompareBranch(TTree *const pTree, const PfoColumnReader &columnReader, const std::string &name);
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_PFO_COLUMN_CHECK_H
@@ -0,0 +1,88 @@
+/**
+ *  @file   LArReco/include/PfoColumnFormat.h
+ *
+ *  @brief  Header file describing the columnar pfo file format.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_PFO_COLUMN_FORMAT_H
+#define LAR_RECO_PFO_COLUMN_FORMAT_H 1
+
+#include <cstdint>
+#include <string>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  The columnar pfo file holds one row per pfo. All values are stored in the byte order of the machine that wrote the file.
+ *
+ *      header      char[8] magic "LRPFOCOL", uint32 version, uint32 reserved
+ *      blocks      for each column, its values, as one contiguous array; for jagged columns, followed by an offsets table of
+ *                  nRows + 1 uint64 entries, the values of row i being [offsets[i], offsets[i + 1]). Every block starts on a
+ *                  COLUMN_BLOCK_ALIGNMENT byte boundary
+ *      footer      uint64 nRows, uint32 nColumns, then for each column: uint32 name length, name, uint32 column type,
+ *                  uint32 is jagged, uint64 values offset, uint64 number of values, uint64 offsets table offset (zero if not jagged)
+ *      trailer     uint64 footer offset, char[8] magic "LRPFOCOL"
+ *
+ *  Scalar columns hold exactly one value per row.
+ */
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  Column value types
+ */
+enum ColumnType
+{
+    COLUMN_FLOAT32 = 0,
+    COLUMN_INT32 = 1,
+    COLUMN_UINT32 = 2
+};
+
+/**
+ *  @brief  ColumnTypeTraits class, mapping a c++ value type to its column type
+ */
+template <typename T>
+class ColumnTypeTraits;
+
+template <>
+class ColumnTypeTraits<float>
+{
+public:
+    static const ColumnType COLUMN_TYPE = COLUMN_FLOAT32;
+};
+
+template <>
+class ColumnTypeTraits<int>
+{
+public:
+    static const ColumnType COLUMN_TYPE = COLUMN_INT32;
+};
+
+template <>
+class ColumnTypeTraits<unsigned int>
+{
+public:
+    static const ColumnType COLUMN_TYPE = COLUMN_UINT32;
+};
+
+static const char COLUMN_FILE_MAGIC[8] = {'L', 'R', 'P', 'F', 'O', 'C', 'O', 'L'};    ///< The magic at the start and end of the file
+static const uint32_t COLUMN_FILE_VERSION = 1;                                          ///< The file format version
+static const uint64_t COLUMN_FILE_HEADER_SIZE = 16;                                     ///< The size of the header, in bytes
+static const uint64_t COLUMN_FILE_TRAILER_SIZE = 16;                                    ///< The size of the trailer, in bytes
+static const uint64_t COLUMN_BLOCK_ALIGNMENT = 64;                                      ///< The alignment of each block, in bytes
+static const uint64_t COLUMN_VALUE_SIZE = 4;                                            ///< The size of a value of any column type, in bytes
+
+/**
+ *  @brief  Get the name of the columnar file to accompany, or replace, a root output file
+ *
+ *  @param  outputFileName the root output file name
+ *
+ *  @return the columnar file name, with any .root extension replaced by .pfocol
+ */
+std::string GetColumnFileName(const std::string &outputFileName);
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_PFO_COLUMN_FORMAT_H
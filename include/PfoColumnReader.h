@@ -0,0 +1,383 @@
+/**
+ *  @file   LArReco/include/PfoColumnReader.h
+ *
+ *  @brief  Header file for the pfo column reader class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_PFO_COLUMN_READER_H
+#define LAR_RECO_PFO_COLUMN_READER_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include "PfoColumnFormat.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  ColumnView class, a read-only view of values held in a mapped columnar pfo file
+ */
+template <typename T>
+class ColumnView
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pBegin the address of the first value
+     *  @param  size the number of values
+     */
+    ColumnView(const T *const pBegin, const std::size_t size);
+
+    /**
+     *  @brief  Get the address of the first value
+     *
+     *  @return the address of the first value
+     */
+    const T *begin() const;
+
+    /**
+     *  @brief  Get the address one past the last value
+     *
+     *  @return the address one past the last value
+     */
+    const T *end() const;
+
+    /**
+     *  @brief  Get the number of values
+     *
+     *  @return the number of values
+     */
+    std::size_t size() const;
+
+    /**
+     *  @brief  Get a value
+     *
+     *  @param  index the index of the value
+     *
+     *  @return the value
+     */
+    const T &operator[](const std::size_t index) const;
+
+private:
+    const T                     *m_pBegin;              ///< The address of the first value
+    std::size_t                 m_size;                 ///< The number of values
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  PfoColumnReader class, mapping a columnar pfo file into memory and giving zero-copy views of its columns
+ *
+ *  The file is validated when opened, including the offsets table of each jagged column, so views of rows need no further checks.
+ */
+class PfoColumnReader
+{
+public:
+    /**
+     *  @brief  Constructor, mapping and validating the file
+     *
+     *  @param  fileName the name of the file
+     */
+    PfoColumnReader(const std::string &fileName);
+
+    /**
+     *  @brief  Destructor, unmapping the file; views into the file must not be used afterwards
+     */
+    ~PfoColumnReader();
+
+    /**
+     *  @brief  Deleted copy constructor and assignment, as the reader owns its mapping
+     */
+    PfoColumnReader(const PfoColumnReader &) = delete;
+    PfoColumnReader &operator=(const PfoColumnReader &) = delete;
+
+    /**
+     *  @brief  Get the number of rows, i.e. pfos
+     *
+     *  @return the number of rows
+     */
+    uint64_t GetNRows() const;
+
+    /**
+     *  @brief  Get the column names, in the order in which they were written
+     *
+     *  @return the column names
+     */
+    const pandora::StringVector &GetColumnNames() const;
+
+    /**
+     *  @brief  Whether the file holds a column
+     *
+     *  @param  name the column name
+     *
+     *  @return whether the column is present
+     */
+    bool HasColumn(const std::string &name) const;
+
+    /**
+     *  @brief  Get the type of a column
+     *
+     *  @param  name the column name
+     *
+     *  @return the column type
+     */
+    ColumnType GetColumnType(const std::string &name) const;
+
+    /**
+     *  @brief  Whether a column is jagged
+     *
+     *  @param  name the column name
+     *
+     *  @return whether the column is jagged
+     */
+    bool IsJagged(const std::string &name) const;
+
+    /**
+     *  @brief  Get all values of a column, throwing if T does not match the column type
+     *
+     *  @param  name the column name
+     *
+     *  @return the values
+     */
+    template <typename T>
+    ColumnView<T> GetValues(const std::string &name) const;
+
+    /**
+     *  @brief  Get the offsets table of a jagged column, of GetNRows() + 1 entries
+     *
+     *  @param  name the column name
+     *
+     *  @return the offsets table
+     */
+    ColumnView<uint64_t> GetOffsets(const std::string &name) const;
+
+    /**
+     *  @brief  Get the values of a column in a single row, throwing if T does not match the column type
+     *
+     *  @param  name the column name
+     *  @param  row the row
+     *
+     *  @return the values
+     */
+    template <typename T>
+    ColumnView<T> GetRowValues(const std::string &name, const uint64_t row) const;
+
+    /**
+     *  @brief  Get the values of a column in a single row as raw 32 bit words, whatever the column type, e.g. for copying between files
+     *
+     *  @param  name the column name
+     *  @param  row the row
+     *
+     *  @return the raw values
+     */
+    ColumnView<uint32_t> GetRawRowValues(const std::string &name, const uint64_t row) const;
+
+private:
+    /**
+     *  @brief  Column class
+     */
+    class Column
+    {
+    public:
+        ColumnType              m_columnType;           ///< The column type
+        bool                    m_isJagged;             ///< Whether the column is jagged
+        uint64_t                m_valuesOffset;         ///< The offset of the values in the file
+        uint64_t                m_nValues;              ///< The number of values
+        uint64_t                m_offsetsOffset;        ///< The offset of the offsets table in the file, for jagged columns
+    };
+
+    typedef std::unordered_map<std::string, Column> ColumnMap;
+
+    /**
+     *  @brief  Read the footer, validating the position of each block
+     */
+    void ReadFooter();
+
+    /**
+     *  @brief  Read a value from the footer, throwing if it would read beyond the trailer
+     *
+     *  @param  position the position in the file, updated to the end of the value
+     *  @param  pValue the address to receive the value
+     *  @param  nBytes the size of the value
+     */
+    void ReadFooterBytes(uint64_t &position, void *const pValue, const uint64_t nBytes) const;
+
+    /**
+     *  @brief  Get a column, throwing if it is not present
+     *
+     *  @param  name the column name
+     *
+     *  @return the column
+     */
+    const Column &GetColumn(const std::string &name) const;
+
+    /**
+     *  @brief  Get a column, throwing if it is not present or T does not match its type
+     *
+     *  @param  name the column name
+     *
+     *  @return the column
+     */
+    template <typename T>
+    const Column &GetTypedColumn(const std::string &name) const;
+
+    /**
+     *  @brief  Get the values of a column in a single row, without checking the column type
+     *
+     *  @param  column the column
+     *  @param  row the row
+     *
+     *  @return the values
+     */
+    template <typename T>
+    ColumnView<T> GetColumnRowValues(const Column &column, const uint64_t row) const;
+
+    std::string                 m_fileName;             ///< The file name
+    const char                  *m_pData;               ///< The address of the mapped file
+    uint64_t                    m_fileSize;             ///< The size of the file
+    uint64_t                    m_footerOffset;         ///< The offset of the footer
+    uint64_t                    m_nRows;                ///< The number of rows
+    pandora::StringVector       m_columnNames;          ///< The column names, in the order in which they were written
+    ColumnMap                   m_columnMap;            ///< The columns, by name
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline ColumnView<T>::ColumnView(const T *const pBegin, const std::size_t size) :
+    m_pBegin(pBegin),
+    m_size(size)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const T *ColumnView<T>::begin() const
+{
+    return m_pBegin;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const T *ColumnView<T>::end() const
+{
+    return m_pBegin + m_size;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline std::size_t ColumnView<T>::size() const
+{
+    return m_size;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const T &ColumnView<T>::operator[](const std::size_t index) const
+{
+    return m_pBegin[index];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t PfoColumnReader::GetNRows() const
+{
+    return m_nRows;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const pandora::StringVector &PfoColumnReader::GetColumnNames() const
+{
+    return m_columnNames;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool PfoColumnReader::HasColumn(const std::string &name) const
+{
+    return (m_columnMap.count(name) > 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline ColumnType PfoColumnReader::GetColumnType(const std::string &name) const
+{
+    return this->GetColumn(name).m_columnType;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool PfoColumnReader::IsJagged(const std::string &name) const
+{
+    return this->GetColumn(name).m_isJagged;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline ColumnView<T> PfoColumnReader::GetValues(const std::string &name) const
+{
+    const Column &column(this->GetTypedColumn<T>(name));
+    return ColumnView<T>(reinterpret_cast<const T*>(m_pData + column.m_valuesOffset), column.m_nValues);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline ColumnView<T> PfoColumnReader::GetRowValues(const std::string &name, const uint64_t row) const
+{
+    const Column &column(this->GetTypedColumn<T>(name));
+    return this->GetColumnRowValues<T>(column, row);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline ColumnView<uint32_t> PfoColumnReader::GetRawRowValues(const std::string &name, const uint64_t row) const
+{
+    return this->GetColumnRowValues<uint32_t>(this->GetColumn(name), row);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline ColumnView<T> PfoColumnReader::GetColumnRowValues(const Column &column, const uint64_t row) const
+{
+    if (row >= m_nRows)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_OUT_OF_RANGE);
+
+    const T *const pValues(reinterpret_cast<const T*>(m_pData + column.m_valuesOffset));
+
+    if (!column.m_isJagged)
+        return ColumnView<T>(pValues + row, 1);
+
+    const uint64_t *const pOffsets(reinterpret_cast<const uint64_t*>(m_pData + column.m_offsetsOffset));
+    return ColumnView<T>(pValues + pOffsets[row], pOffsets[row + 1] - pOffsets[row]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const PfoColumnReader::Column &PfoColumnReader::GetTypedColumn(const std::string &name) const
+{
+    const Column &column(this->GetColumn(name));
+
+    if (ColumnTypeTraits<T>::COLUMN_TYPE != column.m_columnType)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+
+    return column;
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_PFO_COLUMN_READER_H
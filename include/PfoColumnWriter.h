@@ -0,0 +1,258 @@
+/**
+ *  @file   LArReco/include/PfoColumnWriter.h
+ *
+ *  @brief  Header file for the pfo column writer class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_PFO_COLUMN_WRITER_H
+#define LAR_RECO_PFO_COLUMN_WRITER_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include "PfoColumnFormat.h"
+
+#include <cstdio>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  PfoColumnWriter class, writing rows of values to a columnar pfo file
+ *
+ *  Like a root tree, columns are bound to the addresses of variables, which are read on each call to Fill. The values of each column,
+ *  and the offsets table of each jagged column, are spilled to unlinked temporary files as rows are filled, then gathered into
+ *  contiguous blocks when the file is closed, so memory use does not grow with the number of rows.
+ */
+class PfoColumnWriter
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  fileName the name of the file to write when closed
+     */
+    PfoColumnWriter(const std::string &fileName);
+
+    /**
+     *  @brief  Destructor, discarding the rows if the file has not been closed
+     */
+    ~PfoColumnWriter();
+
+    /**
+     *  @brief  Deleted copy constructor and assignment, as the writer owns its spill files
+     */
+    PfoColumnWriter(const PfoColumnWriter &) = delete;
+    PfoColumnWriter &operator=(const PfoColumnWriter &) = delete;
+
+    /**
+     *  @brief  Add a scalar column, bound to a variable
+     *
+     *  @param  name the column name
+     *  @param  pAddress the address of the variable
+     */
+    template <typename T>
+    void Branch(const std::string &name, const T *const pAddress);
+
+    /**
+     *  @brief  Add a jagged column, bound to a pointer to a vector
+     *
+     *  @param  name the column name
+     *  @param  ppAddress the address of the pointer to the vector, which may change between rows
+     */
+    template <typename T>
+    void Branch(const std::string &name, std::vector<T> *const *const ppAddress);
+
+    /**
+     *  @brief  Add a jagged column, bound to a fixed size array
+     *
+     *  @param  name the column name
+     *  @param  pAddress the address of the first element of the array
+     *  @param  nValues the number of elements in the array
+     */
+    template <typename T>
+    void Branch(const std::string &name, const T *const pAddress, const unsigned int nValues);
+
+    /**
+     *  @brief  Add a column, with no bound variable, to be filled using AppendValues
+     *
+     *  @param  name the column name
+     *  @param  columnType the column type
+     *  @param  isJagged whether the column is jagged
+     *
+     *  @return the index of the column
+     */
+    unsigned int AddColumn(const std::string &name, const ColumnType columnType, const bool isJagged);
+
+    /**
+     *  @brief  Append the values of the bound variables to each bound column, then end the row
+     */
+    void Fill();
+
+    /**
+     *  @brief  Append values to the current row of a column; a scalar column must receive exactly one value per row
+     *
+     *  @param  columnIndex the index of the column
+     *  @param  pValues the address of the values, of the column type
+     *  @param  nValues the number of values
+     */
+    void AppendValues(const unsigned int columnIndex, const void *const pValues, const std::size_t nValues);
+
+    /**
+     *  @brief  End the current row
+     */
+    void EndRow();
+
+    /**
+     *  @brief  Get the number of rows
+     *
+     *  @return the number of rows
+     */
+    uint64_t GetNRows() const;
+
+    /**
+     *  @brief  Write the file, replacing any existing file only once it is complete
+     */
+    void Close();
+
+private:
+    /**
+     *  @brief  Column class
+     */
+    class Column
+    {
+    public:
+        std::string             m_name;                 ///< The column name
+        ColumnType              m_columnType;           ///< The column type
+        bool                    m_isJagged;             ///< Whether the column is jagged
+        const void              *m_pAddress;            ///< The bound variable, array or pointer to vector, if any
+        unsigned int            m_nBoundValues;         ///< The number of elements in a bound array, or zero for a bound pointer to vector
+        std::FILE               *m_pSpillFile;          ///< The temporary file holding the values
+        std::FILE               *m_pOffsetsSpillFile;   ///< The temporary file holding the offsets table, for jagged columns
+        uint64_t                m_nValues;              ///< The number of values
+    };
+
+    typedef std::vector<Column> ColumnList;
+
+    /**
+     *  @brief  Add a column, bound to a variable, array or pointer to vector
+     *
+     *  @param  name the column name
+     *  @param  columnType the column type
+     *  @param  isJagged whether the column is jagged
+     *  @param  pAddress the bound address
+     *  @param  nBoundValues the number of elements in a bound array, or zero for a bound pointer to vector or scalar
+     */
+    void AddBoundColumn(const std::string &name, const ColumnType columnType, const bool isJagged, const void *const pAddress,
+        const unsigned int nBoundValues);
+
+    /**
+     *  @brief  Append the values of the vector bound to a jagged column
+     *
+     *  @param  columnIndex the index of the column
+     */
+    template <typename T>
+    void AppendVectorValues(const unsigned int columnIndex);
+
+    /**
+     *  @brief  Write a block of bytes, padding the file to the block alignment first
+     *
+     *  @param  pFile the file
+     *  @param  pBytes the address of the bytes
+     *  @param  nBytes the number of bytes
+     *  @param  position the position in the file, updated to the end of the block
+     *
+     *  @return the offset of the block
+     */
+    static uint64_t WriteBlock(std::FILE *const pFile, const void *const pBytes, const uint64_t nBytes, uint64_t &position);
+
+    /**
+     *  @brief  Copy the contents of a spill file to a block, padding the file to the block alignment first
+     *
+     *  @param  pFile the file
+     *  @param  pSpillFile the spill file
+     *  @param  nBytes the number of bytes in the spill file
+     *  @param  position the position in the file, updated to the end of the block
+     *
+     *  @return the offset of the block
+     */
+    static uint64_t CopyBlock(std::FILE *const pFile, std::FILE *const pSpillFile, const uint64_t nBytes, uint64_t &position);
+
+    /**
+     *  @brief  Write bytes, throwing if they cannot be written
+     *
+     *  @param  pFile the file
+     *  @param  pBytes the address of the bytes
+     *  @param  nBytes the number of bytes
+     *  @param  position the position in the file, updated to the end of the bytes
+     */
+    static void WriteBytes(std::FILE *const pFile, const void *const pBytes, const uint64_t nBytes, uint64_t &position);
+
+    /**
+     *  @brief  Create a spill file, unlinked as soon as it is created, so that it is cleaned up however the process ends
+     *
+     *  @param  columnName the name of the column, for the error message
+     *
+     *  @return the spill file
+     */
+    static std::FILE *CreateSpillFile(const std::string &columnName);
+
+    /**
+     *  @brief  Append an offset to the offsets spill file of a jagged column
+     *
+     *  @param  column the column
+     *  @param  offset the offset
+     */
+    static void AppendOffset(const Column &column, const uint64_t offset);
+
+    /**
+     *  @brief  Close and discard the spill files
+     */
+    void CloseSpillFiles();
+
+    std::string                 m_fileName;             ///< The name of the file to write
+    ColumnList                  m_columnList;           ///< The columns, in the order in which they were added
+    uint64_t                    m_nRows;                ///< The number of complete rows
+    bool                        m_isClosed;             ///< Whether the file has been written
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoColumnWriter::Branch(const std::string &name, const T *const pAddress)
+{
+    this->AddBoundColumn(name, ColumnTypeTraits<T>::COLUMN_TYPE, false, pAddress, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoColumnWriter::Branch(const std::string &name, std::vector<T> *const *const ppAddress)
+{
+    this->AddBoundColumn(name, ColumnTypeTraits<T>::COLUMN_TYPE, true, ppAddress, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoColumnWriter::Branch(const std::string &name, const T *const pAddress, const unsigned int nValues)
+{
+    if (0 == nValues)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+
+    this->AddBoundColumn(name, ColumnTypeTraits<T>::COLUMN_TYPE, true, pAddress, nValues);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t PfoColumnWriter::GetNRows() const
+{
+    return m_nRows;
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_PFO_COLUMN_WRITER_H
@@ -0,0 +1,159 @@
+/**
+ *  @file   LArReco/include/PfoEntryIndex.h
+ *
+ *  @brief  Header file for the pfo entry index class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_PFO_ENTRY_INDEX_H
+#define LAR_RECO_PFO_ENTRY_INDEX_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include "TTree.h"
+
+class TFile;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  PfoEntryIndex class, a table of the pfo tree entry holding each (eventId, pfoId), sorted for binary search
+ *
+ *  Entries are added as the pfo tree is filled and sorted an event at a time, so the table needs no pass over the tree. It may be bound
+ *  to an index tree, named after the pfo tree with the suffix Index, which receives each event's sorted records as the event ends and
+ *  checkpoints itself every AUTO_SAVE_RECORDS records, so that even the file of a crashed job holds a usable index. A bound index then
+ *  releases the records, so holds only those of the current event; lookup is for indices read back from a file.
+ */
+class PfoEntryIndex
+{
+public:
+    /**
+     *  @brief  Record class, the entry of a single pfo
+     */
+    class Record
+    {
+    public:
+        unsigned int            m_eventId;              ///< The event id
+        unsigned int            m_pfoId;                ///< The pfo id
+        Long64_t                m_entry;                ///< The pfo tree entry
+    };
+
+    typedef std::vector<Record> RecordVector;
+
+    /**
+     *  @brief  Default constructor
+     */
+    PfoEntryIndex();
+
+    /**
+     *  @brief  Deleted copy constructor and assignment, as an index tree may hold the address of the index
+     */
+    PfoEntryIndex(const PfoEntryIndex &) = delete;
+    PfoEntryIndex &operator=(const PfoEntryIndex &) = delete;
+
+    /**
+     *  @brief  Create an index tree in the current root directory, bound to this index, which then fills it as each event ends
+     *
+     *  @param  pfoTreeName the name of the pfo tree
+     *
+     *  @return the address of the index tree, owned by the directory
+     */
+    TTree *CreateTree(const std::string &pfoTreeName);
+
+    /**
+     *  @brief  Add the entry of a pfo in the current event
+     *
+     *  @param  eventId the event id
+     *  @param  pfoId the pfo id
+     *  @param  entry the pfo tree entry
+     */
+    void AddEntry(const unsigned int eventId, const unsigned int pfoId, const Long64_t entry);
+
+    /**
+     *  @brief  Sort the entries added since the last call into the table or, if bound to an index tree, write them to the tree and release them
+     */
+    void EndEvent();
+
+    /**
+     *  @brief  Add the records of another index, as with AddEntry, e.g. when concatenating files; call EndEvent to sort and write them
+     *
+     *  @param  other the other index
+     *  @param  entryOffset the offset to add to each entry of the other index
+     */
+    void Append(const PfoEntryIndex &other, const Long64_t entryOffset);
+
+    /**
+     *  @brief  Find the pfo tree entry of a pfo, by binary search
+     *
+     *  @param  eventId the event id
+     *  @param  pfoId the pfo id
+     *
+     *  @return the entry, or -1 if the pfo is not indexed
+     */
+    Long64_t FindEntry(const unsigned int eventId, const unsigned int pfoId) const;
+
+    /**
+     *  @brief  Get the records, sorted up to any added since the last call to EndEvent, and empty after EndEvent if bound to an index tree
+     *
+     *  @return the records
+     */
+    const RecordVector &GetRecords() const;
+
+    /**
+     *  @brief  Read the index of a pfo tree from a file
+     *
+     *  @param  pTFile the address of the file
+     *  @param  pfoTreeName the name of the pfo tree
+     *  @param  pfoEntryIndex to receive the index
+     *
+     *  @return whether the file holds an index for the tree
+     */
+    static bool Read(TFile *const pTFile, const std::string &pfoTreeName, PfoEntryIndex &pfoEntryIndex);
+
+    /**
+     *  @brief  Get the name of the index tree of a pfo tree
+     *
+     *  @param  pfoTreeName the name of the pfo tree
+     *
+     *  @return the name of the index tree
+     */
+    static std::string GetIndexTreeName(const std::string &pfoTreeName);
+
+    /**
+     *  @brief  Whether a tree is an index tree, rather than a tree of pfos or events
+     *
+     *  @param  pTree the address of the tree
+     *
+     *  @return boolean
+     */
+    static bool IsIndexTree(const TTree *const pTree);
+
+    static const Long64_t AUTO_SAVE_RECORDS;            ///< The number of records between checkpoints of the index tree
+
+private:
+    /**
+     *  @brief  Merge the sorted records from a position onwards into the sorted records before it
+     *
+     *  @param  begin the position of the first record to merge
+     */
+    void MergeFrom(const std::size_t begin);
+
+    RecordVector                m_records;              ///< The records, sorted up to those of the current event, or only those if bound to a tree
+    std::size_t                 m_nSortedRecords;       ///< The number of sorted records
+    TTree                       *m_pIndexTree;          ///< The index tree, if any
+    Record                      m_treeRecord;           ///< The record bound to the index tree
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const PfoEntryIndex::RecordVector &PfoEntryIndex::GetRecords() const
+{
+    return m_records;
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_PFO_ENTRY_INDEX_H
@@ -0,0 +1,364 @@
+/**
+ *  @file   LArReco/include/PfoEventTreeWriter.h
+ *
+ *  @brief  Header file for the pfo event tree writer class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_PFO_EVENT_TREE_WRITER_H
+#define LAR_RECO_PFO_EVENT_TREE_WRITER_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include "TTree.h"
+
+#include <algorithm>
+#include <memory>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  PfoEventTreeWriter class, writing the pfos of each event to a single root tree entry
+ *
+ *  Like a root tree, per-pfo variables are bound by address and read on each call to AddPfo; Fill then writes one entry for the event.
+ *  Each per-pfo scalar becomes a vector with one value per pfo, and each fixed size array a vector with a fixed number of values per
+ *  pfo. Each per-pfo vector is flattened across the event, with an offsets vector of nPfos + 1 entries, such that the values of pfo i
+ *  are [offsets[i], offsets[i + 1]). Vectors of the same length for every pfo, e.g. the coordinates and energies of the hits in a view,
+ *  share a single offsets vector. Event-level variables are written once per entry, and the nPfos branch holds the number of pfos.
+ */
+class PfoEventTreeWriter
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pTree the address of the tree, which remains owned by the caller
+     */
+    PfoEventTreeWriter(TTree *const pTree);
+
+    /**
+     *  @brief  Deleted copy constructor and assignment, as the writer owns the buffers bound to the tree
+     */
+    PfoEventTreeWriter(const PfoEventTreeWriter &) = delete;
+    PfoEventTreeWriter &operator=(const PfoEventTreeWriter &) = delete;
+
+    /**
+     *  @brief  Add an event-level branch, bound to a variable
+     *
+     *  @param  name the branch name
+     *  @param  pAddress the address of the variable
+     */
+    template <typename T>
+    void EventBranch(const std::string &name, T *const pAddress);
+
+    /**
+     *  @brief  Add a per-pfo scalar branch, bound to a variable
+     *
+     *  @param  name the branch name
+     *  @param  pAddress the address of the variable
+     */
+    template <typename T>
+    void Branch(const std::string &name, const T *const pAddress);
+
+    /**
+     *  @brief  Add a per-pfo vector branch, flattened across the event, bound to a pointer to a vector
+     *
+     *  @param  name the branch name
+     *  @param  ppAddress the address of the pointer to the vector, which may change between pfos
+     *  @param  offsetsName the name of the offsets branch, which may be shared with other vectors of the same length for every pfo
+     */
+    template <typename T>
+    void Branch(const std::string &name, std::vector<T> *const *const ppAddress, const std::string &offsetsName);
+
+    /**
+     *  @brief  Add a per-pfo fixed size array branch, flattened across the event, bound to an array
+     *
+     *  @param  name the branch name
+     *  @param  pAddress the address of the first element of the array
+     *  @param  nValues the number of elements in the array
+     */
+    template <typename T>
+    void Branch(const std::string &name, const T *const pAddress, const unsigned int nValues);
+
+    /**
+     *  @brief  Append the values of the bound per-pfo variables for the current pfo
+     */
+    void AddPfo();
+
+    /**
+     *  @brief  Fill the tree entry for the event, with the pfos added since the last call, then clear them
+     */
+    void Fill();
+
+    /**
+     *  @brief  Get the number of pfos added for the current event
+     *
+     *  @return the number of pfos
+     */
+    unsigned int GetNPfos() const;
+
+    /**
+     *  @brief  Whether a tree was written with the event layout, i.e. one entry per event, rather than one entry per pfo
+     *
+     *  @param  pTree the address of the tree
+     *
+     *  @return boolean
+     */
+    static bool IsEventTree(TTree *const pTree);
+
+private:
+    /**
+     *  @brief  Variable class, a per-pfo variable and the per-event buffer to which its values are appended
+     */
+    class Variable
+    {
+    public:
+        /**
+         *  @brief  Destructor
+         */
+        virtual ~Variable() = default;
+
+        /**
+         *  @brief  Append the value or values of the bound variable for the current pfo
+         */
+        virtual void Append() = 0;
+
+        /**
+         *  @brief  Get the number of values in the buffer
+         *
+         *  @return the number of values
+         */
+        virtual std::size_t GetNValues() const = 0;
+
+        /**
+         *  @brief  Clear the buffer
+         */
+        virtual void Clear() = 0;
+    };
+
+    /**
+     *  @brief  ArrayVariable class, a per-pfo scalar or fixed size array
+     */
+    template <typename T>
+    class ArrayVariable : public Variable
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  pAddress the address of the first element of the array
+         *  @param  nValues the number of elements in the array
+         */
+        ArrayVariable(const T *const pAddress, const unsigned int nValues);
+
+        void Append();
+        std::size_t GetNValues() const;
+        void Clear();
+
+        const T                 *m_pAddress;            ///< The address of the first element of the array
+        unsigned int            m_nValues;              ///< The number of elements in the array
+        std::vector<T>          m_values;               ///< The values for the event
+    };
+
+    /**
+     *  @brief  VectorVariable class, a per-pfo vector
+     */
+    template <typename T>
+    class VectorVariable : public Variable
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  ppAddress the address of the pointer to the vector
+         */
+        VectorVariable(std::vector<T> *const *const ppAddress);
+
+        void Append();
+        std::size_t GetNValues() const;
+        void Clear();
+
+        std::vector<T> *const   *m_ppAddress;           ///< The address of the pointer to the vector
+        std::vector<T>          m_values;               ///< The flattened values for the event
+    };
+
+    /**
+     *  @brief  OffsetsGroup class, the per-pfo vectors sharing an offsets branch
+     */
+    class OffsetsGroup
+    {
+    public:
+        std::vector<Variable*>      m_variables;        ///< The vectors sharing the offsets
+        std::vector<unsigned int>   m_offsets;          ///< The offsets for the event
+    };
+
+    typedef std::vector<std::unique_ptr<Variable>> VariableList;
+    typedef std::vector<std::unique_ptr<OffsetsGroup>> OffsetsGroupList;
+
+    /**
+     *  @brief  Take ownership of a variable and bind its buffer to a new branch
+     *
+     *  @param  name the branch name
+     *  @param  pVariable the address of the variable
+     *  @param  pValues the address of the buffer of the variable
+     */
+    template <typename T>
+    void AddVariable(const std::string &name, Variable *const pVariable, std::vector<T> *const pValues);
+
+    TTree                       *m_pTree;               ///< The tree
+    unsigned int                m_nPfos;                ///< The number of pfos added for the current event
+    VariableList                m_variableList;         ///< The per-pfo variables, in the order in which they were added
+    OffsetsGroupList            m_offsetsGroupList;     ///< The per-pfo vectors, grouped by offsets branch
+    pandora::StringVector       m_offsetsNames;         ///< The offsets branch name of each group
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoEventTreeWriter::EventBranch(const std::string &name, T *const pAddress)
+{
+    m_pTree->Branch(name.c_str(), pAddress);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoEventTreeWriter::Branch(const std::string &name, const T *const pAddress)
+{
+    this->Branch(name, pAddress, 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoEventTreeWriter::Branch(const std::string &name, std::vector<T> *const *const ppAddress, const std::string &offsetsName)
+{
+    VectorVariable<T> *const pVariable(new VectorVariable<T>(ppAddress));
+    this->AddVariable(name, pVariable, &pVariable->m_values);
+
+    const pandora::StringVector::const_iterator iter(std::find(m_offsetsNames.begin(), m_offsetsNames.end(), offsetsName));
+
+    if (m_offsetsNames.end() != iter)
+    {
+        m_offsetsGroupList.at(iter - m_offsetsNames.begin())->m_variables.push_back(pVariable);
+        return;
+    }
+
+    m_offsetsGroupList.emplace_back(new OffsetsGroup);
+    m_offsetsNames.push_back(offsetsName);
+
+    OffsetsGroup *const pOffsetsGroup(m_offsetsGroupList.back().get());
+    pOffsetsGroup->m_variables.push_back(pVariable);
+    pOffsetsGroup->m_offsets.push_back(0);
+    m_pTree->Branch(offsetsName.c_str(), &pOffsetsGroup->m_offsets);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoEventTreeWriter::Branch(const std::string &name, const T *const pAddress, const unsigned int nValues)
+{
+    if (0 == nValues)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+
+    ArrayVariable<T> *const pVariable(new ArrayVariable<T>(pAddress, nValues));
+    this->AddVariable(name, pVariable, &pVariable->m_values);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int PfoEventTreeWriter::GetNPfos() const
+{
+    return m_nPfos;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoEventTreeWriter::AddVariable(const std::string &name, Variable *const pVariable, std::vector<T> *const pValues)
+{
+    // Variables are only added once their buffers are at their final address, as root holds the address of each
+    if (m_nPfos > 0)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_ALLOWED);
+
+    m_variableList.emplace_back(pVariable);
+    m_pTree->Branch(name.c_str(), pValues);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline PfoEventTreeWriter::ArrayVariable<T>::ArrayVariable(const T *const pAddress, const unsigned int nValues) :
+    m_pAddress(pAddress),
+    m_nValues(nValues)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoEventTreeWriter::ArrayVariable<T>::Append()
+{
+    m_values.insert(m_values.end(), m_pAddress, m_pAddress + m_nValues);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline std::size_t PfoEventTreeWriter::ArrayVariable<T>::GetNValues() const
+{
+    return m_values.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoEventTreeWriter::ArrayVariable<T>::Clear()
+{
+    m_values.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline PfoEventTreeWriter::VectorVariable<T>::VectorVariable(std::vector<T> *const *const ppAddress) :
+    m_ppAddress(ppAddress)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoEventTreeWriter::VectorVariable<T>::Append()
+{
+    const std::vector<T> *const pVector(*m_ppAddress);
+
+    if (pVector)
+        m_values.insert(m_values.end(), pVector->begin(), pVector->end());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline std::size_t PfoEventTreeWriter::VectorVariable<T>::GetNValues() const
+{
+    return m_values.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void PfoEventTreeWriter::VectorVariable<T>::Clear()
+{
+    m_values.clear();
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_PFO_EVENT_TREE_WRITER_H
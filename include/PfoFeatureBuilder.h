@@ -0,0 +1,154 @@
+/**
+ *  @file   LArReco/include/PfoFeatureBuilder.h
+ *
+ *  @brief  Header file for the pfo feature builder class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_PFO_FEATURE_BUILDER_H
+#define LAR_RECO_PFO_FEATURE_BUILDER_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+namespace pandora { class TiXmlHandle; }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  PfoFeatures class, the summary features of the hits of a pfo in the 3D view, or in a two dimensional view with drift and wire
+ *          coordinates in place of x and z. Two dimensional features leave the third eigenvalue and axis component at zero
+ */
+class PfoFeatures
+{
+public:
+    static const unsigned int MAX_PROFILE_BINS = 20;    ///< The maximum number of energy profile bins
+
+    float   m_eigenvalues[3];                       ///< The principal component eigenvalues, largest first
+    float   m_principalAxis[3];                     ///< The principal axis, pointing away from the vertex, if any, else towards larger z
+    float   m_length;                               ///< The extent of the hits along the principal axis
+    float   m_hitDensity;                           ///< The number of hits per unit length along the principal axis
+    float   m_energyProfile[MAX_PROFILE_BINS];      ///< The fraction of the hit energy in each equal length bin along the principal axis
+    float   m_vertexDistanceMin;                    ///< The smallest distance from the vertex to a hit, or -1 if there is no vertex
+    float   m_vertexDistanceMean;                   ///< The mean distance from the vertex to the hits, or -1 if there is no vertex
+    float   m_vertexDistanceRms;                    ///< The standard deviation of the distances from the vertex to the hits, or -1 if there is no vertex
+    float   m_vertexDistanceMax;                    ///< The largest distance from the vertex to a hit, or -1 if there is no vertex
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  PfoFeatureBuilder class, computing the summary features of the hits of a pfo, in each view, from the contiguous coordinate arrays
+ *          of the hits. Settings are read from a PfoFeatures block, features being disabled if it is absent
+ *
+ *  <PfoFeatures>
+ *      <NProfileBins>5</NProfileBins>      the number of energy profile bins along the principal axis, 1 to 20
+ *  </PfoFeatures>
+ */
+class PfoFeatureBuilder
+{
+public:
+    /**
+     *  @brief  Default constructor
+     */
+    PfoFeatureBuilder();
+
+    /**
+     *  @brief  Read the settings from the PfoFeatures block, if any, below an xml element
+     *
+     *  @param  xmlHandle the handle of the element containing the PfoFeatures block
+     *
+     *  @return STATUS_CODE_SUCCESS, or STATUS_CODE_INVALID_PARAMETER if a setting is out of range
+     */
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle &xmlHandle);
+
+    /**
+     *  @brief  Whether features are enabled, by a PfoFeatures block
+     *
+     *  @return boolean
+     */
+    bool IsEnabled() const;
+
+    /**
+     *  @brief  Get the number of energy profile bins
+     *
+     *  @return the number of bins
+     */
+    unsigned int GetNProfileBins() const;
+
+    /**
+     *  @brief  Compute the features of a set of hits in the 3D view
+     *
+     *  @param  pXCoords the x coordinates
+     *  @param  pYCoords the y coordinates
+     *  @param  pZCoords the z coordinates
+     *  @param  pEnergies the energies
+     *  @param  nHits the number of hits
+     *  @param  pVertex the address of the x, y and z coordinates of the vertex, or nullptr if there is none
+     *  @param  features to receive the features
+     */
+    void ComputeThreeD(const float *const pXCoords, const float *const pYCoords, const float *const pZCoords, const float *const pEnergies,
+        const unsigned int nHits, const float *const pVertex, PfoFeatures &features);
+
+    /**
+     *  @brief  Compute the features of a set of hits in a two dimensional view
+     *
+     *  @param  pDriftCoords the drift coordinates
+     *  @param  pWireCoords the wire coordinates
+     *  @param  pEnergies the energies
+     *  @param  nHits the number of hits
+     *  @param  pVertex the address of the drift and wire coordinates of the projected vertex, or nullptr if there is none
+     *  @param  features to receive the features
+     */
+    void ComputeTwoD(const float *const pDriftCoords, const float *const pWireCoords, const float *const pEnergies, const unsigned int nHits,
+        const float *const pVertex, PfoFeatures &features);
+
+private:
+    /**
+     *  @brief  Compute the features of a set of hits in two or three dimensions
+     *
+     *  @param  pCoords the addresses of the coordinate arrays, one per dimension
+     *  @param  nDimensions the number of dimensions, 2 or 3
+     *  @param  pEnergies the energies
+     *  @param  nHits the number of hits
+     *  @param  pVertex the address of the vertex coordinates, one per dimension, or nullptr if there is none
+     *  @param  features to receive the features
+     */
+    void Compute(const float *const *const pCoords, const unsigned int nDimensions, const float *const pEnergies, const unsigned int nHits,
+        const float *const pVertex, PfoFeatures &features);
+
+    /**
+     *  @brief  Diagonalise a symmetric matrix by Jacobi rotations
+     *
+     *  @param  matrix the matrix, of which the upper nDimensions square is used, destroyed by the diagonalisation
+     *  @param  nDimensions the number of dimensions, 2 or 3
+     *  @param  eigenvalues to receive the eigenvalues, largest first
+     *  @param  eigenvectors to receive the eigenvectors, as columns in the order of the eigenvalues
+     */
+    static void Diagonalise(double matrix[3][3], const unsigned int nDimensions, double eigenvalues[3], double eigenvectors[3][3]);
+
+    bool                    m_isEnabled;        ///< Whether features are enabled
+    unsigned int            m_nProfileBins;     ///< The number of energy profile bins
+    pandora::FloatVector    m_projections;      ///< The position of each hit along the principal axis, reused between pfos
+    pandora::FloatVector    m_distances;        ///< The distance of each hit from the vertex, reused between pfos
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool PfoFeatureBuilder::IsEnabled() const
+{
+    return m_isEnabled;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int PfoFeatureBuilder::GetNProfileBins() const
+{
+    return m_nProfileBins;
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_PFO_FEATURE_BUILDER_H
@@ -0,0 +1,216 @@
+/**
+ *  @file   LArReco/include/PfoHitCache.h
+ *
+ *  @brief  Header file for the pfo hit cache class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_PFO_HIT_CACHE_H
+#define LAR_RECO_PFO_HIT_CACHE_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include <array>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  PfoHitCache class, holding the calo hits of each pfo in an event, gathered in a single walk over its clusters
+ *
+ *  Hit properties are stored as structure-of-arrays buffers shared by all pfos. The hits of each pfo are contiguous and ordered by view
+ *  (U, V, W, then 3D), so that the hits of any one view, or of all three 2D views, form a single range. Within a view, the hits of each
+ *  cluster in the ordered calo hit lists come first, then the isolated hits, as returned by the lar_content pfo helper.
+ */
+class PfoHitCache
+{
+public:
+    /**
+     *  @brief  HitRange class, a range of indices into the hit buffers
+     */
+    class HitRange
+    {
+    public:
+        /**
+         *  @brief  Get the number of hits in the range
+         *
+         *  @return the number of hits
+         */
+        unsigned int GetSize() const;
+
+        unsigned int    m_begin;                    ///< The index of the first hit
+        unsigned int    m_end;                      ///< One past the index of the last hit
+    };
+
+    /**
+     *  @brief  Clear the cache, then gather the hits of each pfo in a list
+     *
+     *  @param  pfoList the list of pfos
+     */
+    void Fill(const pandora::PfoList &pfoList);
+
+    /**
+     *  @brief  Get the range of the hits of a pfo in a given view
+     *
+     *  @param  pPfo the address of the pfo
+     *  @param  hitType the view, TPC_VIEW_U, TPC_VIEW_V, TPC_VIEW_W or TPC_3D
+     *
+     *  @return the range of hits
+     */
+    HitRange GetHitRange(const pandora::ParticleFlowObject *const pPfo, const pandora::HitType hitType) const;
+
+    /**
+     *  @brief  Get the range of the hits of a pfo in all three 2D views
+     *
+     *  @param  pPfo the address of the pfo
+     *
+     *  @return the range of hits
+     */
+    HitRange GetTwoDHitRange(const pandora::ParticleFlowObject *const pPfo) const;
+
+    /**
+     *  @brief  Get the calo hit buffer
+     *
+     *  @return the addresses of the calo hits
+     */
+    const pandora::CaloHitVector &GetCaloHits() const;
+
+    /**
+     *  @brief  Get the hit x coordinate (drift coordinate) buffer
+     *
+     *  @return the x coordinates
+     */
+    const pandora::FloatVector &GetXCoords() const;
+
+    /**
+     *  @brief  Get the hit y coordinate buffer
+     *
+     *  @return the y coordinates
+     */
+    const pandora::FloatVector &GetYCoords() const;
+
+    /**
+     *  @brief  Get the hit z coordinate buffer
+     *
+     *  @return the z coordinates
+     */
+    const pandora::FloatVector &GetZCoords() const;
+
+    /**
+     *  @brief  Get the hit x coordinate error buffer
+     *
+     *  @return the x coordinate errors
+     */
+    const pandora::FloatVector &GetXCoordErrors() const;
+
+    /**
+     *  @brief  Get the hit input energy buffer
+     *
+     *  @return the energies
+     */
+    const pandora::FloatVector &GetEnergies() const;
+
+private:
+    static const unsigned int N_VIEWS = 4;          ///< The number of views, U, V, W and 3D
+
+    typedef std::array<unsigned int, N_VIEWS + 1> ViewBoundaries;
+    typedef std::unordered_map<const pandora::ParticleFlowObject*, ViewBoundaries> PfoToViewBoundariesMap;
+    typedef std::array<std::vector<const pandora::Cluster*>, N_VIEWS> ViewClusterLists;
+
+    /**
+     *  @brief  Gather the hits of a single pfo
+     *
+     *  @param  pPfo the address of the pfo
+     */
+    void AddPfo(const pandora::ParticleFlowObject *const pPfo);
+
+    /**
+     *  @brief  Append a calo hit to the buffers
+     *
+     *  @param  pCaloHit the address of the calo hit
+     */
+    void AddCaloHit(const pandora::CaloHit *const pCaloHit);
+
+    /**
+     *  @brief  Get the boundaries of the views of a pfo within the hit buffers
+     *
+     *  @param  pPfo the address of the pfo
+     *
+     *  @return the view boundaries
+     */
+    const ViewBoundaries &GetViewBoundaries(const pandora::ParticleFlowObject *const pPfo) const;
+
+    /**
+     *  @brief  Get the index of a view
+     *
+     *  @param  hitType the view
+     *
+     *  @return the index, or N_VIEWS if the hit type is not a tpc view
+     */
+    static unsigned int GetViewIndex(const pandora::HitType hitType);
+
+    PfoToViewBoundariesMap      m_pfoToViewBoundariesMap;   ///< The boundaries of the views of each pfo within the hit buffers
+    ViewClusterLists            m_viewClusterLists;         ///< Working lists of the clusters of the current pfo in each view
+    pandora::CaloHitVector      m_caloHits;                 ///< The calo hit addresses
+    pandora::FloatVector        m_xCoords;                  ///< The hit x coordinates (drift coordinates)
+    pandora::FloatVector        m_yCoords;                  ///< The hit y coordinates
+    pandora::FloatVector        m_zCoords;                  ///< The hit z coordinates (for U/V/W views, the wire plane coordinates)
+    pandora::FloatVector        m_xCoordErrors;             ///< The hit x coordinate errors
+    pandora::FloatVector        m_energies;                 ///< The hit input energies
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int PfoHitCache::HitRange::GetSize() const
+{
+    return (m_end - m_begin);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const pandora::CaloHitVector &PfoHitCache::GetCaloHits() const
+{
+    return m_caloHits;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const pandora::FloatVector &PfoHitCache::GetXCoords() const
+{
+    return m_xCoords;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const pandora::FloatVector &PfoHitCache::GetYCoords() const
+{
+    return m_yCoords;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const pandora::FloatVector &PfoHitCache::GetZCoords() const
+{
+    return m_zCoords;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const pandora::FloatVector &PfoHitCache::GetXCoordErrors() const
+{
+    return m_xCoordErrors;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const pandora::FloatVector &PfoHitCache::GetEnergies() const
+{
+    return m_energies;
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_PFO_HIT_CACHE_H
@@ -0,0 +1,106 @@
+/**
+ *  @file   LArReco/include/PfoTaskPool.h
+ *
+ *  @brief  Header file for the pfo task pool class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_PFO_TASK_POOL_H
+#define LAR_RECO_PFO_TASK_POOL_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  PfoTaskPool class, running a batch of independent tasks across a fixed set of threads, the calling thread among them
+ *
+ *  The threads are started once and wait between batches, so a batch costs no thread creation. Tasks are claimed in index order from a
+ *  shared counter, and Run returns once every task of the batch has completed, rethrowing the first exception thrown by any task.
+ */
+class PfoTaskPool
+{
+public:
+    typedef std::function<void(unsigned int iTask, unsigned int iWorker)> TaskFunction;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  nWorkers the number of workers, including the calling thread, so nWorkers - 1 threads are started
+     */
+    PfoTaskPool(const unsigned int nWorkers);
+
+    /**
+     *  @brief  Destructor, stopping the threads
+     */
+    ~PfoTaskPool();
+
+    /**
+     *  @brief  Deleted copy constructor and assignment, as the threads hold the address of the pool
+     */
+    PfoTaskPool(const PfoTaskPool &) = delete;
+    PfoTaskPool &operator=(const PfoTaskPool &) = delete;
+
+    /**
+     *  @brief  Get the number of workers, including the calling thread
+     *
+     *  @return the number of workers
+     */
+    unsigned int GetNWorkers() const;
+
+    /**
+     *  @brief  Run a batch of tasks, blocking until all have completed
+     *
+     *  @param  nTasks the number of tasks
+     *  @param  taskFunction the function running a task, given the task index and the index of the worker running it, below GetNWorkers
+     */
+    void Run(const unsigned int nTasks, const TaskFunction &taskFunction);
+
+private:
+    /**
+     *  @brief  Claim and run tasks of the current batch until none remain
+     *
+     *  @param  iWorker the index of the worker
+     */
+    void RunTasks(const unsigned int iWorker);
+
+    /**
+     *  @brief  The loop of a pool thread
+     *
+     *  @param  iWorker the index of the worker
+     */
+    void ThreadLoop(const unsigned int iWorker);
+
+    unsigned int                m_nWorkers;         ///< The number of workers, including the calling thread
+    const TaskFunction          *m_pTaskFunction;   ///< The task function of the current batch
+    unsigned int                m_nTasks;           ///< The number of tasks in the current batch
+    unsigned int                m_nextTask;         ///< The next task to claim
+    unsigned int                m_nActiveWorkers;   ///< The number of pool threads still working on the current batch
+    unsigned long long          m_batch;            ///< The number of batches started, for the threads to detect a new batch
+    bool                        m_isStopping;       ///< Whether the threads should stop
+    std::exception_ptr          m_exception;        ///< The first exception thrown by a task of the current batch
+    std::mutex                  m_mutex;            ///< The mutex guarding the batch state
+    std::condition_variable     m_batchCondition;   ///< Notified when a batch starts or the pool is stopping
+    std::condition_variable     m_doneCondition;    ///< Notified when a pool thread finishes its part of a batch
+    std::vector<std::thread>    m_threads;          ///< The pool threads
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int PfoTaskPool::GetNWorkers() const
+{
+    return m_nWorkers;
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_PFO_TASK_POOL_H
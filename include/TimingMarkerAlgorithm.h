@@ -0,0 +1,75 @@
+/**
+ *  @file   LArReco/include/TimingMarkerAlgorithm.h
+ *
+ *  @brief  Header file for the timing marker algorithm class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_TIMING_MARKER_ALGORITHM_H
+#define LAR_RECO_TIMING_MARKER_ALGORITHM_H 1
+
+#include "Pandora/Algorithm.h"
+
+namespace lar_reco
+{
+
+class AlgorithmTimer;
+
+/**
+ *  @brief  TimingMarkerAlgorithm class, recording a timing checkpoint each time it runs
+ */
+class TimingMarkerAlgorithm : public pandora::Algorithm
+{
+public:
+    /**
+     *  @brief  Factory class for instantiating algorithm
+     */
+    class Factory : public pandora::AlgorithmFactory
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  pAlgorithmTimer the address of the algorithm timer to receive the checkpoints
+         */
+        Factory(AlgorithmTimer *const pAlgorithmTimer);
+
+        pandora::Algorithm *CreateAlgorithm() const;
+
+    private:
+        AlgorithmTimer *const   m_pAlgorithmTimer;          ///< The algorithm timer
+    };
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pAlgorithmTimer the address of the algorithm timer to receive the checkpoints
+     */
+    TimingMarkerAlgorithm(AlgorithmTimer *const pAlgorithmTimer);
+
+private:
+    pandora::StatusCode Run();
+    pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
+
+    AlgorithmTimer *const   m_pAlgorithmTimer;              ///< The algorithm timer
+    std::string             m_instanceLabel;                ///< The label identifying the settings of this pandora instance
+    std::string             m_timedAlgorithm;               ///< The name of the preceding algorithm, or empty at the start of the algorithm list
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline TimingMarkerAlgorithm::Factory::Factory(AlgorithmTimer *const pAlgorithmTimer) :
+    m_pAlgorithmTimer(pAlgorithmTimer)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline pandora::Algorithm *TimingMarkerAlgorithm::Factory::CreateAlgorithm() const
+{
+    return new TimingMarkerAlgorithm(m_pAlgorithmTimer);
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_TIMING_MARKER_ALGORITHM_H
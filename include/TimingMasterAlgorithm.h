@@ -0,0 +1,72 @@
+/**
+ *  @file   LArReco/include/TimingMasterAlgorithm.h
+ *
+ *  @brief  Header file for the timing master algorithm class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_TIMING_MASTER_ALGORITHM_H
+#define LAR_RECO_TIMING_MASTER_ALGORITHM_H 1
+
+#include "larpandoracontent/LArControlFlow/MasterAlgorithm.h"
+
+namespace lar_reco
+{
+
+class AlgorithmTimer;
+
+/**
+ *  @brief  TimingMasterAlgorithm class, a master algorithm that allows timing marker algorithms to run in its worker instances
+ */
+class TimingMasterAlgorithm : public lar_content::MasterAlgorithm
+{
+public:
+    /**
+     *  @brief  Factory class for instantiating algorithm
+     */
+    class Factory : public pandora::AlgorithmFactory
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  pAlgorithmTimer the address of the algorithm timer to receive the worker instance checkpoints
+         */
+        Factory(AlgorithmTimer *const pAlgorithmTimer);
+
+        pandora::Algorithm *CreateAlgorithm() const;
+
+    private:
+        AlgorithmTimer *const   m_pAlgorithmTimer;          ///< The algorithm timer
+    };
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pAlgorithmTimer the address of the algorithm timer to receive the worker instance checkpoints
+     */
+    TimingMasterAlgorithm(AlgorithmTimer *const pAlgorithmTimer);
+
+private:
+    pandora::StatusCode RegisterCustomContent(const pandora::Pandora *const pPandora) const;
+
+    AlgorithmTimer *const   m_pAlgorithmTimer;              ///< The algorithm timer
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline TimingMasterAlgorithm::Factory::Factory(AlgorithmTimer *const pAlgorithmTimer) :
+    m_pAlgorithmTimer(pAlgorithmTimer)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline pandora::Algorithm *TimingMasterAlgorithm::Factory::CreateAlgorithm() const
+{
+    return new TimingMasterAlgorithm(m_pAlgorithmTimer);
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_TIMING_MASTER_ALGORITHM_H
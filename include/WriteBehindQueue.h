@@ -0,0 +1,356 @@
+/**
+ *  @file   LArReco/include/WriteBehindQueue.h
+ *
+ *  @brief  Header file for the write-behind queue class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_RECO_WRITE_BEHIND_QUEUE_H
+#define LAR_RECO_WRITE_BEHIND_QUEUE_H 1
+
+#include "Pandora/PandoraInternal.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  WriteBehindQueue class, moving output records from the thread that produces them to a dedicated output thread
+ *
+ *  Each source variable is bound to a shadow copy, which the outputs are bound to in its place. PushRecord copies the source variables
+ *  into the next slot of a ring of records, blocking while the ring is full, and the output thread copies each record into the shadow
+ *  copies and calls the fill function. Markers pushed by PushEndEvent call the end event function in the same way, in order, but carry
+ *  only the variables bound with BindEvent, which are all that event-level outputs read.
+ */
+class WriteBehindQueue
+{
+public:
+    typedef std::function<void()> OutputFunction;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  nSlots the number of records the ring can hold before PushRecord blocks
+     */
+    WriteBehindQueue(const unsigned int nSlots);
+
+    /**
+     *  @brief  Destructor, draining the queue if the output thread is running
+     */
+    ~WriteBehindQueue();
+
+    /**
+     *  @brief  Deleted copy constructor and assignment, as the output thread holds the address of the queue
+     */
+    WriteBehindQueue(const WriteBehindQueue &) = delete;
+    WriteBehindQueue &operator=(const WriteBehindQueue &) = delete;
+
+    /**
+     *  @brief  Bind a variable to a shadow copy
+     *
+     *  @param  pSource the address of the variable
+     *
+     *  @return the address of the shadow copy
+     */
+    template <typename T>
+    T *Bind(const T *const pSource);
+
+    /**
+     *  @brief  Bind an event-level variable to a shadow copy, which end of event markers also carry
+     *
+     *  @param  pSource the address of the variable
+     *
+     *  @return the address of the shadow copy
+     */
+    template <typename T>
+    T *BindEvent(const T *const pSource);
+
+    /**
+     *  @brief  Bind a pointer to a vector to a shadow copy
+     *
+     *  @param  ppSource the address of the pointer to the vector, which may change between records
+     *
+     *  @return the address of the pointer to the shadow copy
+     */
+    template <typename T>
+    std::vector<T> **Bind(std::vector<T> *const *const ppSource);
+
+    /**
+     *  @brief  Bind a fixed size array to a shadow copy
+     *
+     *  @param  pSource the address of the first element of the array
+     *  @param  nValues the number of elements in the array
+     *
+     *  @return the address of the first element of the shadow copy
+     */
+    template <typename T>
+    T *Bind(const T *const pSource, const unsigned int nValues);
+
+    /**
+     *  @brief  Start the output thread, once all variables are bound
+     *
+     *  @param  fillFunction the function filling the outputs from the shadow copies, called for each record
+     *  @param  endEventFunction the function called for each end of event marker
+     */
+    void Start(const OutputFunction &fillFunction, const OutputFunction &endEventFunction);
+
+    /**
+     *  @brief  Copy the bound variables to the queue, blocking while the queue is full
+     */
+    void PushRecord();
+
+    /**
+     *  @brief  Push an end of event marker, also holding the event-level variables, to the queue, blocking while the queue is full
+     */
+    void PushEndEvent();
+
+    /**
+     *  @brief  Wait for the output thread to write all queued records, then stop it; throws if the output functions failed
+     */
+    void Close();
+
+private:
+    /**
+     *  @brief  Binding class, a source variable and its shadow copy
+     */
+    class Binding
+    {
+    public:
+        /**
+         *  @brief  Destructor
+         */
+        virtual ~Binding() = default;
+
+        /**
+         *  @brief  Append the value of the source to a record
+         *
+         *  @param  bytes the bytes of the record
+         */
+        virtual void Save(std::vector<char> &bytes) const = 0;
+
+        /**
+         *  @brief  Restore the shadow copy from a record
+         *
+         *  @param  pBytes the position in the record, updated to the end of the value
+         */
+        virtual void Restore(const char *&pBytes) = 0;
+    };
+
+    /**
+     *  @brief  ArrayBinding class, a scalar or fixed size array of trivially copyable values
+     */
+    template <typename T>
+    class ArrayBinding : public Binding
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  pSource the address of the first element of the source array
+         *  @param  nValues the number of elements in the array
+         */
+        ArrayBinding(const T *const pSource, const unsigned int nValues);
+
+        void Save(std::vector<char> &bytes) const;
+        void Restore(const char *&pBytes);
+
+        const T                     *m_pSource;         ///< The address of the first element of the source array
+        std::vector<T>              m_shadow;           ///< The shadow copy
+    };
+
+    /**
+     *  @brief  VectorBinding class, a pointer to a vector of trivially copyable values
+     */
+    template <typename T>
+    class VectorBinding : public Binding
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  ppSource the address of the pointer to the source vector
+         */
+        VectorBinding(std::vector<T> *const *const ppSource);
+
+        void Save(std::vector<char> &bytes) const;
+        void Restore(const char *&pBytes);
+
+        std::vector<T> *const       *m_ppSource;        ///< The address of the pointer to the source vector
+        std::vector<T>              m_shadow;           ///< The shadow copy
+        std::vector<T>              *m_pShadow;         ///< The pointer to the shadow copy, to which the outputs are bound
+    };
+
+    /**
+     *  @brief  Record class, a slot in the ring
+     */
+    class Record
+    {
+    public:
+        bool                        m_isEndEvent;       ///< Whether the record is an end of event marker
+        std::vector<char>           m_bytes;            ///< The values of the bound, or only event-level, variables, in order of binding
+    };
+
+    typedef std::vector<std::unique_ptr<Binding>> BindingList;
+    typedef std::vector<Binding*> EventBindingList;
+
+    /**
+     *  @brief  Wait for a free slot, copy the bound variables to it and queue it for the output thread
+     *
+     *  @param  isEndEvent whether the record is an end of event marker
+     */
+    void Push(const bool isEndEvent);
+
+    /**
+     *  @brief  Throw if the output thread has failed
+     */
+    void CheckOutputThread() const;
+
+    /**
+     *  @brief  The output thread loop
+     */
+    void Run();
+
+    BindingList                     m_bindingList;      ///< The bindings, in order of binding
+    EventBindingList                m_eventBindingList; ///< The addresses of the event-level bindings, in order of binding
+    std::vector<Record>             m_slots;            ///< The ring of records
+    std::size_t                     m_head;             ///< The next slot to write out
+    std::size_t                     m_nQueued;          ///< The number of slots queued for the output thread
+    bool                            m_isClosing;        ///< Whether the output thread should stop once the queue is empty
+    bool                            m_hasFailed;        ///< Whether an output function threw
+    OutputFunction                  m_fillFunction;     ///< The function filling the outputs from the shadow copies
+    OutputFunction                  m_endEventFunction; ///< The function called for each end of event marker
+    mutable std::mutex              m_mutex;            ///< The mutex guarding the queue state
+    std::condition_variable         m_queuedCondition;  ///< Notified when a slot is queued or the queue is closing
+    std::condition_variable         m_freeCondition;    ///< Notified when a slot is freed
+    std::thread                     m_thread;           ///< The output thread
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline T *WriteBehindQueue::Bind(const T *const pSource)
+{
+    return this->Bind(pSource, 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline T *WriteBehindQueue::BindEvent(const T *const pSource)
+{
+    T *const pShadow(this->Bind(pSource, 1));
+    m_eventBindingList.push_back(m_bindingList.back().get());
+    return pShadow;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline std::vector<T> **WriteBehindQueue::Bind(std::vector<T> *const *const ppSource)
+{
+    if (m_thread.joinable())
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_ALLOWED);
+
+    VectorBinding<T> *const pBinding(new VectorBinding<T>(ppSource));
+    m_bindingList.emplace_back(pBinding);
+    return &pBinding->m_pShadow;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline T *WriteBehindQueue::Bind(const T *const pSource, const unsigned int nValues)
+{
+    if (m_thread.joinable() || (0 == nValues))
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_NOT_ALLOWED);
+
+    ArrayBinding<T> *const pBinding(new ArrayBinding<T>(pSource, nValues));
+    m_bindingList.emplace_back(pBinding);
+    return pBinding->m_shadow.data();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline WriteBehindQueue::ArrayBinding<T>::ArrayBinding(const T *const pSource, const unsigned int nValues) :
+    m_pSource(pSource),
+    m_shadow(pSource, pSource + nValues)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void WriteBehindQueue::ArrayBinding<T>::Save(std::vector<char> &bytes) const
+{
+    const char *const pBegin(reinterpret_cast<const char*>(m_pSource));
+    bytes.insert(bytes.end(), pBegin, pBegin + m_shadow.size() * sizeof(T));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void WriteBehindQueue::ArrayBinding<T>::Restore(const char *&pBytes)
+{
+    std::memcpy(m_shadow.data(), pBytes, m_shadow.size() * sizeof(T));
+    pBytes += m_shadow.size() * sizeof(T);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline WriteBehindQueue::VectorBinding<T>::VectorBinding(std::vector<T> *const *const ppSource) :
+    m_ppSource(ppSource),
+    m_pShadow(&m_shadow)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void WriteBehindQueue::VectorBinding<T>::Save(std::vector<char> &bytes) const
+{
+    // A null source pointer is written as an empty vector
+    const std::vector<T> *const pSource(*m_ppSource);
+    const std::size_t nValues(pSource ? pSource->size() : 0);
+    const char *const pSize(reinterpret_cast<const char*>(&nValues));
+    bytes.insert(bytes.end(), pSize, pSize + sizeof(nValues));
+
+    if (nValues > 0)
+    {
+        const char *const pBegin(reinterpret_cast<const char*>(pSource->data()));
+        bytes.insert(bytes.end(), pBegin, pBegin + nValues * sizeof(T));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void WriteBehindQueue::VectorBinding<T>::Restore(const char *&pBytes)
+{
+    std::size_t nValues(0);
+    std::memcpy(&nValues, pBytes, sizeof(nValues));
+    pBytes += sizeof(nValues);
+
+    m_shadow.resize(nValues);
+
+    if (nValues > 0)
+        std::memcpy(m_shadow.data(), pBytes, nValues * sizeof(T));
+
+    pBytes += nValues * sizeof(T);
+}
+
+} // namespace lar_reco
+
+#endif // #ifndef LAR_RECO_WRITE_BEHIND_QUEUE_H
@@ -0,0 +1,383 @@
+/**
+ *  @file   LArReco/src/AlgorithmTimer.cxx
+ *
+ *  @brief  Implementation of the algorithm timer class.
+ *
+ *  $Log: $
+ */
+
+#include "Helpers/XmlHelper.h"
+#include "Xml/tinyxml.h"
+
+#include "AlgorithmTimer.h"
+
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <unistd.h>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+const std::string AlgorithmTimer::MARKER_ALGORITHM_TYPE = "LArRecoTimingMarker";
+const std::string AlgorithmTimer::MASTER_ALGORITHM_TYPE = "LArRecoTimingMaster";
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+AlgorithmTimer::AlgorithmTimer(const std::string &reportFileName) :
+    m_reportFileName(reportFileName)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+AlgorithmTimer::~AlgorithmTimer()
+{
+    for (const std::string &settingsFileName : m_settingsFileNames)
+        std::remove(settingsFileName.c_str());
+
+    if (!m_settingsDirectory.empty())
+        rmdir(m_settingsDirectory.c_str());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const std::string &AlgorithmTimer::GetInstrumentedSettingsFile(const std::string &settingsFile)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const std::map<std::string, std::string>::const_iterator iter(m_settingsFileMap.find(settingsFile));
+
+    if (m_settingsFileMap.end() != iter)
+        return iter->second;
+
+    if (m_settingsDirectory.empty())
+    {
+        const char *const pTmpDir(std::getenv("TMPDIR"));
+        std::string directoryTemplate(std::string(pTmpDir ? pTmpDir : "/tmp") + "/LArRecoTiming.XXXXXX");
+
+        if (!mkdtemp(&directoryTemplate[0]))
+        {
+            std::cout << "AlgorithmTimer: unable to create directory for instrumented settings" << std::endl;
+            throw StatusCodeException(STATUS_CODE_FAILURE);
+        }
+
+        m_settingsDirectory = directoryTemplate;
+    }
+
+    return (m_settingsFileMap[settingsFile] = this->InstrumentSettingsFile(settingsFile));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void AlgorithmTimer::Mark(const Pandora *const pPandora, const std::string &instanceLabel, const std::string &algorithmName)
+{
+    const TimePoint now(AlgorithmTimer::Now());
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Worker instances run on the same thread as their primary instance, so each thread has at most one event in progress
+    const std::thread::id threadId(std::this_thread::get_id());
+
+    if (algorithmName.empty())
+    {
+        if (m_primaryLabel == instanceLabel)
+            this->CloseEvent(threadId);
+    }
+    else
+    {
+        const CheckpointMap::const_iterator iter(m_checkpointMap.find(pPandora));
+
+        if (m_checkpointMap.end() != iter)
+        {
+            TimePoint &eventTime(m_eventTimeMap[threadId][instanceLabel + "/" + algorithmName]);
+            eventTime.m_wallTime += now.m_wallTime - iter->second.m_wallTime;
+            eventTime.m_cpuTime += now.m_cpuTime - iter->second.m_cpuTime;
+        }
+    }
+
+    m_checkpointMap[pPandora] = now;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void AlgorithmTimer::WriteReport()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    while (!m_eventTimeMap.empty())
+        this->CloseEvent(m_eventTimeMap.begin()->first);
+
+    std::ofstream reportFile(m_reportFileName.c_str());
+
+    if (!reportFile)
+    {
+        std::cout << "AlgorithmTimer: unable to write timing report " << m_reportFileName << std::endl;
+        return;
+    }
+
+    const bool isJson((m_reportFileName.size() > 5) && (m_reportFileName.substr(m_reportFileName.size() - 5) == ".json"));
+    reportFile << (isJson ? "[" : "instance,algorithm,nEvents,wallMean,wallP50,wallP95,wallP99,cpuMean,cpuP50,cpuP95,cpuP99") << std::endl;
+
+    bool isFirstEntry(true);
+
+    for (SampleMap::value_type &mapEntry : m_sampleMap)
+    {
+        DoubleVector &wallTimes(mapEntry.second.first), &cpuTimes(mapEntry.second.second);
+        std::sort(wallTimes.begin(), wallTimes.end());
+        std::sort(cpuTimes.begin(), cpuTimes.end());
+
+        const std::string::size_type separatorPosition(mapEntry.first.find('/'));
+        const std::string instanceLabel(mapEntry.first.substr(0, separatorPosition)), algorithmName(mapEntry.first.substr(separatorPosition + 1));
+
+        // Times are reported in milliseconds
+        const double wallMean(1000. * std::accumulate(wallTimes.begin(), wallTimes.end(), 0.) / wallTimes.size());
+        const double cpuMean(1000. * std::accumulate(cpuTimes.begin(), cpuTimes.end(), 0.) / cpuTimes.size());
+        const DoubleVector wallPercentiles{1000. * GetPercentile(wallTimes, 50.), 1000. * GetPercentile(wallTimes, 95.), 1000. * GetPercentile(wallTimes, 99.)};
+        const DoubleVector cpuPercentiles{1000. * GetPercentile(cpuTimes, 50.), 1000. * GetPercentile(cpuTimes, 95.), 1000. * GetPercentile(cpuTimes, 99.)};
+
+        if (isJson)
+        {
+            reportFile << (isFirstEntry ? "" : ",\n") << "  {\"instance\": \"" << EscapeJson(instanceLabel) << "\", \"algorithm\": \"" << EscapeJson(algorithmName) << "\", \"nEvents\": " << wallTimes.size()
+                       << ", \"wallMs\": {\"mean\": " << wallMean << ", \"p50\": " << wallPercentiles.at(0) << ", \"p95\": " << wallPercentiles.at(1) << ", \"p99\": " << wallPercentiles.at(2) << "}"
+                       << ", \"cpuMs\": {\"mean\": " << cpuMean << ", \"p50\": " << cpuPercentiles.at(0) << ", \"p95\": " << cpuPercentiles.at(1) << ", \"p99\": " << cpuPercentiles.at(2) << "}}";
+        }
+        else
+        {
+            reportFile << instanceLabel << "," << algorithmName << "," << wallTimes.size() << "," << wallMean << "," << wallPercentiles.at(0) << "," << wallPercentiles.at(1) << ","
+                       << wallPercentiles.at(2) << "," << cpuMean << "," << cpuPercentiles.at(0) << "," << cpuPercentiles.at(1) << "," << cpuPercentiles.at(2) << std::endl;
+        }
+
+        isFirstEntry = false;
+    }
+
+    if (isJson)
+        reportFile << std::endl << "]" << std::endl;
+
+    std::cout << "AlgorithmTimer: written timing report " << m_reportFileName << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+AlgorithmTimer::TimePoint AlgorithmTimer::Now()
+{
+    timespec cpuTimeSpec;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTimeSpec);
+
+    const std::chrono::duration<double> wallTime(std::chrono::steady_clock::now().time_since_epoch());
+    return TimePoint(wallTime.count(), cpuTimeSpec.tv_sec + 1.e-9 * cpuTimeSpec.tv_nsec);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void AlgorithmTimer::CloseEvent(const std::thread::id threadId)
+{
+    const EventTimeMap::iterator iter(m_eventTimeMap.find(threadId));
+
+    if (m_eventTimeMap.end() == iter)
+        return;
+
+    for (const TimePointMap::value_type &mapEntry : iter->second)
+    {
+        m_sampleMap[mapEntry.first].first.push_back(mapEntry.second.m_wallTime);
+        m_sampleMap[mapEntry.first].second.push_back(mapEntry.second.m_cpuTime);
+    }
+
+    m_eventTimeMap.erase(iter);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string AlgorithmTimer::InstrumentSettingsFile(const std::string &settingsFile)
+{
+    TiXmlDocument xmlDocument(settingsFile);
+
+    if (!xmlDocument.LoadFile())
+    {
+        std::cout << "AlgorithmTimer: unable to load settings file " << settingsFile << std::endl;
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+    }
+
+    const std::string fileName(settingsFile.substr(settingsFile.find_last_of('/') + 1));
+    const std::string instanceLabel(fileName.substr(0, fileName.find_last_of('.')));
+
+    // The first settings file instrumented is the top-level file, so its checkpoints mark the start of each event
+    if (m_primaryLabel.empty())
+        m_primaryLabel = instanceLabel;
+
+    TiXmlElement *const pRootElement(xmlDocument.RootElement());
+    TiXmlElement *pAlgorithmElement(pRootElement ? pRootElement->FirstChildElement("algorithm") : nullptr);
+
+    if (pAlgorithmElement)
+        pRootElement->InsertBeforeChild(pAlgorithmElement, AlgorithmTimer::MakeMarkerElement(instanceLabel, ""));
+
+    while (pAlgorithmElement)
+    {
+        TiXmlElement *const pNextAlgorithmElement(pAlgorithmElement->NextSiblingElement("algorithm"));
+        const char *const pType(pAlgorithmElement->Attribute("type"));
+        const char *const pDescription(pAlgorithmElement->Attribute("description"));
+        const std::string algorithmType(pType ? pType : "");
+
+        if ("LArMaster" == algorithmType)
+            this->InstrumentMasterAlgorithm(pAlgorithmElement);
+
+        const std::string algorithmName(pDescription ? algorithmType + " (" + pDescription + ")" : algorithmType);
+        pRootElement->InsertAfterChild(pAlgorithmElement, AlgorithmTimer::MakeMarkerElement(instanceLabel, algorithmName));
+        pAlgorithmElement = pNextAlgorithmElement;
+    }
+
+    // Copies are keyed by the full path of the original, as settings files in different directories may share a name
+    std::ostringstream pathHash;
+    pathHash << std::hex << std::setw(16) << std::setfill('0') << static_cast<unsigned long long>(std::hash<std::string>()(settingsFile));
+    const std::string instrumentedSettingsFile(m_settingsDirectory + "/" + instanceLabel + "_" + pathHash.str() + ".xml");
+
+    if (!xmlDocument.SaveFile(instrumentedSettingsFile.c_str()))
+    {
+        std::cout << "AlgorithmTimer: unable to write instrumented settings file " << instrumentedSettingsFile << std::endl;
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+
+    m_settingsFileNames.push_back(instrumentedSettingsFile);
+    return instrumentedSettingsFile;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void AlgorithmTimer::InstrumentMasterAlgorithm(TiXmlElement *const pMasterElement)
+{
+    // The timing master registers the marker algorithm with each worker instance it creates
+    pMasterElement->SetAttribute("type", MASTER_ALGORITHM_TYPE.c_str());
+
+    std::string environmentVariable("FW_SEARCH_PATH");
+    (void) XmlHelper::ReadValue(TiXmlHandle(pMasterElement), "FilePathEnvironmentVariable", environmentVariable);
+
+    const char *const pSearchPath(std::getenv(environmentVariable.c_str()));
+    StringVector searchDirectories;
+    XmlHelper::TokenizeString(pSearchPath ? pSearchPath : "", searchDirectories, ":");
+
+    const StringVector settingsFileTags{"CRSettingsFile", "NuSettingsFile", "SlicingSettingsFile"};
+
+    for (const std::string &settingsFileTag : settingsFileTags)
+    {
+        TiXmlElement *const pSettingsFileElement(pMasterElement->FirstChildElement(settingsFileTag.c_str()));
+
+        if (!pSettingsFileElement || !pSettingsFileElement->GetText())
+            continue;
+
+        // Locate the worker settings as the master algorithm would, falling back to a path relative to the working directory
+        const std::string workerSettingsFile(pSettingsFileElement->GetText());
+        std::string workerSettingsPath(workerSettingsFile);
+
+        for (const std::string &searchDirectory : searchDirectories)
+        {
+            struct stat fileInfo;
+
+            if (0 == stat((searchDirectory + "/" + workerSettingsFile).c_str(), &fileInfo))
+            {
+                workerSettingsPath = searchDirectory + "/" + workerSettingsFile;
+                break;
+            }
+        }
+
+        pSettingsFileElement->Clear();
+        pSettingsFileElement->InsertEndChild(TiXmlText(GetSearchRelativePath(this->InstrumentSettingsFile(workerSettingsPath), searchDirectories).c_str()));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string AlgorithmTimer::GetSearchRelativePath(const std::string &absolutePath, const StringVector &searchDirectories)
+{
+    // The master algorithm joins each search directory to the file name, so the copy is named relative to the first directory that exists,
+    // climbing from its resolved location to the root; earlier directories do not exist, so cannot resolve the name to another file
+    for (const std::string &searchDirectory : searchDirectories)
+    {
+        char resolvedDirectory[PATH_MAX];
+
+        if (!realpath(searchDirectory.c_str(), resolvedDirectory))
+            continue;
+
+        std::string relativePath;
+
+        for (const char *pCharacter = resolvedDirectory; *pCharacter; ++pCharacter)
+        {
+            if (('/' == *pCharacter) && (*(pCharacter + 1)))
+                relativePath += "../";
+        }
+
+        return relativePath + absolutePath.substr(absolutePath.find_first_not_of('/'));
+    }
+
+    std::cout << "AlgorithmTimer: no existing directory in the settings search path, so instrumented worker settings cannot be located" << std::endl;
+    throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string AlgorithmTimer::EscapeJson(const std::string &text)
+{
+    std::ostringstream escapedText;
+
+    for (const char character : text)
+    {
+        if (('"' == character) || ('\\' == character))
+        {
+            escapedText << '\\' << character;
+        }
+        else if (static_cast<unsigned char>(character) < 0x20)
+        {
+            escapedText << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(character) << std::dec;
+        }
+        else
+        {
+            escapedText << character;
+        }
+    }
+
+    return escapedText.str();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+TiXmlElement AlgorithmTimer::MakeMarkerElement(const std::string &instanceLabel, const std::string &algorithmName)
+{
+    TiXmlElement markerElement("algorithm");
+    markerElement.SetAttribute("type", MARKER_ALGORITHM_TYPE.c_str());
+
+    TiXmlElement instanceLabelElement("InstanceLabel");
+    instanceLabelElement.InsertEndChild(TiXmlText(instanceLabel.c_str()));
+    markerElement.InsertEndChild(instanceLabelElement);
+
+    if (!algorithmName.empty())
+    {
+        TiXmlElement timedAlgorithmElement("TimedAlgorithm");
+        timedAlgorithmElement.InsertEndChild(TiXmlText(algorithmName.c_str()));
+        markerElement.InsertEndChild(timedAlgorithmElement);
+    }
+
+    return markerElement;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+double AlgorithmTimer::GetPercentile(const DoubleVector &sortedSamples, const double percentile)
+{
+    if (sortedSamples.empty())
+        return 0.;
+
+    const unsigned int rank(static_cast<unsigned int>(std::ceil(0.01 * percentile * sortedSamples.size())));
+    return sortedSamples.at(std::max(rank, 1u) - 1);
+}
+
+} // namespace lar_reco
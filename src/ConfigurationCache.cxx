@@ -0,0 +1,136 @@
+/**
+ *  @file   LArReco/src/ConfigurationCache.cxx
+ *
+ *  @brief  Implementation of the configuration cache class.
+ *
+ *  $Log: $
+ */
+
+#include "Api/PandoraApi.h"
+#include "Persistency/BinaryFileWriter.h"
+#include "Persistency/XmlFileReader.h"
+
+#include "ConfigurationCache.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+ConfigurationCache::ConfigurationCache(const std::string &cacheDirectory) :
+    m_cacheDirectory(cacheDirectory)
+{
+    for (size_t position = m_cacheDirectory.find('/', 1); std::string::npos != position; position = m_cacheDirectory.find('/', position + 1))
+        ConfigurationCache::MakeDirectory(m_cacheDirectory.substr(0, position));
+
+    ConfigurationCache::MakeDirectory(m_cacheDirectory);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string ConfigurationCache::GetCachedGeometryFile(const std::string &geometryFileName) const
+{
+    if (std::string::npos == geometryFileName.find(".xml"))
+        return geometryFileName;
+
+    const std::string hash(ConfigurationCache::GetFileHash(geometryFileName));
+
+    if (hash.empty())
+    {
+        std::cout << "ConfigurationCache: unable to read geometry file " << geometryFileName << std::endl;
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+    }
+
+    const std::string fileName(geometryFileName.substr(geometryFileName.find_last_of('/') + 1));
+    const std::string entryDirectory(m_cacheDirectory + "/" + hash);
+    const std::string cachedFileName(entryDirectory + "/" + fileName.substr(0, fileName.find_last_of('.')) + ".pndr");
+
+    struct stat fileInfo;
+
+    if (0 == stat(cachedFileName.c_str(), &fileInfo))
+        return cachedFileName;
+
+    // Round trip the geometry through a standalone pandora instance, which can then write it in binary form
+    ConfigurationCache::MakeDirectory(entryDirectory);
+    const std::string temporaryFileName(ConfigurationCache::GetTemporaryFileName(cachedFileName));
+
+    {
+        const Pandora pandora;
+        XmlFileReader fileReader(pandora, geometryFileName);
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, fileReader.ReadGeometry());
+
+        BinaryFileWriter fileWriter(pandora, temporaryFileName, OVERWRITE);
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, fileWriter.WriteGeometry());
+    }
+
+    ConfigurationCache::Commit(temporaryFileName, cachedFileName);
+    return cachedFileName;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string ConfigurationCache::GetFileHash(const std::string &fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+
+    if (!file)
+        return "";
+
+    // 64-bit FNV-1a, which is ample to distinguish revisions of a configuration file
+    unsigned long long hash(14695981039346656037ULL);
+    char buffer[65536];
+
+    while (file.read(buffer, sizeof(buffer)) || (file.gcount() > 0))
+    {
+        for (std::streamsize i = 0; i < file.gcount(); ++i)
+        {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    char hashString[17];
+    snprintf(hashString, sizeof(hashString), "%016llx", hash);
+    return hashString;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ConfigurationCache::MakeDirectory(const std::string &directory)
+{
+    if ((0 != mkdir(directory.c_str(), 0755)) && (EEXIST != errno))
+    {
+        std::cout << "ConfigurationCache: unable to create directory " << directory << std::endl;
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string ConfigurationCache::GetTemporaryFileName(const std::string &fileName)
+{
+    const size_t position(fileName.find_last_of('/') + 1);
+    return fileName.substr(0, position) + ".tmp" + std::to_string(getpid()) + "." + fileName.substr(position);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ConfigurationCache::Commit(const std::string &temporaryFileName, const std::string &fileName)
+{
+    if (0 != std::rename(temporaryFileName.c_str(), fileName.c_str()))
+    {
+        std::remove(temporaryFileName.c_str());
+        std::cout << "ConfigurationCache: unable to write " << fileName << std::endl;
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+}
+
+} // namespace lar_reco
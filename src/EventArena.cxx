@@ -0,0 +1,77 @@
+/**
+ *  @file   LArReco/src/EventArena.cxx
+ *
+ *  @brief  Implementation of the event arena class.
+ *
+ *  $Log: $
+ */
+
+#include "EventArena.h"
+
+#include <algorithm>
+
+namespace lar_reco
+{
+
+EventArena::EventArena(const std::size_t blockSize) :
+    m_blockSize(blockSize),
+    m_currentBlock(0),
+    m_position(0),
+    m_bytesAllocated(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void *EventArena::Allocate(const std::size_t size, const std::size_t alignment)
+{
+    while (m_currentBlock < m_blockList.size())
+    {
+        const std::size_t start((m_position + alignment - 1) & ~(alignment - 1));
+
+        if (start + size <= m_blockSizeList.at(m_currentBlock))
+        {
+            m_bytesAllocated += start + size - m_position;
+            m_position = start + size;
+            return m_blockList.at(m_currentBlock).get() + start;
+        }
+
+        ++m_currentBlock;
+        m_position = 0;
+    }
+
+    // Blocks from operator new[] are aligned for any fundamental type, so a new block needs no padding
+    const std::size_t blockSize(std::max(m_blockSize, size));
+    m_blockList.push_back(Block(new char[blockSize]));
+    m_blockSizeList.push_back(blockSize);
+    m_currentBlock = m_blockList.size() - 1;
+    m_position = size;
+    m_bytesAllocated += size;
+
+    return m_blockList.back().get();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void EventArena::Reset()
+{
+    // If the last event overflowed the first block, replace the blocks with a single block large enough for a similar event
+    if (m_blockList.size() > 1)
+    {
+        std::size_t totalSize(0);
+
+        for (const std::size_t blockSize : m_blockSizeList)
+            totalSize += blockSize;
+
+        m_blockList.clear();
+        m_blockSizeList.clear();
+        m_blockList.push_back(Block(new char[totalSize]));
+        m_blockSizeList.push_back(totalSize);
+    }
+
+    m_currentBlock = 0;
+    m_position = 0;
+    m_bytesAllocated = 0;
+}
+
+} // namespace lar_reco
@@ -0,0 +1,191 @@
+/**
+ *  @file   LArReco/src/EventFileIndex.cxx
+ *
+ *  @brief  Implementation of the event file index class.
+ *
+ *  $Log: $
+ */
+
+#include "Persistency/PandoraIO.h"
+
+#include "EventFileIndex.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+const std::string EventFileIndex::INDEX_FILE_SUFFIX = ".idx";
+const std::string EventFileIndex::INDEX_FORMAT_TAG = "LArRecoEventIndex1";
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventFileIndex::EventFileIndex(const std::string &fileName) :
+    m_fileName(fileName)
+{
+    struct stat fileInfo;
+
+    if (0 != stat(m_fileName.c_str(), &fileInfo))
+    {
+        std::cout << "EventFileIndex: unable to open event file " << m_fileName << std::endl;
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+    }
+
+    const std::streamoff fileSize(fileInfo.st_size);
+    const long modificationTime(fileInfo.st_mtime);
+
+    if (this->ReadIndex(fileSize, modificationTime))
+        return;
+
+    this->BuildIndex(fileSize);
+    this->WriteIndex(fileSize, modificationTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool EventFileIndex::IsIndexable(const std::string &fileName)
+{
+    return (std::string::npos != fileName.find(".pndr"));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int EventFileIndex::GetNEvents() const
+{
+    return m_eventLocationList.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void EventFileIndex::WriteEventFile(const unsigned int eventNumber, const std::string &outputFileName) const
+{
+    if (eventNumber >= m_eventLocationList.size())
+    {
+        std::cout << "EventFileIndex: event " << eventNumber << " not found in " << m_fileName << " (" << m_eventLocationList.size() << " events)" << std::endl;
+        throw StatusCodeException(STATUS_CODE_OUT_OF_RANGE);
+    }
+
+    // A pandora binary file is a plain sequence of containers, so a single event container is itself a valid event file
+    const EventLocation &eventLocation(m_eventLocationList.at(eventNumber));
+    std::vector<char> buffer(eventLocation.m_size);
+
+    std::ifstream inputFile(m_fileName.c_str(), std::ios::binary);
+    inputFile.seekg(eventLocation.m_offset, std::ios::beg);
+
+    if (!inputFile.read(buffer.data(), buffer.size()))
+    {
+        std::cout << "EventFileIndex: unable to read event " << eventNumber << " from " << m_fileName << std::endl;
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+
+    std::ofstream outputFile(outputFileName.c_str(), std::ios::binary | std::ios::trunc);
+
+    if (!outputFile.write(buffer.data(), buffer.size()))
+    {
+        std::cout << "EventFileIndex: unable to write event file " << outputFileName << std::endl;
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool EventFileIndex::ReadIndex(const std::streamoff fileSize, const long modificationTime)
+{
+    std::ifstream indexFile((m_fileName + INDEX_FILE_SUFFIX).c_str());
+    std::string formatTag;
+    std::streamoff indexedFileSize(0);
+    long indexedModificationTime(0);
+    unsigned int nEvents(0);
+
+    if (!(indexFile >> formatTag >> indexedFileSize >> indexedModificationTime >> nEvents))
+        return false;
+
+    if ((INDEX_FORMAT_TAG != formatTag) || (fileSize != indexedFileSize) || (modificationTime != indexedModificationTime))
+        return false;
+
+    EventLocationList eventLocationList(nEvents);
+
+    for (EventLocation &eventLocation : eventLocationList)
+    {
+        if (!(indexFile >> eventLocation.m_offset >> eventLocation.m_size) || (eventLocation.m_offset + eventLocation.m_size > fileSize))
+            return false;
+    }
+
+    m_eventLocationList.swap(eventLocationList);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void EventFileIndex::BuildIndex(const std::streamoff fileSize)
+{
+    std::ifstream eventFile(m_fileName.c_str(), std::ios::binary);
+    std::streamoff offset(0);
+
+    // Container headers are read with the same types as written by the pandora binary file writer; scanning stops, as pandora's own reader
+    // would, at the end of the file or at the first container that is malformed or truncated
+    while (offset < fileSize)
+    {
+        unsigned int fileHash(0);
+        ContainerId containerId(UNKNOWN_CONTAINER);
+        std::ifstream::pos_type containerSize(0);
+
+        eventFile.seekg(offset, std::ios::beg);
+        eventFile.read(reinterpret_cast<char*>(&fileHash), sizeof(fileHash));
+        eventFile.read(reinterpret_cast<char*>(&containerId), sizeof(containerId));
+        eventFile.read(reinterpret_cast<char*>(&containerSize), sizeof(containerSize));
+
+        const std::streamoff size(containerSize);
+
+        if (!eventFile || (PANDORA_FILE_HASH != fileHash) || (size <= 0) || (offset + size > fileSize))
+        {
+            std::cout << "EventFileIndex: unreadable container at byte " << offset << " of " << m_fileName << ", indexed "
+                      << m_eventLocationList.size() << " events" << std::endl;
+            break;
+        }
+
+        if (EVENT_CONTAINER == containerId)
+        {
+            EventLocation eventLocation;
+            eventLocation.m_offset = offset;
+            eventLocation.m_size = size;
+            m_eventLocationList.push_back(eventLocation);
+        }
+
+        offset += size;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void EventFileIndex::WriteIndex(const std::streamoff fileSize, const long modificationTime) const
+{
+    // Written under a temporary name then renamed, so that concurrent jobs never see a partial index
+    const std::string indexFileName(m_fileName + INDEX_FILE_SUFFIX);
+    const std::string temporaryFileName(indexFileName + ".tmp" + std::to_string(getpid()));
+
+    std::ofstream indexFile(temporaryFileName.c_str());
+    indexFile << INDEX_FORMAT_TAG << " " << fileSize << " " << modificationTime << " " << m_eventLocationList.size() << std::endl;
+
+    for (const EventLocation &eventLocation : m_eventLocationList)
+        indexFile << eventLocation.m_offset << " " << eventLocation.m_size << std::endl;
+
+    indexFile.close();
+
+    // An unwritable input directory only costs a rebuild next time, so the index is still used for this job
+    if (!indexFile || (0 != std::rename(temporaryFileName.c_str(), indexFileName.c_str())))
+    {
+        std::remove(temporaryFileName.c_str());
+        std::cout << "EventFileIndex: unable to write index file " << indexFileName << std::endl;
+    }
+}
+
+} // namespace lar_reco
@@ -0,0 +1,170 @@
+/**
+ *  @file   LArReco/src/HitEncoder.cxx
+ *
+ *  @brief  Implementation of the hit encoder class.
+ *
+ *  $Log: $
+ */
+
+#include "Helpers/XmlHelper.h"
+#include "Xml/tinyxml.h"
+
+#include "HitEncoder.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace pandora;
+
+namespace
+{
+
+const float MAX_CODE(65535.f);
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+HitEncoder::EncodedQuantity::EncodedQuantity(const std::string &name, const FloatVector *const *const ppValues, const float precision) :
+    m_name(name),
+    m_ppValues(ppValues),
+    m_precision(precision),
+    m_pCodes(&m_codes),
+    m_min(0.f),
+    m_step(precision),
+    m_nValues(0),
+    m_maxError(0.),
+    m_sumSquaredErrors(0.)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HitEncoder::HitEncoder() :
+    m_isEnabled(false),
+    m_isDelta(false),
+    m_coordinatePrecision(0.01f),
+    m_energyPrecision(1.e-6f),
+    m_reportErrors(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode HitEncoder::ReadSettings(const TiXmlHandle &xmlHandle)
+{
+    const TiXmlHandle encodingHandle(xmlHandle.FirstChild("HitEncoding"));
+
+    if (!encodingHandle.Element())
+        return STATUS_CODE_SUCCESS;
+
+    m_isEnabled = true;
+
+    std::string encoding("FixedPoint");
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(encodingHandle, "Encoding", encoding));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(encodingHandle, "CoordinatePrecision", m_coordinatePrecision));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(encodingHandle, "EnergyPrecision", m_energyPrecision));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(encodingHandle, "ReportErrors", m_reportErrors));
+
+    if (("FixedPoint" != encoding) && ("Delta" != encoding))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "HitEncoder: unrecognised Encoding " << encoding << ", expected FixedPoint or Delta");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    if (!(m_coordinatePrecision > 0.f) || !(m_energyPrecision > 0.f))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "HitEncoder: CoordinatePrecision and EnergyPrecision must be positive");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    m_isDelta = ("Delta" == encoding);
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HitEncoder::EncodedQuantity &HitEncoder::AddQuantity(const std::string &name, const FloatVector *const *const ppValues, const float precision)
+{
+    m_quantityList.emplace_back(name, ppValues, precision);
+    return m_quantityList.back();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitEncoder::Encode()
+{
+    for (EncodedQuantity &quantity : m_quantityList)
+    {
+        const FloatVector &values(**quantity.m_ppValues);
+        HitEncoder::Encode(values, quantity.m_precision, m_isDelta, quantity.m_codes, quantity.m_min, quantity.m_step);
+
+        if (!m_reportErrors)
+            continue;
+
+        // Measured through the decoder, so the report covers the full round trip
+        HitEncoder::Decode(quantity.m_codes, quantity.m_min, quantity.m_step, m_isDelta, m_decodedValues);
+
+        for (unsigned int iValue = 0; iValue < m_decodedValues.size(); ++iValue)
+        {
+            const double error(std::fabs(static_cast<double>(m_decodedValues[iValue]) - values[iValue]));
+            quantity.m_maxError = std::max(quantity.m_maxError, error);
+            quantity.m_sumSquaredErrors += error * error;
+        }
+
+        quantity.m_nValues += m_decodedValues.size();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitEncoder::PrintErrorReport(std::ostream &stream) const
+{
+    stream << "Hit encoding errors, " << (m_isDelta ? "Delta" : "FixedPoint") << " encoding (values, largest error, rms error)" << std::endl;
+
+    for (const EncodedQuantity &quantity : m_quantityList)
+    {
+        const double rmsError((quantity.m_nValues > 0) ? std::sqrt(quantity.m_sumSquaredErrors / quantity.m_nValues) : 0.);
+        stream << "  " << std::left << std::setw(24) << quantity.m_name << std::right << std::setw(14) << quantity.m_nValues
+               << std::setw(14) << std::scientific << std::setprecision(3) << quantity.m_maxError << std::setw(14) << rmsError << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitEncoder::Encode(const FloatVector &values, const float precision, const bool isDelta, CodeVector &codes, float &min, float &step)
+{
+    codes.resize(values.size());
+    min = 0.f;
+    step = precision;
+
+    if (values.empty())
+        return;
+
+    const std::pair<FloatVector::const_iterator, FloatVector::const_iterator> range(std::minmax_element(values.begin(), values.end()));
+    min = *range.first;
+    step = std::max(precision, (*range.second - min) / MAX_CODE);
+
+    // Branch-free over the contiguous values, so that the loop vectorises; the clamp only guards against rounding at the top of the range
+    const float inverseStep(1.f / step);
+    const float *const pValues(values.data());
+    unsigned short *const pCodes(codes.data());
+
+    for (unsigned int iValue = 0; iValue < values.size(); ++iValue)
+        pCodes[iValue] = static_cast<unsigned short>(std::min((pValues[iValue] - min) * inverseStep + 0.5f, MAX_CODE));
+
+    if (!isDelta)
+        return;
+
+    for (unsigned int iValue = values.size() - 1; iValue > 0; --iValue)
+        pCodes[iValue] = static_cast<unsigned short>(pCodes[iValue] - pCodes[iValue - 1]);
+}
+
+} // namespace lar_reco
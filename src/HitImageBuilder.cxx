@@ -0,0 +1,193 @@
+/**
+ *  @file   LArReco/src/HitImageBuilder.cxx
+ *
+ *  @brief  Implementation of the hit image builder class.
+ *
+ *  $Log: $
+ */
+
+#include "Helpers/XmlHelper.h"
+#include "Xml/tinyxml.h"
+
+#include "HitImageBuilder.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+HitImageBuilder::HitImageBuilder() :
+    m_isEnabled(false),
+    m_isSparse(true),
+    m_cropAroundVertex(true),
+    m_nDriftPixels(64),
+    m_nWirePixels(64),
+    m_wirePitch(0.f),
+    m_driftPitch(0.f)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode HitImageBuilder::ReadSettings(const TiXmlHandle &xmlHandle)
+{
+    const TiXmlHandle imagesHandle(xmlHandle.FirstChild("HitImages"));
+
+    if (!imagesHandle.Element())
+        return STATUS_CODE_SUCCESS;
+
+    m_isEnabled = true;
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(imagesHandle, "NDriftPixels", m_nDriftPixels));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(imagesHandle, "NWirePixels", m_nWirePixels));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(imagesHandle, "WirePitch", m_wirePitch));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(imagesHandle, "DriftPitch", m_driftPitch));
+
+    std::string cropAround("Vertex"), storage("Sparse");
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(imagesHandle, "CropAround", cropAround));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(imagesHandle, "Storage", storage));
+
+    if (("Vertex" != cropAround) && ("Centroid" != cropAround))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "HitImageBuilder: unrecognised CropAround " << cropAround << ", expected Vertex or Centroid");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    if (("Sparse" != storage) && ("Dense" != storage))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "HitImageBuilder: unrecognised Storage " << storage << ", expected Sparse or Dense");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    // Pixel indices are stored as ints
+    if ((0 == m_nDriftPixels) || (0 == m_nWirePixels) || (m_nDriftPixels > 32768) || (m_nWirePixels > 32768) || (m_wirePitch < 0.f) ||
+        (m_driftPitch < 0.f))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "HitImageBuilder: NDriftPixels and NWirePixels must be from 1 to 32768, and pitches must not be negative");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    m_cropAroundVertex = ("Vertex" == cropAround);
+    m_isSparse = ("Sparse" == storage);
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitImageBuilder::GetCentroid(const float *const pDriftCoords, const float *const pWireCoords, const float *const pEnergies, const unsigned int nHits,
+    float &driftCentroid, float &wireCentroid)
+{
+    double driftSum(0.), wireSum(0.), energySum(0.), unweightedDriftSum(0.), unweightedWireSum(0.);
+
+    for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+    {
+        driftSum += pEnergies[iHit] * pDriftCoords[iHit];
+        wireSum += pEnergies[iHit] * pWireCoords[iHit];
+        energySum += pEnergies[iHit];
+        unweightedDriftSum += pDriftCoords[iHit];
+        unweightedWireSum += pWireCoords[iHit];
+    }
+
+    if (energySum > 0.)
+    {
+        driftCentroid = static_cast<float>(driftSum / energySum);
+        wireCentroid = static_cast<float>(wireSum / energySum);
+    }
+    else
+    {
+        driftCentroid = (nHits > 0) ? static_cast<float>(unweightedDriftSum / nHits) : 0.f;
+        wireCentroid = (nHits > 0) ? static_cast<float>(unweightedWireSum / nHits) : 0.f;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitImageBuilder::Build(const float *const pDriftCoords, const float *const pWireCoords, const float *const pEnergies, const unsigned int nHits,
+    const float driftCentre, const float wireCentre, const float driftPitch, const float wirePitch, float &driftOrigin, float &wireOrigin,
+    IntVector &pixelIndices, FloatVector &pixelValues)
+{
+    const std::size_t nPixels(static_cast<std::size_t>(m_nDriftPixels) * m_nWirePixels);
+    driftOrigin = driftCentre - 0.5f * m_nDriftPixels * driftPitch;
+    wireOrigin = wireCentre - 0.5f * m_nWirePixels * wirePitch;
+    this->ComputeHitPixels(pDriftCoords, pWireCoords, nHits, driftOrigin, wireOrigin, driftPitch, wirePitch);
+
+    pixelIndices.clear();
+
+    if (!m_isSparse)
+    {
+        pixelValues.assign(nPixels, 0.f);
+
+        for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+        {
+            if (m_hitPixels[iHit] >= 0)
+                pixelValues[m_hitPixels[iHit]] += pEnergies[iHit];
+        }
+
+        return;
+    }
+
+    // Sums are accumulated in a dense buffer, which is cleared again pixel by pixel, so that each image costs time in its hits, not pixels
+    if (m_pixelSums.size() != nPixels)
+    {
+        m_pixelSums.assign(nPixels, 0.f);
+        m_isPixelFilled.assign(nPixels, 0);
+    }
+
+    for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+    {
+        const int pixel(m_hitPixels[iHit]);
+
+        if (pixel < 0)
+            continue;
+
+        if (!m_isPixelFilled[pixel])
+        {
+            m_isPixelFilled[pixel] = 1;
+            pixelIndices.push_back(pixel);
+        }
+
+        m_pixelSums[pixel] += pEnergies[iHit];
+    }
+
+    std::sort(pixelIndices.begin(), pixelIndices.end());
+    pixelValues.resize(pixelIndices.size());
+
+    for (unsigned int iPixel = 0; iPixel < pixelIndices.size(); ++iPixel)
+    {
+        const int pixel(pixelIndices[iPixel]);
+        pixelValues[iPixel] = m_pixelSums[pixel];
+        m_pixelSums[pixel] = 0.f;
+        m_isPixelFilled[pixel] = 0;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitImageBuilder::ComputeHitPixels(const float *const pDriftCoords, const float *const pWireCoords, const unsigned int nHits, const float driftOrigin,
+    const float wireOrigin, const float driftPitch, const float wirePitch)
+{
+    m_hitPixels.resize(nHits);
+
+    // Branch-free over the contiguous coordinate arrays, so that the compiler vectorises the loop. Non-finite positions are skipped, and the
+    // rest clamped to one pixel beyond the image before conversion, so that no hit can overflow an int
+    const float inverseDriftPitch(1.f / driftPitch), inverseWirePitch(1.f / wirePitch);
+    const float maxRow(static_cast<float>(m_nDriftPixels)), maxColumn(static_cast<float>(m_nWirePixels));
+    const int nDriftPixels(static_cast<int>(m_nDriftPixels)), nWirePixels(static_cast<int>(m_nWirePixels));
+    int *const pHitPixels(m_hitPixels.data());
+
+    for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+    {
+        const float driftPosition(std::floor((pDriftCoords[iHit] - driftOrigin) * inverseDriftPitch));
+        const float wirePosition(std::floor((pWireCoords[iHit] - wireOrigin) * inverseWirePitch));
+        const int row(static_cast<int>(std::isfinite(driftPosition) ? std::min(std::max(driftPosition, -1.f), maxRow) : -1.f));
+        const int column(static_cast<int>(std::isfinite(wirePosition) ? std::min(std::max(wirePosition, -1.f), maxColumn) : -1.f));
+        const bool isInside((row >= 0) & (row < nDriftPixels) & (column >= 0) & (column < nWirePixels));
+        pHitPixels[iHit] = isInside ? (row * nWirePixels + column) : -1;
+    }
+}
+
+} // namespace lar_reco
@@ -0,0 +1,157 @@
+/**
+ *  @file   LArReco/src/HitOrdering.cxx
+ *
+ *  @brief  Implementation of the hit ordering class.
+ *
+ *  $Log: $
+ */
+
+#include "HitOrdering.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+HitOrdering::HitOrdering() :
+    m_order(HIT_ORDER_INPUT)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode HitOrdering::SetOrder(const std::string &orderName)
+{
+    if ("Input" == orderName)
+    {
+        m_order = HIT_ORDER_INPUT;
+    }
+    else if ("WireDrift" == orderName)
+    {
+        m_order = HIT_ORDER_WIRE_DRIFT;
+    }
+    else if ("Morton" == orderName)
+    {
+        m_order = HIT_ORDER_MORTON;
+    }
+    else if ("VertexDistance" == orderName)
+    {
+        m_order = HIT_ORDER_VERTEX_DISTANCE;
+    }
+    else
+    {
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitOrdering::Sort(const float *const pXCoords, const float *const pYCoords, const float *const pZCoords, const unsigned int nHits, const float *const pVertex)
+{
+    m_permutation.resize(nHits);
+    std::iota(m_permutation.begin(), m_permutation.end(), 0);
+
+    if (nHits < 2)
+        return;
+
+    if ((HIT_ORDER_VERTEX_DISTANCE == m_order) && pVertex)
+    {
+        m_distances.resize(nHits);
+
+        for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+        {
+            const float dx(pXCoords[iHit] - pVertex[0]), dz(pZCoords[iHit] - pVertex[2]);
+            m_distances[iHit] = dx * dx + dz * dz;
+        }
+
+        if (pYCoords)
+        {
+            for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+                m_distances[iHit] += (pYCoords[iHit] - pVertex[1]) * (pYCoords[iHit] - pVertex[1]);
+        }
+
+        const float *const pDistances(m_distances.data());
+        std::stable_sort(m_permutation.begin(), m_permutation.end(),
+            [pDistances](const unsigned int lhs, const unsigned int rhs) { return (pDistances[lhs] < pDistances[rhs]); });
+    }
+    else if (HIT_ORDER_MORTON == m_order)
+    {
+        // Each coordinate is quantised to 21 bits across the bounding box of the hits, so that nearby hits share their leading code bits
+        const float *const pCoords[3] = {pXCoords, pYCoords, pZCoords};
+        const float maxCell(static_cast<float>((1 << 21) - 1));
+        m_mortonCodes.assign(nHits, 0);
+
+        for (unsigned int iDim = 0; iDim < 3; ++iDim)
+        {
+            const float *const pCoord(pCoords[iDim]);
+
+            if (!pCoord)
+                continue;
+
+            const std::pair<const float*, const float*> range(std::minmax_element(pCoord, pCoord + nHits));
+            const float min(*range.first), extent(*range.second - *range.first);
+            const float scale((extent > 0.f) ? maxCell / extent : 0.f);
+
+            for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+            {
+                const uint64_t cell(static_cast<uint64_t>(std::min((pCoord[iHit] - min) * scale, maxCell)));
+                m_mortonCodes[iHit] |= (SpreadBits(cell) << (2 - iDim));
+            }
+        }
+
+        const uint64_t *const pMortonCodes(m_mortonCodes.data());
+        std::stable_sort(m_permutation.begin(), m_permutation.end(),
+            [pMortonCodes](const unsigned int lhs, const unsigned int rhs) { return (pMortonCodes[lhs] < pMortonCodes[rhs]); });
+    }
+    else if (HIT_ORDER_INPUT != m_order)
+    {
+        std::stable_sort(m_permutation.begin(), m_permutation.end(), [pXCoords, pYCoords, pZCoords](const unsigned int lhs, const unsigned int rhs)
+        {
+            if (pZCoords[lhs] != pZCoords[rhs])
+                return (pZCoords[lhs] < pZCoords[rhs]);
+
+            if (pXCoords[lhs] != pXCoords[rhs])
+                return (pXCoords[lhs] < pXCoords[rhs]);
+
+            return (pYCoords && (pYCoords[lhs] < pYCoords[rhs]));
+        });
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitOrdering::Apply(FloatVector &values)
+{
+    if (values.empty())
+        return;
+
+    if (values.size() != m_permutation.size())
+        throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+
+    m_sortedValues.resize(values.size());
+
+    for (unsigned int iHit = 0; iHit < m_permutation.size(); ++iHit)
+        m_sortedValues[iHit] = values[m_permutation[iHit]];
+
+    values.swap(m_sortedValues);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+uint64_t HitOrdering::SpreadBits(const uint64_t value)
+{
+    uint64_t bits(value & 0x1fffff);
+    bits = (bits | (bits << 32)) & 0x1f00000000ffffULL;
+    bits = (bits | (bits << 16)) & 0x1f0000ff0000ffULL;
+    bits = (bits | (bits << 8)) & 0x100f00f00f00f00fULL;
+    bits = (bits | (bits << 4)) & 0x10c30c30c30c30c3ULL;
+    bits = (bits | (bits << 2)) & 0x1249249249249249ULL;
+    return bits;
+}
+
+} // namespace lar_reco
@@ -0,0 +1,273 @@
+/**
+ *  @file   LArReco/src/Logger.cxx
+ *
+ *  @brief  Implementation of the logger class.
+ *
+ *  $Log: $
+ */
+
+#include "Logger.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace lar_reco
+{
+
+/**
+ *  @brief  Sink class, collecting messages from all loggers and writing them to standard output in batches from a background thread
+ *
+ *  A forked child keeps only the forking thread, so the sink it inherits has no writing thread, and its mutex and conditions may be held by
+ *  threads that no longer exist. The child abandons that sink, whose pending messages are the parent's to write, and starts its own.
+ */
+class Logger::Sink
+{
+public:
+    /**
+     *  @brief  Get the sink, starting it on first use in each process
+     *
+     *  @return the sink
+     */
+    static Sink &Instance();
+
+    /**
+     *  @brief  Destructor, writing any remaining messages
+     */
+    ~Sink();
+
+    /**
+     *  @brief  Append a message to the pending batch
+     *
+     *  @param  message the message
+     */
+    void Write(const std::string &message);
+
+    /**
+     *  @brief  Block until the pending batch, and any batch being written, have been written
+     */
+    void Flush();
+
+private:
+    /**
+     *  @brief  Constructor
+     */
+    Sink();
+
+    /**
+     *  @brief  Write batches of messages until the sink is destroyed
+     */
+    void WriteBatches();
+
+    /**
+     *  @brief  Fork handler for the parent, before the fork, holding the instance mutex so that the child receives it unlocked
+     */
+    static void PrepareFork();
+
+    /**
+     *  @brief  Fork handler for the parent, after the fork, releasing the instance mutex
+     */
+    static void ResumeParent();
+
+    /**
+     *  @brief  Fork handler for the child, abandoning the inherited sink and releasing the instance mutex
+     */
+    static void ResumeChild();
+
+    static std::mutex           m_instanceMutex;        ///< The mutex guarding the instance
+    static std::unique_ptr<Sink> m_pInstance;           ///< The instance, if started in this process
+
+    std::mutex                  m_mutex;                ///< The mutex guarding the pending batch and flags
+    std::condition_variable     m_pendingCondition;     ///< Signalled when messages are pending, or the sink is stopping
+    std::condition_variable     m_writtenCondition;     ///< Signalled when a batch has been written
+    std::string                 m_pendingBatch;         ///< The messages waiting to be written
+    bool                        m_isWriting;            ///< Whether a batch is being written
+    bool                        m_isStopping;           ///< Whether the sink is being destroyed
+    std::thread                 m_thread;               ///< The writing thread
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::mutex Logger::Sink::m_instanceMutex;
+std::unique_ptr<Logger::Sink> Logger::Sink::m_pInstance;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+Logger::Sink &Logger::Sink::Instance()
+{
+    static bool isForkHandled(false);
+    std::lock_guard<std::mutex> lock(m_instanceMutex);
+
+    if (!isForkHandled)
+    {
+        (void) pthread_atfork(&Sink::PrepareFork, &Sink::ResumeParent, &Sink::ResumeChild);
+        isForkHandled = true;
+    }
+
+    if (!m_pInstance)
+        m_pInstance.reset(new Sink);
+
+    return *m_pInstance;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+Logger::Sink::Sink() :
+    m_isWriting(false),
+    m_isStopping(false),
+    m_thread(&Sink::WriteBatches, this)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+Logger::Sink::~Sink()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+
+    m_pendingCondition.notify_one();
+    m_thread.join();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Logger::Sink::Write(const std::string &message)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingBatch += message;
+    }
+
+    m_pendingCondition.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Logger::Sink::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_writtenCondition.wait(lock, [this] {return (m_pendingBatch.empty() && !m_isWriting);});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Logger::Sink::WriteBatches()
+{
+    std::string batch;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_pendingCondition.wait(lock, [this] {return (!m_pendingBatch.empty() || m_isStopping);});
+
+        if (m_pendingBatch.empty())
+            break;
+
+        // Swap the batch out, so that loggers can keep appending while it is written, with a single flush per batch
+        batch.clear();
+        batch.swap(m_pendingBatch);
+        m_isWriting = true;
+        lock.unlock();
+
+        std::cout.write(batch.data(), batch.size());
+        std::cout.flush();
+
+        lock.lock();
+        m_isWriting = false;
+        m_writtenCondition.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Logger::Sink::PrepareFork()
+{
+    m_instanceMutex.lock();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Logger::Sink::ResumeParent()
+{
+    m_instanceMutex.unlock();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Logger::Sink::ResumeChild()
+{
+    // Released rather than destroyed, as destruction would join a thread that does not exist in the child
+    (void) m_pInstance.release();
+    m_instanceMutex.unlock();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+Logger::Logger(const LogLevel logLevel) :
+    m_logLevel(logLevel)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+pandora::StatusCode Logger::SetLogLevel(const std::string &logLevelName)
+{
+    std::string name(logLevelName);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+    if ("error" == name)
+    {
+        m_logLevel = LOG_ERROR;
+    }
+    else if ("warning" == name)
+    {
+        m_logLevel = LOG_WARNING;
+    }
+    else if ("info" == name)
+    {
+        m_logLevel = LOG_INFO;
+    }
+    else if ("debug" == name)
+    {
+        m_logLevel = LOG_DEBUG;
+    }
+    else
+    {
+        return pandora::STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    return pandora::STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Logger::Write(const std::string &message) const
+{
+    Sink::Instance().Write(message);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void Logger::Flush()
+{
+    Sink::Instance().Flush();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const Logger &Logger::GetDefault()
+{
+    static const Logger logger(LOG_INFO);
+    return logger;
+}
+
+} // namespace lar_reco
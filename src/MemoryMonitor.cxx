@@ -0,0 +1,219 @@
+/**
+ *  @file   LArReco/src/MemoryMonitor.cxx
+ *
+ *  @brief  Implementation of the memory monitor class.
+ *
+ *  $Log: $
+ */
+
+#include "MemoryMonitor.h"
+
+#include <malloc.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace lar_reco
+{
+
+MemoryMonitor::MemoryMonitor(const std::string &reportFileName, const unsigned int nLargestEvents) :
+    m_reportFileName(reportFileName),
+    m_nLargestEvents(nLargestEvents)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void MemoryMonitor::BeginEvent(const unsigned int event)
+{
+    MemoryMonitor::ResetPeakResidentSetSize();
+
+    m_currentEventRecord = EventRecord();
+    m_currentEventRecord.m_event = event;
+    m_currentEventRecord.m_rssBefore = MemoryMonitor::GetResidentSetSize();
+    m_currentEventRecord.m_heapBefore = MemoryMonitor::GetHeapInUse();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void MemoryMonitor::EndEventProcessing()
+{
+    m_currentEventRecord.m_rssAfterProcessing = MemoryMonitor::GetResidentSetSize();
+    m_currentEventRecord.m_heapAfterProcessing = MemoryMonitor::GetHeapInUse();
+    m_currentEventRecord.m_rssPeak = std::max(MemoryMonitor::GetPeakResidentSetSize(), m_currentEventRecord.m_rssAfterProcessing);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void MemoryMonitor::EndEvent()
+{
+    // Only completed events are recorded, so an event interrupted by an exception leaves no partial record
+    m_currentEventRecord.m_rssAfterReset = MemoryMonitor::GetResidentSetSize();
+    m_currentEventRecord.m_heapAfterReset = MemoryMonitor::GetHeapInUse();
+    m_eventRecordList.push_back(m_currentEventRecord);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void MemoryMonitor::WriteReport() const
+{
+    if (m_eventRecordList.empty())
+        return;
+
+    // Memory retained after reset is what accumulates over a long job, so events are ranked by retained heap, then by peak rss
+    EventRecordList retainedRecordList(m_eventRecordList), peakRecordList(m_eventRecordList);
+    std::stable_sort(retainedRecordList.begin(), retainedRecordList.end(),
+        [](const EventRecord &lhs, const EventRecord &rhs) {return (lhs.GetRetainedHeap() > rhs.GetRetainedHeap());});
+    std::stable_sort(peakRecordList.begin(), peakRecordList.end(),
+        [](const EventRecord &lhs, const EventRecord &rhs) {return ((lhs.m_rssPeak - lhs.m_rssBefore) > (rhs.m_rssPeak - rhs.m_rssBefore));});
+
+    const EventRecord &firstRecord(m_eventRecordList.front()), &lastRecord(m_eventRecordList.back());
+    const unsigned int nLargestEvents(std::min(m_nLargestEvents, static_cast<unsigned int>(m_eventRecordList.size())));
+
+    std::cout << "MemoryMonitor: " << m_eventRecordList.size() << " events, rss " << firstRecord.m_rssBefore << " -> " << lastRecord.m_rssAfterReset
+              << " MB, heap in use " << firstRecord.m_heapBefore << " -> " << lastRecord.m_heapAfterReset << " MB" << std::endl;
+
+    std::cout << "MemoryMonitor: largest retained heap growth (event: MB)";
+
+    for (unsigned int iEvent = 0; iEvent < nLargestEvents; ++iEvent)
+        std::cout << (iEvent ? ", " : " ") << retainedRecordList.at(iEvent).m_event << ": " << retainedRecordList.at(iEvent).GetRetainedHeap();
+
+    std::cout << std::endl << "MemoryMonitor: largest peak rss growth (event: MB)";
+
+    for (unsigned int iEvent = 0; iEvent < nLargestEvents; ++iEvent)
+        std::cout << (iEvent ? ", " : " ") << peakRecordList.at(iEvent).m_event << ": " << (peakRecordList.at(iEvent).m_rssPeak - peakRecordList.at(iEvent).m_rssBefore);
+
+    std::cout << std::endl;
+
+    std::ofstream reportFile(m_reportFileName.c_str());
+
+    if (!reportFile)
+    {
+        std::cout << "MemoryMonitor: unable to write memory report " << m_reportFileName << std::endl;
+        return;
+    }
+
+    const bool isJson((m_reportFileName.size() > 5) && (m_reportFileName.substr(m_reportFileName.size() - 5) == ".json"));
+    reportFile << (isJson ? "[" : "event,rssBefore,rssPeak,rssAfterProcessing,rssAfterReset,rssRetained,heapBefore,heapAfterProcessing,heapAfterReset,heapRetained")
+               << std::endl;
+
+    bool isFirstEntry(true);
+
+    for (const EventRecord &eventRecord : retainedRecordList)
+    {
+        if (isJson)
+        {
+            reportFile << (isFirstEntry ? "" : ",\n") << "  {\"event\": " << eventRecord.m_event
+                       << ", \"rssMB\": {\"before\": " << eventRecord.m_rssBefore << ", \"peak\": " << eventRecord.m_rssPeak << ", \"afterProcessing\": "
+                       << eventRecord.m_rssAfterProcessing << ", \"afterReset\": " << eventRecord.m_rssAfterReset << ", \"retained\": " << eventRecord.GetRetainedRss() << "}"
+                       << ", \"heapMB\": {\"before\": " << eventRecord.m_heapBefore << ", \"afterProcessing\": " << eventRecord.m_heapAfterProcessing
+                       << ", \"afterReset\": " << eventRecord.m_heapAfterReset << ", \"retained\": " << eventRecord.GetRetainedHeap() << "}}";
+        }
+        else
+        {
+            reportFile << eventRecord.m_event << "," << eventRecord.m_rssBefore << "," << eventRecord.m_rssPeak << "," << eventRecord.m_rssAfterProcessing << ","
+                       << eventRecord.m_rssAfterReset << "," << eventRecord.GetRetainedRss() << "," << eventRecord.m_heapBefore << "," << eventRecord.m_heapAfterProcessing
+                       << "," << eventRecord.m_heapAfterReset << "," << eventRecord.GetRetainedHeap() << std::endl;
+        }
+
+        isFirstEntry = false;
+    }
+
+    if (isJson)
+        reportFile << std::endl << "]" << std::endl;
+
+    std::cout << "MemoryMonitor: written memory report " << m_reportFileName << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+double MemoryMonitor::GetResidentSetSize()
+{
+    // The second field of statm is the number of resident pages
+    std::ifstream statmFile("/proc/self/statm");
+    unsigned long nPages(0), nResidentPages(0);
+
+    if (!(statmFile >> nPages >> nResidentPages))
+        return 0.;
+
+    return static_cast<double>(nResidentPages) * sysconf(_SC_PAGESIZE) / (1024. * 1024.);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+double MemoryMonitor::GetPeakResidentSetSize()
+{
+    std::ifstream statusFile("/proc/self/status");
+    std::string line;
+
+    while (std::getline(statusFile, line))
+    {
+        if (0 != line.compare(0, 6, "VmHWM:"))
+            continue;
+
+        std::istringstream lineStream(line.substr(6));
+        double peakKilobytes(0.);
+        lineStream >> peakKilobytes;
+        return peakKilobytes / 1024.;
+    }
+
+    return 0.;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void MemoryMonitor::ResetPeakResidentSetSize()
+{
+    // Writing 5 to clear_refs resets the peak rss (VmHWM) on linux 4.0 and later; older kernels just report the process peak
+    std::ofstream clearRefsFile("/proc/self/clear_refs");
+
+    if (clearRefsFile)
+        clearRefsFile << "5" << std::endl;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+double MemoryMonitor::GetHeapInUse()
+{
+    // Small allocations in the arenas plus large, directly mapped allocations
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+    const struct mallinfo2 mallocInfo(mallinfo2());
+#else
+    const struct mallinfo mallocInfo(mallinfo());
+#endif
+    return (static_cast<double>(mallocInfo.uordblks) + static_cast<double>(mallocInfo.hblkhd)) / (1024. * 1024.);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+MemoryMonitor::EventRecord::EventRecord() :
+    m_event(0),
+    m_rssBefore(0.),
+    m_rssPeak(0.),
+    m_rssAfterProcessing(0.),
+    m_rssAfterReset(0.),
+    m_heapBefore(0.),
+    m_heapAfterProcessing(0.),
+    m_heapAfterReset(0.)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+double MemoryMonitor::EventRecord::GetRetainedRss() const
+{
+    return (m_rssAfterReset - m_rssBefore);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+double MemoryMonitor::EventRecord::GetRetainedHeap() const
+{
+    return (m_heapAfterReset - m_heapBefore);
+}
+
+} // namespace lar_reco
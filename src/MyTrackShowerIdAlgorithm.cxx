@@ -10,22 +10,29 @@
 
 #include "Pandora/AlgorithmHeaders.h"
 
+#include "larpandoracontent/LArHelpers/LArGeometryHelper.h"
 #include "larpandoracontent/LArHelpers/LArMonitoringHelper.h"
 #include "larpandoracontent/LArHelpers/LArMCParticleHelper.h"
 #include "larpandoracontent/LArHelpers/LArPfoHelper.h"
 #include "larpandoracontent/LArPersistency/EventReadingAlgorithm.h"
 
+#include "TROOT.h"
+
 using namespace lar_content;
 using namespace pandora;
 
 StatusCode MyTrackShowerIdAlgorithm::Run()
 {
-    std::cout << "\n---MyTrackShowerIdAlgorithm-----------------------------------------------------------------------" << std::endl;
-    std::cout << "Processing next event, eventId " << m_EventId << std::endl;
+    LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "\n---MyTrackShowerIdAlgorithm-----------------------------------------------------------------------\n"
+        << "Processing next event, eventId " << m_EventId);
 
-    // Make sure the maps are empty for the next event
+    // Make sure the maps are empty for the next event, and release the working lists of the previous event, all of which are now destroyed
     m_selectiveMap.clear();
     m_pfoToMCHitSharingMap.clear();
+    m_mcToViewHitCountsMap.clear();
+    m_caloHitToFoldedMCMap.clear();
+    m_eventArena.Reset();
+    m_nPfoRecords = 0;
 
     // Input lists
     const PfoList *pInputPfoList(nullptr);
@@ -48,20 +55,38 @@ StatusCode MyTrackShowerIdAlgorithm::Run()
         LArPfoHelper::GetAllConnectedPfos(pPfo, fullPfoList);
 	}
 
+    // Gather the hits of every pfo once, for both the truth matching and the tree writing
+    m_pfoHitCache.Fill(fullPfoList);
+
+    // Image pixels default to the wire pitch of each view, which is only known once the geometry is loaded
+    if (m_hitImageBuilder.IsEnabled())
+    {
+        const HitType viewHitTypes[] = {TPC_VIEW_U, TPC_VIEW_V, TPC_VIEW_W};
+
+        for (unsigned int viewIndex = 0; viewIndex < 3; ++viewIndex)
+        {
+            m_imageWirePitches[viewIndex] = m_hitImageBuilder.GetWirePitch(LArGeometryHelper::GetWirePitch(this->GetPandora(), viewHitTypes[viewIndex]));
+            m_imageDriftPitches[viewIndex] = m_hitImageBuilder.GetDriftPitch(m_imageWirePitches[viewIndex]);
+        }
+    }
+
     // Mapping target MCParticles -> truth associated Hits
+    // The helper maps are lar_content types, so cannot use the arena, but are sized up front to avoid rehashing as they fill
     LArMCParticleHelper::MCContributionMap basicMCParticleToHitsMap;
     LArMCParticleHelper::CaloHitToMCMap caloHitToMCMap;
+    basicMCParticleToHitsMap.reserve(pMCParticleList->size());
+    caloHitToMCMap.reserve(pCaloHitList->size());
     LArMCParticleHelper::GetMCParticleToCaloHitMatches(pCaloHitList, LArMCParticleHelper::MCRelationMap(), caloHitToMCMap, basicMCParticleToHitsMap);
 
     // Mapping PFOs -> reconstructed calohit lists
     LArMCParticleHelper::PfoContributionMap pfoToHitsMap;
+    pfoToHitsMap.reserve(fullPfoList.size());
     this->GetPfoToHitsMap(fullPfoList, pfoToHitsMap);
 
     // Get Neutrino MCParticle
-    MCParticleList incidentMClist;
+    ArenaMCParticleList incidentMClist(m_eventArena);
     this->GetIncidentMCPs(pMCParticleList, incidentMClist);
-    std::cout << "Found " << incidentMClist.size() << " incident MC particles." << std::endl;
-    std::cout << "\nBegin generating MCParticle->CaloHit map." << std::endl;
+    LAR_RECO_LOG_DEBUG(m_logger, "Found " << incidentMClist.size() << " incident MC particles.\n\nBegin generating MCParticle->CaloHit map.");
     float incidentMcEnergy = 0;
     for (const MCParticle *const pMCParticle : incidentMClist) 
     {
@@ -74,19 +99,30 @@ StatusCode MyTrackShowerIdAlgorithm::Run()
             incidentMcEnergy = mcEnergy;
         }
         // Map the MC particles
-        std::cout << "Mapping incident MC particle: ";
-        PrintMCParticle(pMCParticle, basicMCParticleToHitsMap, 0, 0, false);
-        CaloHitList rejectedCaloHitList;
-        this->Mapper(basicMCParticleToHitsMap, pMCParticle, false, 0, rejectedCaloHitList, m_selectiveMap);
+        if (m_logger.IsEnabled(lar_reco::LOG_DEBUG))
+        {
+            std::ostringstream logStream;
+            logStream << "Mapping incident MC particle: ";
+            this->PrintMCParticle(pMCParticle, basicMCParticleToHitsMap, logStream, 0, 0, false);
+            m_logger.Write(logStream.str());
+        }
+        this->Mapper(basicMCParticleToHitsMap, pMCParticle, m_selectiveMap);
+    }
+    this->CountFoldedHits();
+
+    // The truth dumps re-run the hit matching for each primary, so are only built if they will be written
+    if (m_logger.IsEnabled(lar_reco::LOG_DEBUG))
+    {
+        std::ostringstream logStream;
+        logStream << "\nEvent nuance code: " << m_mcNuanceCode << "\nMain incident MC particle: ";
+        this->PrintMCParticle(m_incidentMcp, basicMCParticleToHitsMap, logStream, 0, 0, false);
+        logStream << "MCParticle->CaloHit map:\n";
+        this->PrintMCParticles(m_selectiveMap, logStream, 1);
+        m_logger.Write(logStream.str());
     }
-    std::cout << std::endl << "Event nuance code: " << m_mcNuanceCode << std::endl;
-    std::cout << "Main incident MC particle: ";
-    PrintMCParticle(m_incidentMcp, basicMCParticleToHitsMap, 0, 0, false);
-    std::cout << "MCParticle->CaloHit map:" << std::endl;
-    PrintMCParticles(m_selectiveMap, 1);
 
     // Create hit sharing map
-    std::cout << "\nGenerating PFO<->MCP hit sharing map." << std::endl;
+    LAR_RECO_LOG_DEBUG(m_logger, "\nGenerating PFO<->MCP hit sharing map.");
     LArMCParticleHelper::MCParticleToPfoHitSharingMap mcToPfoHitSharingMap;
     LArMCParticleHelper::GetPfoMCParticleHitSharingMaps(pfoToHitsMap, {m_selectiveMap}, m_pfoToMCHitSharingMap, mcToPfoHitSharingMap);
 
@@ -95,19 +131,23 @@ StatusCode MyTrackShowerIdAlgorithm::Run()
     LArPfoHelper::GetRecoNeutrinos(&fullPfoList, neutrinoPfos);
     if (neutrinoPfos.size()) // Write this event if there is a neutrino PFO
     {
-        std::cout << "\nBegin collecting PFO data..." << std::endl;
-        this->WritePfo(neutrinoPfos.front()); // there should be only one PFO in the list
+        LAR_RECO_LOG_DEBUG(m_logger, "\nBegin collecting PFO data...");
+        this->AddPfoRecords(neutrinoPfos.front()); // there should be only one PFO in the list
     }
     else
     {
-        std::cout << "The event has no reconstructed neutrinos! We're going for single-particle mode!" << std::endl;
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "The event has no reconstructed neutrinos! We're going for single-particle mode!");
 	    unsigned int particleCounter(0);
 	    for (const Pfo *const pSingleParticlePfo : fullPfoList)
 	    {
-           this->WritePfo(pSingleParticlePfo, particleCounter++);
+           this->AddPfoRecords(pSingleParticlePfo, particleCounter++);
 	    }
     }
 
+    // The records are built concurrently, but written in the order they were added, so the output does not depend on the thread count
+    this->WritePfoRecords();
+
+    this->EndOutputEvent();
     m_EventId++;
     return STATUS_CODE_SUCCESS;
 }
@@ -115,22 +155,21 @@ StatusCode MyTrackShowerIdAlgorithm::Run()
 // The original MCParticle helper version collects+filters all downstream hits. We just need a very simplistic map without any merging/filtering.
 void MyTrackShowerIdAlgorithm::GetPfoToHitsMap(const PfoList &pPfoList, LArMCParticleHelper::PfoContributionMap &pfoToHitsMap)
 {
+    const CaloHitVector &caloHits(m_pfoHitCache.GetCaloHits());
+
     for (const ParticleFlowObject *const pPfo : pPfoList)
     {
+        // The U, V and W hits of each pfo are contiguous in the cache
+        const lar_reco::PfoHitCache::HitRange hitRange(m_pfoHitCache.GetTwoDHitRange(pPfo));
         CaloHitList &caloHitList2D(pfoToHitsMap[pPfo]);
-        LArPfoHelper::GetCaloHits(pPfo, TPC_VIEW_U, caloHitList2D);
-        LArPfoHelper::GetCaloHits(pPfo, TPC_VIEW_V, caloHitList2D);
-        LArPfoHelper::GetCaloHits(pPfo, TPC_VIEW_W, caloHitList2D);
-        LArPfoHelper::GetIsolatedCaloHits(pPfo, TPC_VIEW_U, caloHitList2D);
-        LArPfoHelper::GetIsolatedCaloHits(pPfo, TPC_VIEW_V, caloHitList2D);
-        LArPfoHelper::GetIsolatedCaloHits(pPfo, TPC_VIEW_W, caloHitList2D);
+        caloHitList2D.insert(caloHitList2D.end(), caloHits.begin() + hitRange.m_begin, caloHits.begin() + hitRange.m_end);
     }
 }
 
 
 
 // Function which gets all incident MC particles from a list of particles -------------------------------------------------------------------------------------------------------------------------------------------
-void MyTrackShowerIdAlgorithm::GetIncidentMCPs(const MCParticleList *const pMCParticleList, MCParticleList &parentMCNuList)
+void MyTrackShowerIdAlgorithm::GetIncidentMCPs(const MCParticleList *const pMCParticleList, ArenaMCParticleList &parentMCNuList)
 {
     for (const MCParticle *const mCParticle : *pMCParticleList)
     {
@@ -142,63 +181,99 @@ void MyTrackShowerIdAlgorithm::GetIncidentMCPs(const MCParticleList *const pMCPa
 }
 
 // Mapper Function ----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// Folds the hits of every MC particle below pMCParticle into the nearest mapped MC particle, itself or an ancestor, in three linear passes
+// over the flattened hierarchy, without copying any intermediate hit lists. Hits in each selective map list keep the recursive order:
+// the direct hits of the mapped MC particle, then those folded in from each daughter in turn.
 void MyTrackShowerIdAlgorithm::Mapper(
     const LArMCParticleHelper::MCContributionMap &basicMap, 
     const MCParticle *const pMCParticle, 
-    const bool isShowerProduct, 
-    const unsigned int hierarchyTier,
-    CaloHitList &caloHitsToMerge, 
     LArMCParticleHelper::MCContributionMap &selectiveMap)
 {
-    // Get MCParticle PDGCode.
-    int PDGCode = std::abs(pMCParticle->GetParticleId());
+    // Flatten the hierarchy in depth-first pre-order, using an explicit stack, so that every subtree is a contiguous run after its root
+    MCFoldingNodeVector nodes(m_eventArena);
+    std::vector<std::pair<const MCParticle*, int>, lar_reco::ArenaAllocator<std::pair<const MCParticle*, int>>> stack(m_eventArena);
+    stack.emplace_back(pMCParticle, -1);
 
-    // Looping over every daughterMCParticle.
-    CaloHitList returnedCaloHits;
-    for (const MCParticle *const pMCDaughter : pMCParticle->GetDaughterList())
+    while (!stack.empty())
     {
-        // Run mapper on daughterMCParticles, setting isShowerProduct to true if the parent is a shower particle.
-        Mapper(basicMap, pMCDaughter, (PDGCode == E_MINUS || PDGCode == PHOTON || isShowerProduct), hierarchyTier + 1, returnedCaloHits, selectiveMap);
+        const MCParticle *const pNodeMCParticle(stack.back().first);
+        const int parentIndex(stack.back().second);
+        stack.pop_back();
+
+        MCFoldingNode node;
+        node.m_pMCParticle = pNodeMCParticle;
+        node.m_parentIndex = parentIndex;
+        node.m_hierarchyTier = 0;
+        node.m_isShowerProduct = false;
+        node.m_isMapped = false;
+        node.m_pTargetCaloHits = nullptr;
+
+        if (parentIndex >= 0)
+        {
+            // A daughter is a shower product if its parent is a shower particle, or is itself a shower product
+            const MCFoldingNode &parentNode(nodes.at(parentIndex));
+            const int parentPdgCode(std::abs(parentNode.m_pMCParticle->GetParticleId()));
+            node.m_hierarchyTier = parentNode.m_hierarchyTier + 1;
+            node.m_isShowerProduct = (parentPdgCode == E_MINUS || parentPdgCode == PHOTON || parentNode.m_isShowerProduct);
+        }
+
+        const LArMCParticleHelper::MCContributionMap::const_iterator basicIter(basicMap.find(pNodeMCParticle));
+        node.m_pDirectCaloHits = ((basicMap.end() != basicIter) ? &basicIter->second : nullptr);
+        node.m_nCaloHits = (node.m_pDirectCaloHits ? node.m_pDirectCaloHits->size() : 0);
+        nodes.push_back(node);
+
+        // Push daughters in reverse, so that they are visited in list order
+        const MCParticleList &daughterList(pNodeMCParticle->GetDaughterList());
+        const int nodeIndex(nodes.size() - 1);
+
+        for (MCParticleList::const_reverse_iterator daughterIter = daughterList.rbegin(); daughterIter != daughterList.rend(); ++daughterIter)
+            stack.emplace_back(*daughterIter, nodeIndex);
     }
 
-    // Get the direct MCParticle calohits.
-    CaloHitList mCPCaloHits;
-    if (basicMap.count(pMCParticle) == 1)
+    // Visit daughters before parents, so that each MC particle's hit count includes those folded in from its unmapped descendants
+    for (int nodeIndex = static_cast<int>(nodes.size()) - 1; nodeIndex >= 0; --nodeIndex)
     {
-        mCPCaloHits = basicMap.at(pMCParticle);
+        MCFoldingNode &node(nodes.at(nodeIndex));
+        node.m_isMapped = this->IsMapped(node);
+
+        if (!node.m_isMapped && (node.m_parentIndex >= 0))
+            nodes.at(node.m_parentIndex).m_nCaloHits += node.m_nCaloHits;
     }
 
-    std::back_insert_iterator<CaloHitList> caloHits_back_inserter = std::back_inserter(caloHitsToMerge);
-    // MC particle is mapped only if it has enough hits and is not a shower product. Exceptions are made for neutrino primaries and non-neutrino incident particles.
-    const unsigned int nCalohits = returnedCaloHits.size() + mCPCaloHits.size();
-    if (
-        (hierarchyTier == 0 && nCalohits > 0 && !LArMCParticleHelper::IsNeutrino(pMCParticle)) || 
-        (hierarchyTier == 1 && nCalohits > 0 && LArMCParticleHelper::IsNeutrino(pMCParticle->GetParentList().front())) || 
-        (!isShowerProduct && nCalohits > m_mcMappingMinHits)
-    )
+    // Visit parents before daughters, appending each MC particle's direct hits to the list of its nearest mapped MC particle, if any
+    for (MCFoldingNode &node : nodes)
     {
-        // Add this MCParticle and its hits to the map (instead of adding to a list of hits to be merged)
-        caloHits_back_inserter = std::back_inserter(selectiveMap[pMCParticle]);
+        node.m_pTargetCaloHits = (node.m_isMapped ? &selectiveMap[node.m_pMCParticle] :
+            (node.m_parentIndex >= 0) ? nodes.at(node.m_parentIndex).m_pTargetCaloHits : nullptr);
+
+        if (node.m_pTargetCaloHits && node.m_pDirectCaloHits)
+            node.m_pTargetCaloHits->insert(node.m_pTargetCaloHits->end(), node.m_pDirectCaloHits->begin(), node.m_pDirectCaloHits->end());
     }
-    // Copy the direct hits if available
-    std::copy(mCPCaloHits.begin(), mCPCaloHits.end(), caloHits_back_inserter);
-    // Copy the hits that were returned from daughters (i.e. consider them as indirect hits, merge them with this MCParticle)
-    std::copy(returnedCaloHits.begin(), returnedCaloHits.end(), caloHits_back_inserter);
+}
+
+// MC particle is mapped only if it has enough hits and is not a shower product. Exceptions are made for neutrino primaries and non-neutrino incident particles.
+bool MyTrackShowerIdAlgorithm::IsMapped(const MCFoldingNode &node) const
+{
+    const unsigned int nCalohits(node.m_nCaloHits);
+    return (
+        (node.m_hierarchyTier == 0 && nCalohits > 0 && !LArMCParticleHelper::IsNeutrino(node.m_pMCParticle)) || 
+        (node.m_hierarchyTier == 1 && nCalohits > 0 && LArMCParticleHelper::IsNeutrino(node.m_pMCParticle->GetParentList().front())) || 
+        (!node.m_isShowerProduct && nCalohits > m_mcMappingMinHits)
+    );
 }
 //---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-void MyTrackShowerIdAlgorithm::GetBestMatchedMCParticleInfo(const ParticleFlowObject *const pPfo, ViewHits &UView, ViewHits &VView, ViewHits &WView)
+void MyTrackShowerIdAlgorithm::GetBestMatchedMCParticleInfo(const ParticleFlowObject *const pPfo, PfoRecord &record) const
 {
-    int bestMCParticlePdgCode(0);
-    unsigned int nHitsSharedWithBestMCParticleTotal(0);
     const LArMCParticleHelper::MCParticleToSharedHitsVector &mcParticleToSharedHitsVector(m_pfoToMCHitSharingMap.at(pPfo));
+    ViewHits &UView(record.m_UViewHits), &VView(record.m_VViewHits), &WView(record.m_WViewHits);
 
     // Clear all MC variables
-    m_mcPdgCode = 0;
-    m_mcpMomentum = 0;
-    m_mcHierarchyTier = 0;
-    m_mcParentPdgCode = 0;
-    m_pMcDaughterPdgCodes->clear();
+    record.m_mcPdgCode = 0;
+    record.m_mcpMomentum = 0;
+    record.m_mcHierarchyTier = 0;
+    record.m_mcParentPdgCode = 0;
+    record.m_pMcDaughterPdgCodes->clear();
     UView.nHitsMatch = 0;
     UView.nHitsMcp = 0;    
     VView.nHitsMatch = 0;
@@ -206,45 +281,113 @@ void MyTrackShowerIdAlgorithm::GetBestMatchedMCParticleInfo(const ParticleFlowOb
     WView.nHitsMatch = 0;
     WView.nHitsMcp = 0;
 
-    for (const LArMCParticleHelper::MCParticleCaloHitListPair pMCParticleCaloHitListPair : mcParticleToSharedHitsVector)
+    // The best matched MCParticle is the first with the most shared hits; list sizes are constant time, so this is a single pass over candidates
+    const MCParticle *pBestMCParticle(nullptr);
+    unsigned int nHitsSharedWithBestMCParticleTotal(0);
+
+    for (const LArMCParticleHelper::MCParticleCaloHitListPair &mcParticleCaloHitListPair : mcParticleToSharedHitsVector)
     {
-        const MCParticle *const pMCParticle(pMCParticleCaloHitListPair.first);
-        const CaloHitList &allMCHits(m_selectiveMap.at(pMCParticleCaloHitListPair.first));
-        const CaloHitList &associatedMCHits(pMCParticleCaloHitListPair.second); 
-        if (associatedMCHits.size() > nHitsSharedWithBestMCParticleTotal)
+        if (mcParticleCaloHitListPair.second.size() > nHitsSharedWithBestMCParticleTotal)
         {
-            // This is the current best matched MCParticle, to be stored.
-            nHitsSharedWithBestMCParticleTotal = associatedMCHits.size();
-            bestMCParticlePdgCode = pMCParticle->GetParticleId();
-
-            m_mcPdgCode = bestMCParticlePdgCode;
-            m_mcpMomentum = pMCParticle->GetMomentum().GetMagnitude();
-            m_mcHierarchyTier = LArMCParticleHelper::GetHierarchyTier(pMCParticle);
-
-            m_mcParentPdgCode = 0;
-            m_pMcDaughterPdgCodes->clear();
-            const MCParticleList parentMCParticles(pMCParticle->GetParentList());
-            if (parentMCParticles.size() == 1)
+            nHitsSharedWithBestMCParticleTotal = mcParticleCaloHitListPair.second.size();
+            pBestMCParticle = mcParticleCaloHitListPair.first;
+        }
+    }
+
+    if (!pBestMCParticle)
+        return;
+
+    record.m_mcPdgCode = pBestMCParticle->GetParticleId();
+    record.m_mcpMomentum = pBestMCParticle->GetMomentum().GetMagnitude();
+    record.m_mcHierarchyTier = LArMCParticleHelper::GetHierarchyTier(pBestMCParticle);
+
+    const MCParticleList &parentMCParticles(pBestMCParticle->GetParentList());
+    if (parentMCParticles.size() == 1)
+    {
+        record.m_mcParentPdgCode = parentMCParticles.front()->GetParticleId();
+    }
+    for (const MCParticle *const pMCDaughter : pBestMCParticle->GetDaughterList())
+    {
+        record.m_pMcDaughterPdgCodes->push_back(pMCDaughter->GetParticleId());
+    }
+
+    // Per-view hit counts for the folded MCParticle are precomputed for the event, and shared counts are found in one pass over the pfo hits
+    const ViewHitCounts &mcViewHitCounts(m_mcToViewHitCountsMap.at(pBestMCParticle));
+    const ViewHitCounts sharedViewHitCounts(this->CountSharedHits(pPfo, pBestMCParticle));
+
+    UView.nHitsMatch = sharedViewHitCounts.at(0);
+    UView.nHitsMcp = mcViewHitCounts.at(0);
+    VView.nHitsMatch = sharedViewHitCounts.at(1);
+    VView.nHitsMcp = mcViewHitCounts.at(1);
+    WView.nHitsMatch = sharedViewHitCounts.at(2);
+    WView.nHitsMcp = mcViewHitCounts.at(2);
+}
+
+// Counts the hits of each folded MCParticle by view, and records the folded MCParticles to which each hit belongs, once per event
+void MyTrackShowerIdAlgorithm::CountFoldedHits()
+{
+    unsigned int nFoldedHits(0);
+
+    for (const LArMCParticleHelper::MCContributionMap::value_type &mcParticleCaloHitListPair : m_selectiveMap)
+        nFoldedHits += mcParticleCaloHitListPair.second.size();
+
+    m_caloHitToFoldedMCMap.reserve(nFoldedHits);
+
+    for (const LArMCParticleHelper::MCContributionMap::value_type &mcParticleCaloHitListPair : m_selectiveMap)
+    {
+        const MCParticle *const pMCParticle(mcParticleCaloHitListPair.first);
+        ViewHitCounts &viewHitCounts(m_mcToViewHitCountsMap[pMCParticle]);
+        viewHitCounts.fill(0);
+
+        for (const CaloHit *const pCaloHit : mcParticleCaloHitListPair.second)
+        {
+            const HitType hitType(pCaloHit->GetHitType());
+
+            if ((TPC_VIEW_U != hitType) && (TPC_VIEW_V != hitType) && (TPC_VIEW_W != hitType))
+                continue;
+
+            ++viewHitCounts.at((TPC_VIEW_U == hitType) ? 0 : (TPC_VIEW_V == hitType) ? 1 : 2);
+
+            // A hit reached through more than one path in the MC hierarchy is recorded once per MCParticle, as the hit sharing map counts it
+            const auto range(m_caloHitToFoldedMCMap.equal_range(pCaloHit));
+
+            if (range.second == std::find_if(range.first, range.second,
+                [pMCParticle](const CaloHitToMCParticlesMap::value_type &entry) {return (entry.second == pMCParticle);}))
             {
-                m_mcParentPdgCode = parentMCParticles.front()->GetParticleId();
+                m_caloHitToFoldedMCMap.emplace(pCaloHit, pMCParticle);
             }
-            for (const MCParticle *const pMCDaughter : pMCParticle->GetDaughterList())
+        }
+    }
+}
+
+// Counts the hits of a pfo, by view, that were folded into a given MCParticle, i.e. the per-view sizes of their shared hit list
+MyTrackShowerIdAlgorithm::ViewHitCounts MyTrackShowerIdAlgorithm::CountSharedHits(const ParticleFlowObject *const pPfo, const MCParticle *const pMCParticle) const
+{
+    static const HitType viewHitTypes[] = {TPC_VIEW_U, TPC_VIEW_V, TPC_VIEW_W};
+    ViewHitCounts sharedViewHitCounts;
+    sharedViewHitCounts.fill(0);
+
+    for (unsigned int viewIndex = 0; viewIndex < sharedViewHitCounts.size(); ++viewIndex)
+    {
+        const lar_reco::PfoHitCache::HitRange hitRange(m_pfoHitCache.GetHitRange(pPfo, viewHitTypes[viewIndex]));
+
+        for (unsigned int hitIndex = hitRange.m_begin; hitIndex < hitRange.m_end; ++hitIndex)
+        {
+            const auto range(m_caloHitToFoldedMCMap.equal_range(m_pfoHitCache.GetCaloHits().at(hitIndex)));
+
+            for (auto iter = range.first; iter != range.second; ++iter)
             {
-                m_pMcDaughterPdgCodes->push_back(pMCDaughter->GetParticleId());
+                if (iter->second == pMCParticle)
+                    ++sharedViewHitCounts.at(viewIndex);
             }
-
-            UView.nHitsMatch = LArMonitoringHelper::CountHitsByType(TPC_VIEW_U, associatedMCHits);
-            UView.nHitsMcp = LArMonitoringHelper::CountHitsByType(TPC_VIEW_U, allMCHits);
-            VView.nHitsMatch = LArMonitoringHelper::CountHitsByType(TPC_VIEW_V, associatedMCHits);
-            VView.nHitsMcp = LArMonitoringHelper::CountHitsByType(TPC_VIEW_V, allMCHits);  
-            WView.nHitsMatch = LArMonitoringHelper::CountHitsByType(TPC_VIEW_W, associatedMCHits);
-            WView.nHitsMcp = LArMonitoringHelper::CountHitsByType(TPC_VIEW_W, allMCHits);
         }
     }
+
+    return sharedViewHitCounts;
 }
 
 //Copied from MCParticle Monitoring Algorithm----------------------------------------------------------------------------------------------------------------------------------------------------------------
-void MyTrackShowerIdAlgorithm::PrintMCParticles(const LArMCParticleHelper::MCContributionMap &mcContributionMap, const unsigned int minHits) const
+void MyTrackShowerIdAlgorithm::PrintMCParticles(const LArMCParticleHelper::MCContributionMap &mcContributionMap, std::ostream &stream, const unsigned int minHits) const
 {
     MCParticleVector mcPrimaryVector;
     LArMonitoringHelper::GetOrderedMCParticleVector({mcContributionMap}, mcPrimaryVector);
@@ -257,17 +400,17 @@ void MyTrackShowerIdAlgorithm::PrintMCParticles(const LArMCParticleHelper::MCCon
 
         if (caloHitList.size() >= minHits)
         {
-            std::cout << std::endl << "--Primary " << index << ", MCPDG " << pMCPrimary->GetParticleId() << ", Energy " << pMCPrimary->GetEnergy()
-                      << ", Dist. " << (pMCPrimary->GetEndpoint() - pMCPrimary->GetVertex()).GetMagnitude() << ", nMCHits " << caloHitList.size()
-                      << " (" << LArMonitoringHelper::CountHitsByType(TPC_VIEW_U, caloHitList)
-                      << ", " << LArMonitoringHelper::CountHitsByType(TPC_VIEW_V, caloHitList)
-                      << ", " << LArMonitoringHelper::CountHitsByType(TPC_VIEW_W, caloHitList) << ")" << std::endl;
+            stream << "\n--Primary " << index << ", MCPDG " << pMCPrimary->GetParticleId() << ", Energy " << pMCPrimary->GetEnergy()
+                 << ", Dist. " << (pMCPrimary->GetEndpoint() - pMCPrimary->GetVertex()).GetMagnitude() << ", nMCHits " << caloHitList.size()
+                 << " (" << LArMonitoringHelper::CountHitsByType(TPC_VIEW_U, caloHitList)
+                 << ", " << LArMonitoringHelper::CountHitsByType(TPC_VIEW_V, caloHitList)
+                 << ", " << LArMonitoringHelper::CountHitsByType(TPC_VIEW_W, caloHitList) << ")\n";
 
             LArMCParticleHelper::MCRelationMap mcToPrimaryMCMap;
             LArMCParticleHelper::CaloHitToMCMap caloHitToPrimaryMCMap;
             LArMCParticleHelper::MCContributionMap mcToTrueHitListMap;
             LArMCParticleHelper::GetMCParticleToCaloHitMatches(&caloHitList, mcToPrimaryMCMap, caloHitToPrimaryMCMap, mcToTrueHitListMap);
-            this->PrintMCParticle(pMCPrimary, mcToTrueHitListMap, 1, minHits);
+            this->PrintMCParticle(pMCPrimary, mcToTrueHitListMap, stream, 1, minHits);
         }
 
         ++index;
@@ -276,7 +419,7 @@ void MyTrackShowerIdAlgorithm::PrintMCParticles(const LArMCParticleHelper::MCCon
 
 //Copied from MCParticle Monitoring Algorithm----------------------------------------------------------------------------------------------------------------------------------------------------------------
 void MyTrackShowerIdAlgorithm::PrintMCParticle(const MCParticle *const pMCParticle, const LArMCParticleHelper::MCContributionMap &mcToTrueHitListMap,
-    const unsigned int depth, const unsigned int minHits, const bool printDaughters) const
+    std::ostream &stream, const unsigned int depth, const unsigned int minHits, const bool printDaughters) const
 {
     const CaloHitList &caloHitList(mcToTrueHitListMap.count(pMCParticle) ? mcToTrueHitListMap.at(pMCParticle) : CaloHitList());
 
@@ -284,20 +427,20 @@ void MyTrackShowerIdAlgorithm::PrintMCParticle(const MCParticle *const pMCPartic
     {
         if (depth > 1)
         {
-            for (int iDepth = 1; iDepth < depth - 1; ++iDepth) std::cout << "   ";
-            std::cout << "\\_ ";
+            for (int iDepth = 1; iDepth < depth - 1; ++iDepth) stream << "   ";
+            stream << "\\_ ";
         }
 
-        std::cout << "MCPDG " << pMCParticle->GetParticleId() << ", Energy " << pMCParticle->GetEnergy()
-                  << ", Dist. " << (pMCParticle->GetEndpoint() - pMCParticle->GetVertex()).GetMagnitude() << ", nMCHits " << caloHitList.size()
-                  << " (" << LArMonitoringHelper::CountHitsByType(TPC_VIEW_U, caloHitList)
-                  << ", " << LArMonitoringHelper::CountHitsByType(TPC_VIEW_V, caloHitList)
-                  << ", " << LArMonitoringHelper::CountHitsByType(TPC_VIEW_W, caloHitList) << ")" << std::endl;
+        stream << "MCPDG " << pMCParticle->GetParticleId() << ", Energy " << pMCParticle->GetEnergy()
+               << ", Dist. " << (pMCParticle->GetEndpoint() - pMCParticle->GetVertex()).GetMagnitude() << ", nMCHits " << caloHitList.size()
+               << " (" << LArMonitoringHelper::CountHitsByType(TPC_VIEW_U, caloHitList)
+               << ", " << LArMonitoringHelper::CountHitsByType(TPC_VIEW_V, caloHitList)
+               << ", " << LArMonitoringHelper::CountHitsByType(TPC_VIEW_W, caloHitList) << ")\n";
     }
     if (printDaughters)
     {
         for (const MCParticle *const pDaughterParticle : pMCParticle->GetDaughterList())
-            this->PrintMCParticle(pDaughterParticle, mcToTrueHitListMap, depth + 1);
+            this->PrintMCParticle(pDaughterParticle, mcToTrueHitListMap, stream, depth + 1);
     }
 }
 
@@ -310,128 +453,445 @@ int parentPfoId				// The PFO may have a parent, this is its PFO ID. If the PFO
 int hierarchyTier			// The hierarchy tier of the PFO, e.g. the neutrino is tier 0, its daughters are tier 1, daughters of its daughters are tier 2, etc.
 
 What it does:
-Writes the PFO to the ROOT tree.
-If the PFO has descendants (say n descendants) these are also written to the ROOT tree, and are allocated the PFO IDs from (pfoId + 1) to (pfoId + n).
+Adds a record for the PFO, to be built and written to the ROOT tree by WritePfoRecords.
+If the PFO has descendants (say n descendants) their records are added first, and are allocated the PFO IDs from (pfoId + 1) to (pfoId + n).
 
 Returns:
-int: the total number of PFOs written, i.e. returns the value n + 1.
+int: the total number of records added, i.e. returns the value n + 1.
 */
 
-unsigned int MyTrackShowerIdAlgorithm::WritePfo(const ParticleFlowObject *const pPfo ,const unsigned int pfoId, const int parentPfoId, const unsigned int hierarchyTier)
+unsigned int MyTrackShowerIdAlgorithm::AddPfoRecords(const ParticleFlowObject *const pPfo, const unsigned int pfoId, const int parentPfoId, const unsigned int hierarchyTier)
 {
     IntVector daughterPfoIds;	// daughterPfoIds = [empty vector of integers].
-    unsigned int pfosWritten(0);		// pfosWritten = 0.
+    unsigned int pfosAdded(0);		// pfosAdded = 0.
 
     for (const ParticleFlowObject *const daughterPfo : pPfo->GetDaughterPfoList()) // for each daughterPfo in pPfo.daughterPfos:
     {
-        unsigned int daughterPfoId(pfoId + pfosWritten + 1); // daughterPfoId = pfoId + pfosWritten + 1
+        unsigned int daughterPfoId(pfoId + pfosAdded + 1); // daughterPfoId = pfoId + pfosAdded + 1
         daughterPfoIds.push_back(daughterPfoId); // put daughterPfoId into daughterPfoIds
-        pfosWritten += this->WritePfo(daughterPfo, daughterPfoId, pfoId, hierarchyTier + 1); // pfosWritten += WritePfo(daughterPfoId, pfoId, daughterPfo)
+        pfosAdded += this->AddPfoRecords(daughterPfo, daughterPfoId, pfoId, hierarchyTier + 1); // pfosAdded += AddPfoRecords(daughterPfoId, pfoId, daughterPfo)
     }
 
-    std::cout << std::endl << "Writing a PFO to the tree, pfoId " << pfoId << ", hierarchyTier " << hierarchyTier << ", parentPfoId " << parentPfoId;
-    if (daughterPfoIds.size() > 0)
+    PfoRecord &record(this->GetNextPfoRecord());
+    record.m_pPfo = pPfo;
+    record.m_pfoId = pfoId;
+    record.m_parentPfoId = parentPfoId;
+    record.m_hierarchyTier = hierarchyTier;
+    record.m_pDaughterPfoIds->assign(daughterPfoIds.begin(), daughterPfoIds.end());
+
+    pfosAdded += 1;
+    return pfosAdded;	// return pfosAdded += 1.
+}
+
+MyTrackShowerIdAlgorithm::PfoRecord &MyTrackShowerIdAlgorithm::GetNextPfoRecord()
+{
+    if (m_nPfoRecords == m_pfoRecords.size())
+        m_pfoRecords.emplace_back(new PfoRecord());
+
+    return *m_pfoRecords.at(m_nPfoRecords++);
+}
+
+void MyTrackShowerIdAlgorithm::WritePfoRecords()
+{
+    if (m_pPfoTaskPool && (m_nPfoRecords > 1))
     {
-        std::cout << ", daughterPfoIds ";
-        for (unsigned int daughterPfoId : daughterPfoIds)
+        m_pPfoTaskPool->Run(m_nPfoRecords, [this](const unsigned int iTask, const unsigned int iWorker)
         {
-            std::cout << daughterPfoId << " ";
-        }
+            this->BuildPfoRecord(*m_pfoRecords[iTask], m_recordWorkspaces[iWorker]);
+        });
+    }
+    else
+    {
+        for (unsigned int iRecord = 0; iRecord < m_nPfoRecords; ++iRecord)
+            this->BuildPfoRecord(*m_pfoRecords.at(iRecord), m_recordWorkspaces.front());
     }
-    std::cout << std::endl;
 
-    m_ParentPfoId = parentPfoId; // Write parentPfoId to ROOT tree
-    m_PfoId = pfoId; // Write pfoId to ROOT tree
-    m_pDaughterPfoIds = &daughterPfoIds; // Write daughterPfoIds to ROOT tree
-    m_HierarchyTier = hierarchyTier; // Write hierarchyTier to ROOT tree
-    
-    // Write all other properties of pPFO to ROOT tree
-    this->GetCaloHitInfo(pPfo, TPC_VIEW_U, m_UViewHits);
-    this->GetCaloHitInfo(pPfo, TPC_VIEW_V, m_VViewHits);
-    this->GetCaloHitInfo(pPfo, TPC_VIEW_W, m_WViewHits);
-    this->GetCaloHitInfo(pPfo, TPC_3D, m_ThreeDViewHits);
-    std::cout << "Got calohits from U,V,W,3D views." << std::endl;
-    if (m_UViewHits.pXCoord->size() + m_VViewHits.pXCoord->size() + m_WViewHits.pXCoord->size() == 0)
+    for (unsigned int iRecord = 0; iRecord < m_nPfoRecords; ++iRecord)
+        this->FillPfoRecord(*m_pfoRecords.at(iRecord));
+}
+
+void MyTrackShowerIdAlgorithm::BuildPfoRecord(PfoRecord &record, RecordWorkspace &workspace) const
+{
+    const ParticleFlowObject *const pPfo(record.m_pPfo);
+
+    // Read the vertex first, as the hits may be ordered by their distance from it
+    record.m_hasVertex = false;
+    try
+    {
+        const Vertex *vertex(LArPfoHelper::GetVertex(pPfo));
+        const CartesianVector &vertexPosition(vertex->GetPosition());
+        record.m_vertex[0] = vertexPosition.GetX();
+        record.m_vertex[1] = vertexPosition.GetY();
+        record.m_vertex[2] = vertexPosition.GetZ();
+        record.m_hasVertex = true;
+    }
+    catch (const StatusCodeException &)
+    {
+    }
+
+    const CartesianVector vertexPosition(record.m_vertex[0], record.m_vertex[1], record.m_vertex[2]);
+    const CartesianVector *const pVertexPosition(record.m_hasVertex ? &vertexPosition : nullptr);
+
+    this->GetCaloHitInfo(pPfo, TPC_VIEW_U, record.m_UViewHits, workspace.m_hitOrdering, pVertexPosition);
+    this->GetCaloHitInfo(pPfo, TPC_VIEW_V, record.m_VViewHits, workspace.m_hitOrdering, pVertexPosition);
+    this->GetCaloHitInfo(pPfo, TPC_VIEW_W, record.m_WViewHits, workspace.m_hitOrdering, pVertexPosition);
+    this->GetCaloHitInfo(pPfo, TPC_3D, record.m_ThreeDViewHits, workspace.m_hitOrdering, pVertexPosition);
+    if (record.m_UViewHits.pXCoord->size() + record.m_VViewHits.pXCoord->size() + record.m_WViewHits.pXCoord->size() == 0)
     {
         // The PFO contains no calohits, so this is a reconstructed neutrino PFO. We retrieve the neutrino MCP info.
-        m_mcpMomentum = m_incidentMcp->GetMomentum().GetMagnitude();
-        m_mcPdgCode = m_incidentMcp->GetParticleId();
-        m_mcParentPdgCode = 0;
+        // Every truth value is set, as records are reused and would otherwise keep those of an earlier PFO
+        record.m_mcpMomentum = m_incidentMcp->GetMomentum().GetMagnitude();
+        record.m_mcPdgCode = m_incidentMcp->GetParticleId();
+        record.m_mcHierarchyTier = 0;
+        record.m_mcParentPdgCode = 0;
+        record.m_pMcDaughterPdgCodes->clear();
         for (const MCParticle *const pMCDaughter : m_incidentMcp->GetDaughterList())
         {
-            m_pMcDaughterPdgCodes->push_back(pMCDaughter->GetParticleId());
+            record.m_pMcDaughterPdgCodes->push_back(pMCDaughter->GetParticleId());
         }
-        m_UViewHits.nHitsMatch = 0;
-        m_UViewHits.nHitsMcp = 0;    
-        m_VViewHits.nHitsMatch = 0;
-        m_VViewHits.nHitsMcp = 0;
-        m_WViewHits.nHitsMatch = 0;
-        m_WViewHits.nHitsMcp = 0;
+        record.m_UViewHits.nHitsMatch = 0;
+        record.m_UViewHits.nHitsMcp = 0;
+        record.m_VViewHits.nHitsMatch = 0;
+        record.m_VViewHits.nHitsMcp = 0;
+        record.m_WViewHits.nHitsMatch = 0;
+        record.m_WViewHits.nHitsMcp = 0;
     }
     else
     {
-        this->GetBestMatchedMCParticleInfo(pPfo, m_UViewHits, m_VViewHits, m_WViewHits);
-        if (m_mcPdgCode) {
-            std::cout << "Got best matching MC Particle: mcPdgCode " << m_mcPdgCode << ", mcpMomentum " << m_mcpMomentum << ", mcHierarchyTier " << m_mcHierarchyTier << std::endl;
+        this->GetBestMatchedMCParticleInfo(pPfo, record);
+    }
+
+    if (workspace.m_pfoFeatureBuilder.IsEnabled())
+    {
+        // The hits of the pfo have just been copied, so are still in cache
+        const ViewHits &threeDViewHits(record.m_ThreeDViewHits);
+        workspace.m_pfoFeatureBuilder.ComputeThreeD(threeDViewHits.pXCoord->data(), threeDViewHits.pYCoord->data(), threeDViewHits.pZCoord->data(),
+            threeDViewHits.pEnergy->data(), threeDViewHits.pXCoord->size(), record.m_hasVertex ? record.m_vertex : nullptr, record.m_ThreeDFeatures);
+        this->ComputeViewFeatures(record.m_UViewHits, TPC_VIEW_U, pVertexPosition, workspace.m_pfoFeatureBuilder, record.m_UFeatures);
+        this->ComputeViewFeatures(record.m_VViewHits, TPC_VIEW_V, pVertexPosition, workspace.m_pfoFeatureBuilder, record.m_VFeatures);
+        this->ComputeViewFeatures(record.m_WViewHits, TPC_VIEW_W, pVertexPosition, workspace.m_pfoFeatureBuilder, record.m_WFeatures);
+    }
+
+    if (workspace.m_hitImageBuilder.IsEnabled())
+    {
+        HitImage *const hitImages[] = {&record.m_UHitImage, &record.m_VHitImage, &record.m_WHitImage};
+
+        for (unsigned int viewIndex = 0; viewIndex < 3; ++viewIndex)
+        {
+            hitImages[viewIndex]->driftPitch = m_imageDriftPitches[viewIndex];
+            hitImages[viewIndex]->wirePitch = m_imageWirePitches[viewIndex];
         }
-        else
+
+        this->BuildHitImage(record.m_UViewHits, TPC_VIEW_U, pVertexPosition, workspace.m_hitImageBuilder, record.m_UHitImage);
+        this->BuildHitImage(record.m_VViewHits, TPC_VIEW_V, pVertexPosition, workspace.m_hitImageBuilder, record.m_VHitImage);
+        this->BuildHitImage(record.m_WViewHits, TPC_VIEW_W, pVertexPosition, workspace.m_hitImageBuilder, record.m_WHitImage);
+    }
+}
+
+void MyTrackShowerIdAlgorithm::FillPfoRecord(PfoRecord &record)
+{
+    if (m_logger.IsEnabled(lar_reco::LOG_DEBUG))
+    {
+        std::ostringstream logStream;
+        logStream << "\nWriting a PFO to the tree, pfoId " << record.m_pfoId << ", hierarchyTier " << record.m_hierarchyTier << ", parentPfoId " << record.m_parentPfoId;
+        if (record.m_pDaughterPfoIds->size() > 0)
         {
-            std::cout << "Could not find a matching MC particle for this PFO!" << std::endl;
-        } 
+            logStream << ", daughterPfoIds ";
+            for (unsigned int daughterPfoId : *record.m_pDaughterPfoIds)
+            {
+                logStream << daughterPfoId << " ";
+            }
+        }
+        logStream << "\n";
+        m_logger.Write(logStream.str());
     }
 
-    try
+    // The vectors are swapped rather than copied, the record keeping those of the previous pfo for reuse; the outputs read the vectors
+    // through the bound pointers, so follow the swap
+    m_ParentPfoId = record.m_parentPfoId; // Write parentPfoId to ROOT tree
+    m_PfoId = record.m_pfoId; // Write pfoId to ROOT tree
+    std::swap(m_pDaughterPfoIds, record.m_pDaughterPfoIds); // Write daughterPfoIds to ROOT tree
+    m_HierarchyTier = record.m_hierarchyTier; // Write hierarchyTier to ROOT tree
+
+    // Write all other properties of pPFO to ROOT tree; without a vertex, the vertex of the previous pfo is written, as before records
+    if (record.m_hasVertex)
     {
-        const Vertex *vertex(LArPfoHelper::GetVertex(pPfo));
-        const CartesianVector &vertexPosition(vertex->GetPosition());
-        m_Vertex[0] = vertexPosition.GetX();
-        m_Vertex[1] = vertexPosition.GetY();
-        m_Vertex[2] = vertexPosition.GetZ();
-        std::cout << "Got the PFO vertex." << std::endl;
+        m_Vertex[0] = record.m_vertex[0];
+        m_Vertex[1] = record.m_vertex[1];
+        m_Vertex[2] = record.m_vertex[2];
+        LAR_RECO_LOG_DEBUG(m_logger, "Got the PFO vertex.");
     }
-    catch (const StatusCodeException &)
+    else
+    {
+        LAR_RECO_LOG_DEBUG(m_logger, "A vertex was not found for this PFO!");
+    }
+
+    std::swap(m_UViewHits, record.m_UViewHits);
+    std::swap(m_VViewHits, record.m_VViewHits);
+    std::swap(m_WViewHits, record.m_WViewHits);
+    std::swap(m_ThreeDViewHits, record.m_ThreeDViewHits);
+    LAR_RECO_LOG_DEBUG(m_logger, "Got calohits from U,V,W,3D views.");
+
+    m_mcPdgCode = record.m_mcPdgCode;
+    m_mcpMomentum = record.m_mcpMomentum;
+    m_mcHierarchyTier = record.m_mcHierarchyTier;
+    m_mcParentPdgCode = record.m_mcParentPdgCode;
+    std::swap(m_pMcDaughterPdgCodes, record.m_pMcDaughterPdgCodes);
+    if (m_mcPdgCode) {
+        LAR_RECO_LOG_DEBUG(m_logger, "Got best matching MC Particle: mcPdgCode " << m_mcPdgCode << ", mcpMomentum " << m_mcpMomentum << ", mcHierarchyTier " << m_mcHierarchyTier);
+    }
+    else
+    {
+        LAR_RECO_LOG_DEBUG(m_logger, "Could not find a matching MC particle for this PFO!");
+    }
+
+    if (m_pfoFeatureBuilder.IsEnabled())
+    {
+        m_UFeatures = record.m_UFeatures;
+        m_VFeatures = record.m_VFeatures;
+        m_WFeatures = record.m_WFeatures;
+        m_ThreeDFeatures = record.m_ThreeDFeatures;
+        LAR_RECO_LOG_DEBUG(m_logger, "Computed the PFO features, 3D length " << m_ThreeDFeatures.m_length << ".");
+    }
+
+    if (m_hitImageBuilder.IsEnabled())
+    {
+        std::swap(m_UHitImage, record.m_UHitImage);
+        std::swap(m_VHitImage, record.m_VHitImage);
+        std::swap(m_WHitImage, record.m_WHitImage);
+        LAR_RECO_LOG_DEBUG(m_logger, "Built the hit images, " << m_UHitImage.pPixelValues->size() << " U, " << m_VHitImage.pPixelValues->size() << " V and "
+            << m_WHitImage.pPixelValues->size() << " W pixels.");
+    }
+
+    LAR_RECO_LOG_DEBUG(m_logger, "nHitsPfo U: " << m_UViewHits.nHitsPfo << " V: " << m_VViewHits.nHitsPfo << " W: " << m_WViewHits.nHitsPfo << " 3D: " << m_ThreeDViewHits.nHitsPfo << "\n"
+        << "nHitsMcp U: " << m_UViewHits.nHitsMcp << " V: " << m_VViewHits.nHitsMcp << " W: " << m_WViewHits.nHitsMcp << "\n"
+        << "nHitsMatch U: " << m_UViewHits.nHitsMatch << " V: " <<  m_VViewHits.nHitsMatch << " W: " << m_WViewHits.nHitsMatch << "\n"
+        << "vertex: (" <<  m_Vertex[0] << ", " << m_Vertex[1] << ", " << m_Vertex[2] << ")");
+
+    if (m_hitEncoder.IsEnabled())
+        m_hitEncoder.Encode();
+
+    this->FillOutputs();
+}
+
+MyTrackShowerIdAlgorithm::PfoRecord::PfoRecord() :
+    m_pPfo(nullptr),
+    m_pfoId(0),
+    m_parentPfoId(-1),
+    m_hierarchyTier(0),
+    m_pDaughterPfoIds(new IntVector()),
+    m_hasVertex(false),
+    m_vertex{0.f, 0.f, 0.f},
+    m_UViewHits{new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),0,0,0},
+    m_VViewHits{new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),0,0,0},
+    m_WViewHits{new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),0,0,0},
+    m_ThreeDViewHits{new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),0,0,0},
+    m_UHitImage{new IntVector(),new FloatVector(),0.f,0.f,0.f,0.f},
+    m_VHitImage{new IntVector(),new FloatVector(),0.f,0.f,0.f,0.f},
+    m_WHitImage{new IntVector(),new FloatVector(),0.f,0.f,0.f,0.f},
+    m_UFeatures(),
+    m_VFeatures(),
+    m_WFeatures(),
+    m_ThreeDFeatures(),
+    m_mcPdgCode(0),
+    m_mcpMomentum(0.f),
+    m_mcHierarchyTier(0),
+    m_mcParentPdgCode(0),
+    m_pMcDaughterPdgCodes(new IntVector())
+{
+}
+
+MyTrackShowerIdAlgorithm::PfoRecord::~PfoRecord()
+{
+    for (const ViewHits *const pViewHits : {&m_UViewHits, &m_VViewHits, &m_WViewHits, &m_ThreeDViewHits})
+    {
+        delete pViewHits->pXCoord;
+        delete pViewHits->pYCoord;
+        delete pViewHits->pZCoord;
+        delete pViewHits->pEnergy;
+        delete pViewHits->pXCoordError;
+    }
+
+    for (const HitImage *const pHitImage : {&m_UHitImage, &m_VHitImage, &m_WHitImage})
     {
-        std::cout << "A vertex was not found for this PFO!" << std::endl;
+        delete pHitImage->pPixelIndices;
+        delete pHitImage->pPixelValues;
     }
 
-    std::cout << "nHitsPfo U: " << m_UViewHits.nHitsPfo << " V: " << m_VViewHits.nHitsPfo << " W: " << m_WViewHits.nHitsPfo << " 3D: " << m_ThreeDViewHits.nHitsPfo << std::endl
-              << "nHitsMcp U: " << m_UViewHits.nHitsMcp << " V: " << m_VViewHits.nHitsMcp << " W: " << m_WViewHits.nHitsMcp << std::endl
-              << "nHitsMatch U: " << m_UViewHits.nHitsMatch << " V: " <<  m_VViewHits.nHitsMatch << " W: " << m_WViewHits.nHitsMatch << std::endl
-              << "vertex: (" <<  m_Vertex[0] << ", " << m_Vertex[1] << ", " << m_Vertex[2] << ")" << std::endl;
+    delete m_pDaughterPfoIds;
+    delete m_pMcDaughterPdgCodes;
+}
+
+void MyTrackShowerIdAlgorithm::BuildHitImage(const ViewHits &viewHits, const HitType hitType, const CartesianVector *const pVertex,
+    lar_reco::HitImageBuilder &hitImageBuilder, HitImage &hitImage) const
+{
+    float driftCentre(0.f), wireCentre(0.f);
+
+    if (pVertex && hitImageBuilder.ShouldCropAroundVertex())
+    {
+        // The projection gives the drift coord as x and the wire coord as z
+        const CartesianVector projectedVertex(LArGeometryHelper::ProjectPosition(this->GetPandora(), *pVertex, hitType));
+        driftCentre = projectedVertex.GetX();
+        wireCentre = projectedVertex.GetZ();
+    }
+    else
+    {
+        lar_reco::HitImageBuilder::GetCentroid(viewHits.pXCoord->data(), viewHits.pZCoord->data(), viewHits.pEnergy->data(), viewHits.pXCoord->size(),
+            driftCentre, wireCentre);
+    }
 
-    m_pPfoTree->Fill(); // Fill the tree
-    pfosWritten += 1;
-    return pfosWritten;	// return pfosWritten += 1.
+    hitImageBuilder.Build(viewHits.pXCoord->data(), viewHits.pZCoord->data(), viewHits.pEnergy->data(), viewHits.pXCoord->size(), driftCentre, wireCentre,
+        hitImage.driftPitch, hitImage.wirePitch, hitImage.driftOrigin, hitImage.wireOrigin, *hitImage.pPixelIndices, *hitImage.pPixelValues);
+}
+
+void MyTrackShowerIdAlgorithm::ComputeViewFeatures(const ViewHits &viewHits, const HitType hitType, const CartesianVector *const pVertex,
+    lar_reco::PfoFeatureBuilder &pfoFeatureBuilder, lar_reco::PfoFeatures &features) const
+{
+    float projectedVertex[2] = {0.f, 0.f};
+
+    if (pVertex)
+    {
+        // The projection gives the drift coord as x and the wire coord as z
+        const CartesianVector projectedPosition(LArGeometryHelper::ProjectPosition(this->GetPandora(), *pVertex, hitType));
+        projectedVertex[0] = projectedPosition.GetX();
+        projectedVertex[1] = projectedPosition.GetZ();
+    }
+
+    pfoFeatureBuilder.ComputeTwoD(viewHits.pXCoord->data(), viewHits.pZCoord->data(), viewHits.pEnergy->data(), viewHits.pXCoord->size(),
+        pVertex ? projectedVertex : nullptr, features);
+}
+
+void MyTrackShowerIdAlgorithm::AddFeatureBranches(const std::string &viewName, const StringVector &axisNames, lar_reco::PfoFeatures &features)
+{
+    for (unsigned int iDim = 0; iDim < axisNames.size(); ++iDim)
+    {
+        this->AddBranch("featureEigenvalue" + std::to_string(iDim) + viewName, &features.m_eigenvalues[iDim]);
+        this->AddBranch("featureAxis" + axisNames.at(iDim) + viewName, &features.m_principalAxis[iDim]);
+    }
+
+    this->AddBranch("featureLength" + viewName, &features.m_length);
+    this->AddBranch("featureHitDensity" + viewName, &features.m_hitDensity);
+
+    for (unsigned int iBin = 0; iBin < m_pfoFeatureBuilder.GetNProfileBins(); ++iBin)
+        this->AddBranch("featureEnergyProfile" + std::to_string(iBin) + viewName, &features.m_energyProfile[iBin]);
+
+    this->AddBranch("featureVertexDistanceMin" + viewName, &features.m_vertexDistanceMin);
+    this->AddBranch("featureVertexDistanceMean" + viewName, &features.m_vertexDistanceMean);
+    this->AddBranch("featureVertexDistanceRms" + viewName, &features.m_vertexDistanceRms);
+    this->AddBranch("featureVertexDistanceMax" + viewName, &features.m_vertexDistanceMax);
+}
+
+void MyTrackShowerIdAlgorithm::AddHitBranch(const std::string &name, FloatVector **const ppAddress, const std::string &offsetsName, const float precision)
+{
+    if (!m_hitEncoder.IsEnabled())
+    {
+        this->AddBranch(name, ppAddress, offsetsName);
+        return;
+    }
+
+    lar_reco::HitEncoder::EncodedQuantity &quantity(m_hitEncoder.AddQuantity(name, ppAddress, precision));
+    this->AddRootBranch(name + "Codes", &quantity.m_pCodes, offsetsName);
+    this->AddBranch(name + "Min", &quantity.m_min);
+    this->AddBranch(name + "Step", &quantity.m_step);
+}
+
+void MyTrackShowerIdAlgorithm::FillOutputs()
+{
+    if (m_pWriteBehindQueue)
+    {
+        m_pWriteBehindQueue->PushRecord();
+    }
+    else
+    {
+        this->WriteOutputs();
+    }
+}
+
+void MyTrackShowerIdAlgorithm::EndOutputEvent()
+{
+    if (m_pWriteBehindQueue)
+    {
+        m_pWriteBehindQueue->PushEndEvent();
+    }
+    else
+    {
+        this->WriteEndEvent();
+    }
+}
+
+void MyTrackShowerIdAlgorithm::WriteOutputs()
+{
+    if (m_pEventTreeWriter)
+    {
+        m_pEventTreeWriter->AddPfo();
+    }
+    else if (m_pPfoTree)
+    {
+        m_pfoEntryIndex.AddEntry(*m_pOutputEventId, *m_pOutputPfoId, m_pPfoTree->GetEntries());
+        m_pPfoTree->Fill(); // Fill the tree
+    }
+
+    if (m_pColumnWriter)
+        m_pColumnWriter->Fill();
+}
+
+void MyTrackShowerIdAlgorithm::WriteEndEvent()
+{
+    // The event layout writes a single entry for the event, holding all of its pfos, whereas the pfo layout indexes the event's entries
+    if (m_pEventTreeWriter)
+        m_pEventTreeWriter->Fill();
+
+    if (m_pIndexTree)
+        m_pfoEntryIndex.EndEvent();
+
+    if (m_pOutputCheckpoint)
+        m_pOutputCheckpoint->EndEvent(*m_pOutputEventId + 1);
 }
 
 void MyTrackShowerIdAlgorithm::GetCaloHitInfo(
     const ParticleFlowObject *const pPfo,
     HitType hitType,
-    ViewHits &viewHits)
+    ViewHits &viewHits,
+    lar_reco::HitOrdering &hitOrdering,
+    const CartesianVector *const pVertex) const
 {
-    viewHits.pXCoord->clear();
+    // Copy the contiguous range of cached hit properties for this pfo and view
+    const lar_reco::PfoHitCache::HitRange hitRange(m_pfoHitCache.GetHitRange(pPfo, hitType));
+    viewHits.nHitsPfo = hitRange.GetSize();
+
+    viewHits.pXCoord->assign(m_pfoHitCache.GetXCoords().begin() + hitRange.m_begin, m_pfoHitCache.GetXCoords().begin() + hitRange.m_end);
+    viewHits.pZCoord->assign(m_pfoHitCache.GetZCoords().begin() + hitRange.m_begin, m_pfoHitCache.GetZCoords().begin() + hitRange.m_end);
+    viewHits.pEnergy->assign(m_pfoHitCache.GetEnergies().begin() + hitRange.m_begin, m_pfoHitCache.GetEnergies().begin() + hitRange.m_end);
+    viewHits.pXCoordError->assign(m_pfoHitCache.GetXCoordErrors().begin() + hitRange.m_begin, m_pfoHitCache.GetXCoordErrors().begin() + hitRange.m_end);
     viewHits.pYCoord->clear();
-    viewHits.pZCoord->clear();
-    viewHits.pXCoordError->clear();
-    viewHits.pEnergy->clear();
 
-    CaloHitList caloHitList;
-    LArPfoHelper::GetCaloHits(pPfo, hitType, caloHitList);
-    LArPfoHelper::GetIsolatedCaloHits(pPfo, hitType, caloHitList);
-    viewHits.nHitsPfo = caloHitList.size();
-    for (const CaloHit *const caloHit : caloHitList)
+    if (hitType == TPC_3D) // If hits are 3D we get the Y coordinate
     {
-        const CartesianVector &positionVector(caloHit->GetPositionVector());
+        viewHits.pYCoord->assign(m_pfoHitCache.GetYCoords().begin() + hitRange.m_begin, m_pfoHitCache.GetYCoords().begin() + hitRange.m_end);
+    }
 
-        viewHits.pXCoord->push_back(positionVector.GetX());
-        if (hitType == TPC_3D) // If hits are 3D we get the Y coordinate
-        {
-            viewHits.pYCoord->push_back(positionVector.GetY());
-        }
-        viewHits.pZCoord->push_back(positionVector.GetZ());
-        viewHits.pEnergy->push_back(caloHit->GetInputEnergy());
-        viewHits.pXCoordError->push_back(caloHit->GetCellSize1());
+    if (!hitOrdering.IsEnabled())
+        return;
+
+    // Apply the same permutation to every per-hit vector of the view, so that the i-th entries still describe the same hit
+    float vertex[3] = {0.f, 0.f, 0.f};
+
+    if (pVertex)
+    {
+        // For 2D views, the projection gives the drift coord as x and the wire coord as z
+        const CartesianVector position((hitType == TPC_3D) ? *pVertex : LArGeometryHelper::ProjectPosition(this->GetPandora(), *pVertex, hitType));
+        vertex[0] = position.GetX();
+        vertex[1] = position.GetY();
+        vertex[2] = position.GetZ();
     }
+
+    hitOrdering.Sort(viewHits.pXCoord->data(), (hitType == TPC_3D) ? viewHits.pYCoord->data() : nullptr, viewHits.pZCoord->data(),
+        viewHits.pXCoord->size(), pVertex ? vertex : nullptr);
+    hitOrdering.Apply(*viewHits.pXCoord);
+    hitOrdering.Apply(*viewHits.pYCoord);
+    hitOrdering.Apply(*viewHits.pZCoord);
+    hitOrdering.Apply(*viewHits.pXCoordError);
+    hitOrdering.Apply(*viewHits.pEnergy);
 }
 
 // Gets a file name (without extension) from a file path 
@@ -443,34 +903,125 @@ std::string MyTrackShowerIdAlgorithm::GetFileName(const std::string& filePath)
 }
 
 MyTrackShowerIdAlgorithm::MyTrackShowerIdAlgorithm() :
+    m_pTFile(nullptr),
+    m_pPfoTree(nullptr),
+    m_writeEventLayout(false),
+    m_pEventTreeWriter(nullptr),
+    m_pIndexTree(nullptr),
+    m_checkpointEvents(0),
+    m_checkpointMegabytes(0.f),
+    m_pOutputCheckpoint(nullptr),
+    m_pOutputEventId(&m_EventId),
+    m_pOutputPfoId(&m_PfoId),
+    m_writeBehindQueueSize(0),
+    m_pWriteBehindQueue(nullptr),
+    m_writeRootOutput(true),
+    m_writeColumnOutput(false),
+    m_pColumnWriter(nullptr),
+    m_isHitEncodingDelta(0),
+    m_nPfoThreads(1),
+    m_pPfoTaskPool(nullptr),
+    m_nPfoRecords(0),
+    m_imageDriftPitches{0.f, 0.f, 0.f},
+    m_imageWirePitches{0.f, 0.f, 0.f},
     m_EventId(0),
+    m_pDaughterPfoIds(new IntVector()),
     m_UViewHits{new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),0,0,0},
     m_VViewHits{new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),0,0,0},
     m_WViewHits{new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),0,0,0},
     m_ThreeDViewHits{new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),new FloatVector(),0,0,0},
-    m_pMcDaughterPdgCodes()
+    m_UHitImage{new IntVector(),new FloatVector(),0.f,0.f,0.f,0.f},
+    m_VHitImage{new IntVector(),new FloatVector(),0.f,0.f,0.f,0.f},
+    m_WHitImage{new IntVector(),new FloatVector(),0.f,0.f,0.f,0.f},
+    m_nImageDriftPixels(0),
+    m_nImageWirePixels(0),
+    m_UFeatures(),
+    m_VFeatures(),
+    m_WFeatures(),
+    m_ThreeDFeatures(),
+    m_pMcDaughterPdgCodes(new IntVector())
 {
 }
 
 MyTrackShowerIdAlgorithm::~MyTrackShowerIdAlgorithm()
 {
-    // Build index for PFOs
-    m_pPfoTree->BuildIndex("eventId", "pfoId");
+    // Let the output thread write out the queued pfos before the outputs are closed
+    if (m_pWriteBehindQueue)
+    {
+        try
+        {
+            m_pWriteBehindQueue->Close();
+        }
+        catch (const StatusCodeException &)
+        {
+            LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Write-behind output failed, the outputs are incomplete!");
+        }
+    }
 
-    // Save the root tree
-    std::cout << "MyTrackShowerIdAlgorithm: Saving ROOT tree " << m_treeName << " to file " << m_fileName << std::endl;
-    try
+    if (m_pPfoTree)
     {
-        m_pPfoTree->Write();
-        m_pTFile->Close();
+        // Save the root tree
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Saving ROOT tree " << m_treeName << " to file " << m_fileName);
+        try
+        {
+            // The final checkpoint covers the last complete event, so a resumed job repeats any event that was interrupted
+            if (m_pOutputCheckpoint)
+            {
+                m_pOutputCheckpoint->Write();
+                LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Wrote " << m_pOutputCheckpoint->GetNCheckpoints() << " checkpoints");
+            }
+
+            m_pPfoTree->Write(nullptr, TObject::kOverwrite);
+
+            // The index is complete as each event ends, so the pfo layout needs no index built here
+            if (m_pIndexTree)
+                m_pIndexTree->Write(nullptr, TObject::kOverwrite);
+
+            if (m_outputTuning.ShouldReportBranchSizes() && m_logger.IsEnabled(lar_reco::LOG_INFO))
+            {
+                std::ostringstream logStream;
+                lar_reco::OutputTuning::PrintBranchSizes(m_pPfoTree, logStream);
+                m_logger.Write(logStream.str());
+            }
+
+            if (m_hitEncoder.ShouldReportErrors() && m_logger.IsEnabled(lar_reco::LOG_INFO))
+            {
+                std::ostringstream logStream;
+                m_hitEncoder.PrintErrorReport(logStream);
+                m_logger.Write(logStream.str());
+            }
+
+            m_pTFile->Close();
+        }
+        catch (const StatusCodeException &)
+        {
+            LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Unable to write tree!");
+        }
     }
-    catch (const StatusCodeException &)
+
+    if (m_pColumnWriter)
     {
-        std::cout << "MyTrackShowerIdAlgorithm: Unable to write tree!" << std::endl;
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Saving " << m_pColumnWriter->GetNRows() << " PFOs to columnar file " << m_columnFileName);
+        try
+        {
+            m_pColumnWriter->Close();
+        }
+        catch (const StatusCodeException &)
+        {
+            LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Unable to write columnar file!");
+        }
     }
+
+    // Worker processes leave with _exit, skipping static destructors, so the log sink must be drained here
+    lar_reco::Logger::Flush();
     
     // Clean up
+    delete m_pPfoTaskPool;
+    delete m_pWriteBehindQueue;
+    delete m_pOutputCheckpoint;
+    delete m_pEventTreeWriter;
     delete m_pTFile;
+    delete m_pColumnWriter;
     delete m_UViewHits.pXCoord;
     delete m_UViewHits.pYCoord;
     delete m_UViewHits.pZCoord;
@@ -486,6 +1037,18 @@ MyTrackShowerIdAlgorithm::~MyTrackShowerIdAlgorithm()
     delete m_WViewHits.pZCoord;
     delete m_WViewHits.pEnergy;
     delete m_WViewHits.pXCoordError;
+    delete m_ThreeDViewHits.pXCoord;
+    delete m_ThreeDViewHits.pYCoord;
+    delete m_ThreeDViewHits.pZCoord;
+    delete m_ThreeDViewHits.pEnergy;
+    delete m_ThreeDViewHits.pXCoordError;
+    delete m_UHitImage.pPixelIndices;
+    delete m_UHitImage.pPixelValues;
+    delete m_VHitImage.pPixelIndices;
+    delete m_VHitImage.pPixelValues;
+    delete m_WHitImage.pPixelIndices;
+    delete m_WHitImage.pPixelValues;
+    delete m_pDaughterPfoIds;
     delete m_pMcDaughterPdgCodes;
 }
 
@@ -514,67 +1077,275 @@ StatusCode MyTrackShowerIdAlgorithm::ReadSettings(const TiXmlHandle xmlHandle)
     {
         m_treeName = "PFOs";
     }
-    if (XmlHelper::ReadValue(xmlHandle, "OutputFile", m_fileName) != STATUS_CODE_SUCCESS) // If there is no name given, use the same name as the input file (with extension changed to .root)
+    std::string outputFormat("Root");
+    (void) XmlHelper::ReadValue(xmlHandle, "OutputFormat", outputFormat);
+    if (outputFormat == "Root" || outputFormat == "Columnar" || outputFormat == "Both")
+    {
+        m_writeRootOutput = (outputFormat != "Columnar");
+        m_writeColumnOutput = (outputFormat != "Root");
+    }
+    else
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Unrecognised OutputFormat " << outputFormat << ", expected Root, Columnar or Both");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+    std::string outputLayout("Pfo");
+    (void) XmlHelper::ReadValue(xmlHandle, "OutputLayout", outputLayout);
+    if (outputLayout == "Pfo" || outputLayout == "Event")
+    {
+        m_writeEventLayout = (outputLayout == "Event");
+    }
+    else
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Unrecognised OutputLayout " << outputLayout << ", expected Pfo or Event");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+    if (XmlHelper::ReadValue(xmlHandle, "WriteBehindQueueSize", m_writeBehindQueueSize) != STATUS_CODE_SUCCESS)
+    {
+        m_writeBehindQueueSize = 0;
+    }
+    if (XmlHelper::ReadValue(xmlHandle, "CheckpointEvents", m_checkpointEvents) != STATUS_CODE_SUCCESS)
+    {
+        m_checkpointEvents = 0;
+    }
+    if (XmlHelper::ReadValue(xmlHandle, "CheckpointMegabytes", m_checkpointMegabytes) != STATUS_CODE_SUCCESS)
+    {
+        m_checkpointMegabytes = 0.f;
+    }
+    std::string hitOrderName("Input");
+    (void) XmlHelper::ReadValue(xmlHandle, "HitOrder", hitOrderName);
+    if (m_hitOrdering.SetOrder(hitOrderName) != STATUS_CODE_SUCCESS)
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Unrecognised HitOrder " << hitOrderName << ", expected Input, WireDrift, Morton or VertexDistance");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+    std::string logLevelName;
+    if (XmlHelper::ReadValue(xmlHandle, "LogLevel", logLevelName) == STATUS_CODE_SUCCESS)
+    {
+        if (m_logger.SetLogLevel(logLevelName) != STATUS_CODE_SUCCESS)
+        {
+            LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Unrecognised LogLevel " << logLevelName << ", expected Error, Warning, Info or Debug");
+            return STATUS_CODE_INVALID_PARAMETER;
+        }
+    }
+    if (m_outputTuning.ReadSettings(xmlHandle) != STATUS_CODE_SUCCESS)
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Invalid OutputTuning settings");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+    if (m_hitImageBuilder.ReadSettings(xmlHandle) != STATUS_CODE_SUCCESS)
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Invalid HitImages settings");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+    if (m_pfoFeatureBuilder.ReadSettings(xmlHandle) != STATUS_CODE_SUCCESS)
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Invalid PfoFeatures settings");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+    if (m_hitEncoder.ReadSettings(xmlHandle) != STATUS_CODE_SUCCESS)
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: Invalid HitEncoding settings");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+    if (m_hitEncoder.IsEnabled() && m_writeColumnOutput)
+    {
+        // The columnar file holds raw values for zero-copy reading, so only the root tree is encoded
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: HitEncoding applies to the root output only, so requires OutputFormat Root");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+    if (XmlHelper::ReadValue(xmlHandle, "PfoThreads", m_nPfoThreads) != STATUS_CODE_SUCCESS)
+    {
+        m_nPfoThreads = 1;
+    }
+    if (m_nPfoThreads < 1)
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_ERROR, "MyTrackShowerIdAlgorithm: PfoThreads must be at least 1");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+    if (m_nPfoThreads > 1)
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Building PFO records on " << m_nPfoThreads << " threads");
+        m_pPfoTaskPool = new lar_reco::PfoTaskPool(m_nPfoThreads);
+    }
+
+    // Each worker sorts and bins with its own copy of the configured builders, as they hold scratch memory
+    RecordWorkspace recordWorkspace;
+    recordWorkspace.m_hitOrdering = m_hitOrdering;
+    recordWorkspace.m_pfoFeatureBuilder = m_pfoFeatureBuilder;
+    recordWorkspace.m_hitImageBuilder = m_hitImageBuilder;
+    m_recordWorkspaces.assign(m_nPfoThreads, recordWorkspace);
+    EventReadingAlgorithm::ExternalEventReadingParameters *pExternalParameters(nullptr);
+    pExternalParameters = dynamic_cast<EventReadingAlgorithm::ExternalEventReadingParameters*>(this->GetExternalParameters());
+    ExternalTrackShowerIdParameters *pTrackShowerIdParameters(dynamic_cast<ExternalTrackShowerIdParameters*>(pExternalParameters));
+
+    if (pTrackShowerIdParameters && !pTrackShowerIdParameters->m_outputFileName.empty()) // The application may override the output file, e.g. for worker processes
+    {
+        m_fileName = pTrackShowerIdParameters->m_outputFileName;
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "File name: " << m_fileName);
+    }
+    else if (XmlHelper::ReadValue(xmlHandle, "OutputFile", m_fileName) != STATUS_CODE_SUCCESS) // If there is no name given, use the same name as the input file (with extension changed to .root)
     {
-        EventReadingAlgorithm::ExternalEventReadingParameters *pExternalParameters(nullptr);
-        pExternalParameters = dynamic_cast<EventReadingAlgorithm::ExternalEventReadingParameters*>(this->GetExternalParameters());
         m_fileName = this->GetFileName(pExternalParameters->m_eventFileNameList).append(".root"); // Assumes there is a single event file being processed (otherwise it will use the name of the last file)
-        std::cout << "File name: " << m_fileName << std::endl;
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "File name: " << m_fileName);
     }
 
-    // Open/create tree file
-    std::cout <<  "MyTrackShowerIdAlgorithm: Creating tree file." << std::endl;
-    m_pTFile = new TFile(m_fileName.c_str(), "RECREATE");
-    m_pPfoTree = new TTree(m_treeName.c_str(), "A tree of PFOs.");
-    m_pPfoTree->Branch("eventId", &m_EventId);
+    if (pTrackShowerIdParameters)
+        m_EventId = pTrackShowerIdParameters->m_firstEventId;
+
+    // Open/create tree file and/or columnar file, the latter named after the tree file (with extension changed to .pfocol)
+    if (m_writeRootOutput)
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Creating tree file.");
+        m_outputTuning.EnableImplicitMT();
+        m_pTFile = new TFile(m_fileName.c_str(), "RECREATE");
+        m_outputTuning.ApplyToFile(m_pTFile);
+        if (m_writeEventLayout)
+        {
+            m_pPfoTree = new TTree(m_treeName.c_str(), "A tree of events, each holding its PFOs.");
+            m_pEventTreeWriter = new lar_reco::PfoEventTreeWriter(m_pPfoTree);
+        }
+        else
+        {
+            m_pPfoTree = new TTree(m_treeName.c_str(), "A tree of PFOs.");
+            m_pIndexTree = m_pfoEntryIndex.CreateTree(m_treeName);
+        }
+        if (m_checkpointEvents > 0 || m_checkpointMegabytes > 0.f)
+        {
+            LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Checkpointing tree every " << m_checkpointEvents << " events or "
+                << m_checkpointMegabytes << " MB, whichever comes first (zero disables)");
+            m_pOutputCheckpoint = new lar_reco::OutputCheckpoint(m_treeName, m_pPfoTree, m_pIndexTree, m_checkpointEvents,
+                static_cast<Long64_t>(m_checkpointMegabytes * 1024.f * 1024.f), m_EventId);
+        }
+    }
+    if (m_writeColumnOutput)
+    {
+        m_columnFileName = lar_reco::GetColumnFileName(m_fileName);
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Creating columnar file " << m_columnFileName);
+        m_pColumnWriter = new lar_reco::PfoColumnWriter(m_columnFileName);
+    }
+    if (m_writeBehindQueueSize > 0 && (m_pPfoTree || m_pColumnWriter))
+    {
+        // Root is used by the output thread as well as the thread creating the file
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Writing outputs on a separate thread, queueing up to " << m_writeBehindQueueSize << " PFOs");
+        ROOT::EnableThreadSafety();
+        m_pWriteBehindQueue = new lar_reco::WriteBehindQueue(m_writeBehindQueueSize);
+    }
+    m_pOutputEventId = this->AddEventBranch("eventId", &m_EventId);
 
     // PFO identification + relations
-    m_pPfoTree->Branch("pfoId", &m_PfoId);
-    m_pPfoTree->Branch("parentPfoId", &m_ParentPfoId);
-    m_pPfoTree->Branch("daughterPfoIds", &m_pDaughterPfoIds);
-    m_pPfoTree->Branch("hierarchyTier", &m_HierarchyTier);
+    m_pOutputPfoId = this->AddBranch("pfoId", &m_PfoId);
+    this->AddBranch("parentPfoId", &m_ParentPfoId);
+    this->AddBranch("daughterPfoIds", &m_pDaughterPfoIds, "daughterPfoIdsOffsets");
+    this->AddBranch("hierarchyTier", &m_HierarchyTier);
 
     // Simulation info
-    m_pPfoTree->Branch("mcNuanceCode", &m_mcNuanceCode);
-    m_pPfoTree->Branch("mcPdgCode", &m_mcPdgCode);
-    m_pPfoTree->Branch("mcParentPdgCode", &m_mcParentPdgCode);
-    m_pPfoTree->Branch("mcDaughterPdgCodes", &m_pMcDaughterPdgCodes);
-    m_pPfoTree->Branch("mcpMomentum", &m_mcpMomentum);
-    m_pPfoTree->Branch("mcHierarchyTier", &m_mcHierarchyTier);
+    this->AddEventBranch("mcNuanceCode", &m_mcNuanceCode);
+    this->AddBranch("mcPdgCode", &m_mcPdgCode);
+    this->AddBranch("mcParentPdgCode", &m_mcParentPdgCode);
+    this->AddBranch("mcDaughterPdgCodes", &m_pMcDaughterPdgCodes, "mcDaughterPdgCodesOffsets");
+    this->AddBranch("mcpMomentum", &m_mcpMomentum);
+    this->AddBranch("mcHierarchyTier", &m_mcHierarchyTier);
+
+    // Hit values are written as floats, or as quantised codes with their range for each pfo (see HitEncoder)
+    const float coordinatePrecision(m_hitEncoder.GetCoordinatePrecision()), energyPrecision(m_hitEncoder.GetEnergyPrecision());
+    if (m_hitEncoder.IsEnabled())
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Encoding hit values " << (m_hitEncoder.IsDelta() ? "as deltas " : "")
+            << "to " << coordinatePrecision << " cm and " << energyPrecision << " GeV");
+        m_isHitEncodingDelta = m_hitEncoder.IsDelta() ? 1 : 0;
+        this->AddEventBranch("hitEncodingDelta", &m_isHitEncodingDelta);
+    }
 
     // U view
-    m_pPfoTree->Branch("driftCoordU", &(m_UViewHits.pXCoord));
-    m_pPfoTree->Branch("driftCoordErrorU", &(m_UViewHits.pXCoordError));
-    m_pPfoTree->Branch("wireCoordU", &(m_UViewHits.pZCoord));
-    m_pPfoTree->Branch("energyU", &(m_UViewHits.pEnergy));
-    m_pPfoTree->Branch("nHitsPfoU", &(m_UViewHits.nHitsPfo));
-    m_pPfoTree->Branch("nHitsMcpU", &(m_UViewHits.nHitsMcp));
-    m_pPfoTree->Branch("nHitsMatchU", &(m_UViewHits.nHitsMatch));
+    this->AddHitBranch("driftCoordU", &(m_UViewHits.pXCoord), "hitOffsetsU", coordinatePrecision);
+    this->AddHitBranch("driftCoordErrorU", &(m_UViewHits.pXCoordError), "hitOffsetsU", coordinatePrecision);
+    this->AddHitBranch("wireCoordU", &(m_UViewHits.pZCoord), "hitOffsetsU", coordinatePrecision);
+    this->AddHitBranch("energyU", &(m_UViewHits.pEnergy), "hitOffsetsU", energyPrecision);
+    this->AddBranch("nHitsPfoU", &(m_UViewHits.nHitsPfo));
+    this->AddBranch("nHitsMcpU", &(m_UViewHits.nHitsMcp));
+    this->AddBranch("nHitsMatchU", &(m_UViewHits.nHitsMatch));
 
     // V view
-    m_pPfoTree->Branch("driftCoordV", &(m_VViewHits.pXCoord));
-    m_pPfoTree->Branch("driftCoordErrorV", &(m_VViewHits.pXCoordError));
-    m_pPfoTree->Branch("wireCoordV", &(m_VViewHits.pZCoord));
-    m_pPfoTree->Branch("energyV", &(m_VViewHits.pEnergy));
-    m_pPfoTree->Branch("nHitsPfoV", &(m_VViewHits.nHitsPfo));
-    m_pPfoTree->Branch("nHitsMcpV", &(m_VViewHits.nHitsMcp));
-    m_pPfoTree->Branch("nHitsMatchV", &(m_VViewHits.nHitsMatch));
+    this->AddHitBranch("driftCoordV", &(m_VViewHits.pXCoord), "hitOffsetsV", coordinatePrecision);
+    this->AddHitBranch("driftCoordErrorV", &(m_VViewHits.pXCoordError), "hitOffsetsV", coordinatePrecision);
+    this->AddHitBranch("wireCoordV", &(m_VViewHits.pZCoord), "hitOffsetsV", coordinatePrecision);
+    this->AddHitBranch("energyV", &(m_VViewHits.pEnergy), "hitOffsetsV", energyPrecision);
+    this->AddBranch("nHitsPfoV", &(m_VViewHits.nHitsPfo));
+    this->AddBranch("nHitsMcpV", &(m_VViewHits.nHitsMcp));
+    this->AddBranch("nHitsMatchV", &(m_VViewHits.nHitsMatch));
 
     // W view
-    m_pPfoTree->Branch("driftCoordW", &(m_WViewHits.pXCoord));
-    m_pPfoTree->Branch("driftCoordErrorW", &(m_WViewHits.pXCoordError));
-    m_pPfoTree->Branch("wireCoordW", &(m_WViewHits.pZCoord));
-    m_pPfoTree->Branch("energyW", &(m_WViewHits.pEnergy));
-    m_pPfoTree->Branch("nHitsPfoW", &(m_WViewHits.nHitsPfo));
-    m_pPfoTree->Branch("nHitsMcpW", &(m_WViewHits.nHitsMcp));
-    m_pPfoTree->Branch("nHitsMatchW", &(m_WViewHits.nHitsMatch));
+    this->AddHitBranch("driftCoordW", &(m_WViewHits.pXCoord), "hitOffsetsW", coordinatePrecision);
+    this->AddHitBranch("driftCoordErrorW", &(m_WViewHits.pXCoordError), "hitOffsetsW", coordinatePrecision);
+    this->AddHitBranch("wireCoordW", &(m_WViewHits.pZCoord), "hitOffsetsW", coordinatePrecision);
+    this->AddHitBranch("energyW", &(m_WViewHits.pEnergy), "hitOffsetsW", energyPrecision);
+    this->AddBranch("nHitsPfoW", &(m_WViewHits.nHitsPfo));
+    this->AddBranch("nHitsMcpW", &(m_WViewHits.nHitsMcp));
+    this->AddBranch("nHitsMatchW", &(m_WViewHits.nHitsMatch));
 
     // 3D view
-    m_pPfoTree->Branch("xCoordThreeD", &(m_ThreeDViewHits.pXCoord));
-    m_pPfoTree->Branch("yCoordThreeD", &(m_ThreeDViewHits.pYCoord));
-    m_pPfoTree->Branch("zCoordThreeD", &(m_ThreeDViewHits.pZCoord));
-    m_pPfoTree->Branch("energyThreeD", &(m_ThreeDViewHits.pEnergy));
-    m_pPfoTree->Branch("vertex", &m_Vertex, "m_Vertex[3]/F");
+    this->AddHitBranch("xCoordThreeD", &(m_ThreeDViewHits.pXCoord), "hitOffsetsThreeD", coordinatePrecision);
+    this->AddHitBranch("yCoordThreeD", &(m_ThreeDViewHits.pYCoord), "hitOffsetsThreeD", coordinatePrecision);
+    this->AddHitBranch("zCoordThreeD", &(m_ThreeDViewHits.pZCoord), "hitOffsetsThreeD", coordinatePrecision);
+    this->AddHitBranch("energyThreeD", &(m_ThreeDViewHits.pEnergy), "hitOffsetsThreeD", energyPrecision);
+    float *const pVertex(m_pWriteBehindQueue ? m_pWriteBehindQueue->Bind(m_Vertex, 3) : m_Vertex);
+    if (m_pEventTreeWriter)
+    {
+        m_pEventTreeWriter->Branch("vertex", pVertex, 3);
+    }
+    else if (m_pPfoTree)
+    {
+        m_pPfoTree->Branch("vertex", pVertex, "m_Vertex[3]/F");
+    }
+    if (m_pColumnWriter)
+        m_pColumnWriter->Branch("vertex", pVertex, 3);
+
+    // PFO features
+    if (m_pfoFeatureBuilder.IsEnabled())
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Writing PFO features, with " << m_pfoFeatureBuilder.GetNProfileBins() << " energy profile bins");
+        this->AddFeatureBranches("U", {"Drift", "Wire"}, m_UFeatures);
+        this->AddFeatureBranches("V", {"Drift", "Wire"}, m_VFeatures);
+        this->AddFeatureBranches("W", {"Drift", "Wire"}, m_WFeatures);
+        this->AddFeatureBranches("ThreeD", {"X", "Y", "Z"}, m_ThreeDFeatures);
+    }
+
+    // Hit images
+    if (m_hitImageBuilder.IsEnabled())
+    {
+        LAR_RECO_LOG(m_logger, lar_reco::LOG_INFO, "MyTrackShowerIdAlgorithm: Writing " << (m_hitImageBuilder.IsSparse() ? "sparse " : "dense ")
+            << m_hitImageBuilder.GetNDriftPixels() << "x" << m_hitImageBuilder.GetNWirePixels() << " hit images");
+        m_nImageDriftPixels = m_hitImageBuilder.GetNDriftPixels();
+        m_nImageWirePixels = m_hitImageBuilder.GetNWirePixels();
+        this->AddEventBranch("imageNDriftPixels", &m_nImageDriftPixels);
+        this->AddEventBranch("imageNWirePixels", &m_nImageWirePixels);
+
+        const std::pair<std::string, HitImage*> viewImages[] = {{"U", &m_UHitImage}, {"V", &m_VHitImage}, {"W", &m_WHitImage}};
+
+        for (const std::pair<std::string, HitImage*> &viewImage : viewImages)
+        {
+            HitImage *const pHitImage(viewImage.second);
+
+            // Sparse indices and values have the same length for every pfo, so share their offsets in the event layout
+            if (m_hitImageBuilder.IsSparse())
+                this->AddBranch("imageIndices" + viewImage.first, &(pHitImage->pPixelIndices), "imageOffsets" + viewImage.first);
+
+            this->AddBranch("image" + viewImage.first, &(pHitImage->pPixelValues), "imageOffsets" + viewImage.first);
+            this->AddBranch("imageDriftOrigin" + viewImage.first, &(pHitImage->driftOrigin));
+            this->AddBranch("imageWireOrigin" + viewImage.first, &(pHitImage->wireOrigin));
+            this->AddBranch("imageDriftPitch" + viewImage.first, &(pHitImage->driftPitch));
+            this->AddBranch("imageWirePitch" + viewImage.first, &(pHitImage->wirePitch));
+        }
+    }
+
+    // The output thread reads the shadow copies, so may only start once all variables are bound
+    if (m_pWriteBehindQueue)
+        m_pWriteBehindQueue->Start([this]() { this->WriteOutputs(); }, [this]() { this->WriteEndEvent(); });
+
+    // Basket sizes apply to existing branches, so tune the tree once all are created
+    if (m_pPfoTree)
+        m_outputTuning.ApplyToTree(m_pPfoTree);
 
     return STATUS_CODE_SUCCESS;
 }
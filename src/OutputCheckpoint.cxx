@@ -0,0 +1,114 @@
+/**
+ *  @file   LArReco/src/OutputCheckpoint.cxx
+ *
+ *  @brief  Implementation of the output checkpoint class.
+ *
+ *  $Log: $
+ */
+
+#include "OutputCheckpoint.h"
+
+#include "TFile.h"
+
+#include <cstring>
+
+using namespace pandora;
+
+namespace
+{
+
+const char *const CHECKPOINT_TREE_TITLE("PfoCheckpoint");
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+OutputCheckpoint::OutputCheckpoint(const std::string &pfoTreeName, TTree *const pPfoTree, TTree *const pIndexTree, const unsigned int nEventsPerCheckpoint,
+        const Long64_t nBytesPerCheckpoint, const unsigned int firstEventId) :
+    m_pPfoTree(pPfoTree),
+    m_pIndexTree(pIndexTree),
+    m_pCheckpointTree(nullptr),
+    m_nEventsPerCheckpoint(nEventsPerCheckpoint),
+    m_nBytesPerCheckpoint(nBytesPerCheckpoint),
+    m_nEventsSinceCheckpoint(0),
+    m_nBytesAtCheckpoint(pPfoTree->GetTotBytes()),
+    m_nCheckpoints(0),
+    m_lastEvent{firstEventId, pPfoTree->GetEntries(), pIndexTree ? pIndexTree->GetEntries() : 0},
+    m_treeRecord{0, 0, 0}
+{
+    m_pCheckpointTree = new TTree(GetCheckpointTreeName(pfoTreeName).c_str(), CHECKPOINT_TREE_TITLE);
+    m_pCheckpointTree->Branch("nextEventId", &m_treeRecord.m_nextEventId, "nextEventId/i");
+    m_pCheckpointTree->Branch("nEntries", &m_treeRecord.m_nEntries, "nEntries/L");
+    m_pCheckpointTree->Branch("nIndexEntries", &m_treeRecord.m_nIndexEntries, "nIndexEntries/L");
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void OutputCheckpoint::EndEvent(const unsigned int nextEventId)
+{
+    m_lastEvent = Record{nextEventId, m_pPfoTree->GetEntries(), m_pIndexTree ? m_pIndexTree->GetEntries() : 0};
+    ++m_nEventsSinceCheckpoint;
+
+    const bool isEventCountReached((m_nEventsPerCheckpoint > 0) && (m_nEventsSinceCheckpoint >= m_nEventsPerCheckpoint));
+    const bool isByteCountReached((m_nBytesPerCheckpoint > 0) && (m_pPfoTree->GetTotBytes() - m_nBytesAtCheckpoint >= m_nBytesPerCheckpoint));
+
+    if (isEventCountReached || isByteCountReached)
+        this->Write();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void OutputCheckpoint::Write()
+{
+    // The record is saved last, so a recovered file always holds at least the entries it counts
+    m_pPfoTree->AutoSave("SaveSelf");
+
+    if (m_pIndexTree)
+        m_pIndexTree->AutoSave("SaveSelf");
+
+    m_treeRecord = m_lastEvent;
+    m_pCheckpointTree->Fill();
+    m_pCheckpointTree->AutoSave("SaveSelf");
+
+    m_nEventsSinceCheckpoint = 0;
+    m_nBytesAtCheckpoint = m_pPfoTree->GetTotBytes();
+    ++m_nCheckpoints;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool OutputCheckpoint::Read(TFile *const pTFile, const std::string &pfoTreeName, Record &record)
+{
+    TTree *pCheckpointTree(nullptr);
+    pTFile->GetObject(GetCheckpointTreeName(pfoTreeName).c_str(), pCheckpointTree);
+
+    if (!pCheckpointTree || !IsCheckpointTree(pCheckpointTree) || (0 == pCheckpointTree->GetEntries()))
+        return false;
+
+    pCheckpointTree->SetBranchAddress("nextEventId", &record.m_nextEventId);
+    pCheckpointTree->SetBranchAddress("nEntries", &record.m_nEntries);
+    pCheckpointTree->SetBranchAddress("nIndexEntries", &record.m_nIndexEntries);
+    pCheckpointTree->GetEntry(pCheckpointTree->GetEntries() - 1);
+    pCheckpointTree->ResetBranchAddresses();
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string OutputCheckpoint::GetCheckpointTreeName(const std::string &pfoTreeName)
+{
+    return pfoTreeName + "Checkpoint";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool OutputCheckpoint::IsCheckpointTree(const TTree *const pTree)
+{
+    return (0 == std::strcmp(pTree->GetTitle(), CHECKPOINT_TREE_TITLE));
+}
+
+} // namespace lar_reco
@@ -0,0 +1,192 @@
+/**
+ *  @file   LArReco/src/OutputTuning.cxx
+ *
+ *  @brief  Implementation of the output tuning class.
+ *
+ *  $Log: $
+ */
+
+#include "Helpers/XmlHelper.h"
+#include "Xml/tinyxml.h"
+
+#include "OutputTuning.h"
+#include "Logger.h"
+
+#include "Compression.h"
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+OutputTuning::OutputTuning() :
+    m_compressionAlgorithm(-1),
+    m_compressionLevel(-1),
+    m_basketSize(0),
+    m_autoFlush(0),
+    m_autoSave(0),
+    m_implicitMT(false),
+    m_nImplicitMTThreads(0),
+    m_reportBranchSizes(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode OutputTuning::ReadSettings(const TiXmlHandle &xmlHandle)
+{
+    const TiXmlHandle tuningHandle(xmlHandle.FirstChild("OutputTuning"));
+
+    if (!tuningHandle.Element())
+        return STATUS_CODE_SUCCESS;
+
+    std::string compressionAlgorithm;
+
+    if (STATUS_CODE_SUCCESS == XmlHelper::ReadValue(tuningHandle, "CompressionAlgorithm", compressionAlgorithm))
+    {
+        std::transform(compressionAlgorithm.begin(), compressionAlgorithm.end(), compressionAlgorithm.begin(), ::toupper);
+
+        if ("ZLIB" == compressionAlgorithm)
+        {
+            m_compressionAlgorithm = ROOT::RCompressionSetting::EAlgorithm::kZLIB;
+        }
+        else if ("LZMA" == compressionAlgorithm)
+        {
+            m_compressionAlgorithm = ROOT::RCompressionSetting::EAlgorithm::kLZMA;
+        }
+        else if ("LZ4" == compressionAlgorithm)
+        {
+            m_compressionAlgorithm = ROOT::RCompressionSetting::EAlgorithm::kLZ4;
+        }
+        else if ("ZSTD" == compressionAlgorithm)
+        {
+            m_compressionAlgorithm = ROOT::RCompressionSetting::EAlgorithm::kZSTD;
+        }
+        else
+        {
+            LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "OutputTuning: unrecognised CompressionAlgorithm " << compressionAlgorithm << ", expected ZLIB, LZMA, LZ4 or ZSTD");
+            return STATUS_CODE_INVALID_PARAMETER;
+        }
+    }
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(tuningHandle, "CompressionLevel", m_compressionLevel));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(tuningHandle, "BasketSize", m_basketSize));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(tuningHandle, "AutoFlush", m_autoFlush));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(tuningHandle, "AutoSave", m_autoSave));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(tuningHandle, "ImplicitMT", m_implicitMT));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(tuningHandle, "ImplicitMTThreads", m_nImplicitMTThreads));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(tuningHandle, "ReportBranchSizes", m_reportBranchSizes));
+
+    if ((m_compressionLevel > 9) || (m_basketSize < 0))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "OutputTuning: CompressionLevel must be from 0 to 9, and BasketSize must not be negative");
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void OutputTuning::ApplyToFile(TFile *const pTFile) const
+{
+    if (this->HasCompressionSettings())
+        pTFile->SetCompressionSettings(this->GetCompressionSettings());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void OutputTuning::ApplyToTree(TTree *const pTree) const
+{
+    if (m_basketSize > 0)
+        pTree->SetBasketSize("*", m_basketSize);
+
+    if (0 != m_autoFlush)
+        pTree->SetAutoFlush(m_autoFlush);
+
+    if (0 != m_autoSave)
+        pTree->SetAutoSave(m_autoSave);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void OutputTuning::EnableImplicitMT() const
+{
+    if (m_implicitMT)
+        ROOT::EnableImplicitMT(m_nImplicitMTThreads);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int OutputTuning::GetCompressionSettings() const
+{
+    // With no algorithm, root uses its global default algorithm; with no level, use the default level of the chosen algorithm
+    if (m_compressionAlgorithm < 0)
+        return std::max(m_compressionLevel, 0);
+
+    int compressionLevel(m_compressionLevel);
+
+    if (compressionLevel < 0)
+    {
+        switch (m_compressionAlgorithm)
+        {
+        case ROOT::RCompressionSetting::EAlgorithm::kLZMA:
+            compressionLevel = ROOT::RCompressionSetting::ELevel::kDefaultLZMA;
+            break;
+        case ROOT::RCompressionSetting::EAlgorithm::kLZ4:
+            compressionLevel = ROOT::RCompressionSetting::ELevel::kDefaultLZ4;
+            break;
+        case ROOT::RCompressionSetting::EAlgorithm::kZSTD:
+            compressionLevel = ROOT::RCompressionSetting::ELevel::kDefaultZSTD;
+            break;
+        default:
+            compressionLevel = ROOT::RCompressionSetting::ELevel::kDefaultZLIB;
+            break;
+        }
+    }
+
+    return (100 * m_compressionAlgorithm + compressionLevel);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void OutputTuning::PrintBranchSizes(TTree *const pTree, std::ostream &stream)
+{
+    typedef std::pair<std::string, std::pair<long long, long long>> BranchSize;
+    std::vector<BranchSize> branchSizes;
+    long long totalBytes(0), totalZipBytes(0);
+    TObjArray *const pBranches(pTree->GetListOfBranches());
+
+    for (int iBranch = 0; iBranch < pBranches->GetEntries(); ++iBranch)
+    {
+        const TBranch *const pBranch(static_cast<TBranch*>(pBranches->At(iBranch)));
+        const long long nBytes(pBranch->GetTotBytes("*")), nZipBytes(pBranch->GetZipBytes("*"));
+        branchSizes.push_back(BranchSize(pBranch->GetName(), std::make_pair(nBytes, nZipBytes)));
+        totalBytes += nBytes;
+        totalZipBytes += nZipBytes;
+    }
+
+    std::stable_sort(branchSizes.begin(), branchSizes.end(),
+        [](const BranchSize &lhs, const BranchSize &rhs) { return lhs.second.second > rhs.second.second; });
+
+    stream << "Branch sizes for tree " << pTree->GetName() << ", " << pTree->GetEntries() << " entries (uncompressed bytes, compressed bytes, ratio)" << std::endl;
+
+    for (const BranchSize &branchSize : branchSizes)
+    {
+        stream << "  " << std::left << std::setw(24) << branchSize.first << std::right << std::setw(14) << branchSize.second.first
+               << std::setw(14) << branchSize.second.second << std::setw(8) << std::fixed << std::setprecision(2)
+               << ((branchSize.second.second > 0) ? static_cast<double>(branchSize.second.first) / branchSize.second.second : 0.) << std::endl;
+    }
+
+    stream << "  " << std::left << std::setw(24) << "total" << std::right << std::setw(14) << totalBytes << std::setw(14) << totalZipBytes
+           << std::setw(8) << std::fixed << std::setprecision(2) << ((totalZipBytes > 0) ? static_cast<double>(totalBytes) / totalZipBytes : 0.);
+}
+
+} // namespace lar_reco
@@ -14,46 +14,93 @@
 #include "larpandoracontent/LArControlFlow/MasterAlgorithm.h"
 #include "larpandoracontent/LArControlFlow/MultiPandoraApi.h"
 #include "larpandoracontent/LArHelpers/LArPfoHelper.h"
+#include "larpandoracontent/LArObjects/LArCaloHit.h"
+#include "larpandoracontent/LArObjects/LArMCParticle.h"
 #include "larpandoracontent/LArPersistency/EventReadingAlgorithm.h"
 #include "larpandoracontent/LArPlugins/LArPseudoLayerPlugin.h"
 #include "larpandoracontent/LArPlugins/LArRotationalTransformationPlugin.h"
 
+#include "Persistency/BinaryFileReader.h"
+#include "Persistency/XmlFileReader.h"
+
+#include "AlgorithmTimer.h"
+#include "ConfigurationCache.h"
+#include "EventFileIndex.h"
+#include "Logger.h"
+#include "MemoryMonitor.h"
+#include "OutputCheckpoint.h"
+#include "OutputTuning.h"
+#include "PfoColumnReader.h"
+#include "PfoColumnWriter.h"
+#include "PfoEntryIndex.h"
+#include "PfoEventTreeWriter.h"
 #include "PandoraInterface.h"
 #include "MyTrackShowerIdAlgorithm.h"
+#include "TimingMarkerAlgorithm.h"
+#include "TimingMasterAlgorithm.h"
+
+#include "TFile.h"
+#include "TFileMerger.h"
+#include "TKey.h"
+#include "TROOT.h"
+#include "TTree.h"
 
-#ifdef MONITORING
-#include "TApplication.h"
-#endif
+#include <sys/wait.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <getopt.h>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 using namespace pandora;
-using namespace lar_reco;
 
-int main(int argc, char *argv[])
+namespace
+{
+
+std::atomic<int> g_stopSignal(0);
+
+/**
+ *  @brief  Record a signal asking event processing to stop, leaving the event loops to stop cleanly
+ *
+ *  @param  signal the signal number
+ */
+void HandleStopSignal(const int signal)
+{
+    g_stopSignal = signal;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+int RunPandora(const Parameters &parameters)
 {
     int errorNo(0);
     const Pandora *pPrimaryPandora(nullptr);
+    std::unique_ptr<AlgorithmTimer> pAlgorithmTimer(parameters.m_timingReportFile.empty() ? nullptr : new AlgorithmTimer(parameters.m_timingReportFile));
+    std::unique_ptr<MemoryMonitor> pMemoryMonitor(parameters.m_memoryReportFile.empty() ? nullptr : new MemoryMonitor(parameters.m_memoryReportFile));
 
     try
     {
-        Parameters parameters;
-
-        if (!ParseCommandLine(argc, argv, parameters))
-            return 1;
-
-#ifdef MONITORING
-        TApplication *pTApplication = new TApplication("LArReco", &argc, argv);
-        pTApplication->SetReturnFromRun(kTRUE);
-#endif
-        CreatePandoraInstances(parameters, pPrimaryPandora);
+        CreatePandoraInstances(parameters, pPrimaryPandora, pAlgorithmTimer.get());
 
         if (!pPrimaryPandora)
             throw StatusCodeException(STATUS_CODE_FAILURE);
 
-        ProcessEvents(parameters, pPrimaryPandora);
+        ProcessEvents(parameters, pPrimaryPandora, pMemoryMonitor.get());
     }
     catch (const StatusCodeException &statusCodeException)
     {
@@ -72,224 +119,1866 @@ int main(int argc, char *argv[])
     }
 
     MultiPandoraApi::DeletePandoraInstances(pPrimaryPandora);
-    return errorNo;
+
+    if (pAlgorithmTimer)
+        pAlgorithmTimer->WriteReport();
+
+    if (pMemoryMonitor)
+        pMemoryMonitor->WriteReport();
+
+    return GetStoppedExitCode(errorNo);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-namespace lar_reco
+void InstallStopSignalHandlers()
 {
+    struct sigaction stopAction;
+    std::memset(&stopAction, 0, sizeof(stopAction));
+    stopAction.sa_handler = HandleStopSignal;
+    sigemptyset(&stopAction.sa_mask);
+
+    // Restart interrupted system calls, so that e.g. the supervision of worker processes carries on while they stop
+    stopAction.sa_flags = SA_RESTART;
+
+    if ((0 != sigaction(SIGTERM, &stopAction, nullptr)) || (0 != sigaction(SIGUSR1, &stopAction, nullptr)))
+        std::cerr << "LArReco, unable to install signal handlers, SIGTERM and SIGUSR1 will not stop processing cleanly" << std::endl;
+}
 
-void CreatePandoraInstances(const Parameters &parameters, const Pandora *&pPrimaryPandora)
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int GetStopSignal()
 {
-    pPrimaryPandora = new Pandora();
-    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, LArContent::RegisterAlgorithms(*pPrimaryPandora));
-    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, LArContent::RegisterBasicPlugins(*pPrimaryPandora));
+    return g_stopSignal;
+}
 
-    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(*pPrimaryPandora,
-        "MyTrackShowerIdAlgorithm", new MyTrackShowerIdAlgorithm::Factory));
+//------------------------------------------------------------------------------------------------------------------------------------------
 
-    if (!pPrimaryPandora)
-        throw StatusCodeException(STATUS_CODE_FAILURE);
+int GetStoppedExitCode(const int errorNo)
+{
+    // Follow the shell convention for a process ended by a signal, so that batch systems see the job as incomplete
+    if ((0 == errorNo) && (0 != GetStopSignal()))
+        return 128 + GetStopSignal();
 
-    MultiPandoraApi::AddPrimaryPandoraInstance(pPrimaryPandora);
+    return errorNo;
+}
 
-    ProcessExternalParameters(parameters, pPrimaryPandora);
-    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetPseudoLayerPlugin(*pPrimaryPandora, new lar_content::LArPseudoLayerPlugin));
-    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetLArTransformationPlugin(*pPrimaryPandora, new lar_content::LArRotationalTransformationPlugin));
-    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::ReadSettings(*pPrimaryPandora, parameters.m_settingsFile));
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string GetDerivedFileName(const std::string &fileName, const std::string &suffix)
+{
+    const size_t extensionPosition(fileName.find_last_of('.'));
+    const size_t directoryPosition(fileName.find_last_of('/'));
+
+    if ((std::string::npos == extensionPosition) || ((std::string::npos != directoryPosition) && (extensionPosition < directoryPosition)))
+        return fileName + suffix;
+
+    return fileName.substr(0, extensionPosition) + suffix + fileName.substr(extensionPosition);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void ProcessEvents(const Parameters &parameters, const Pandora *const pPrimaryPandora)
+bool ApplyShard(Parameters &parameters)
 {
-    int nEvents(0);
+    EventFileList eventFileList;
+    unsigned int firstEvent(0), nEventsToProcess(0);
+    std::string outputFileName;
 
-    while ((nEvents++ < parameters.m_nEventsToProcess) || (0 > parameters.m_nEventsToProcess))
-    {
-        if (parameters.m_shouldDisplayEventNumber)
-            std::cout << std::endl << "   PROCESSING EVENT: " << (nEvents - 1) << std::endl << std::endl;
+    if (!PrepareEventDivision(parameters, eventFileList, firstEvent, nEventsToProcess, outputFileName))
+        return false;
 
-        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*pPrimaryPandora));
-        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(*pPrimaryPandora));
-    }
+    // Shards are contiguous, near-equal blocks of events, counted across the whole file list, so depend only upon the input and shard count
+    const unsigned int beginEvent(firstEvent + (static_cast<unsigned long>(nEventsToProcess) * parameters.m_shardIndex) / parameters.m_nShards);
+    const unsigned int endEvent(firstEvent + (static_cast<unsigned long>(nEventsToProcess) * (parameters.m_shardIndex + 1)) / parameters.m_nShards);
+    const std::string shardSuffix("_shard" + std::to_string(parameters.m_shardIndex) + "of" + std::to_string(parameters.m_nShards));
+
+    SetEventRange(eventFileList, firstEvent, beginEvent, endEvent, parameters);
+    parameters.m_outputFileName = GetDerivedFileName(outputFileName, shardSuffix);
+
+    if (!parameters.m_timingReportFile.empty())
+        parameters.m_timingReportFile = GetDerivedFileName(parameters.m_timingReportFile, shardSuffix);
+
+    if (!parameters.m_memoryReportFile.empty())
+        parameters.m_memoryReportFile = GetDerivedFileName(parameters.m_memoryReportFile, shardSuffix);
+
+    std::cout << "LArReco, shard " << parameters.m_shardIndex << " of " << parameters.m_nShards << ", events " << beginEvent << " to "
+              << (static_cast<int>(endEvent) - 1) << ", output file " << parameters.m_outputFileName << std::endl;
+
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-bool ParseCommandLine(int argc, char *argv[], Parameters &parameters)
+bool ApplyEventSelection(Parameters &parameters, std::string &temporaryFileName)
 {
-    if (1 == argc)
-        return PrintOptions();
+    EventFileList eventFileList;
+    unsigned int firstEvent(0), nEventsToProcess(0);
+    std::string outputFileName;
 
-    int c(0);
-    std::string recoOption;
+    if (!PrepareEventDivision(parameters, eventFileList, firstEvent, nEventsToProcess, outputFileName))
+        return false;
+
+    const unsigned int event(static_cast<unsigned int>(parameters.m_selectedEvent));
+    const unsigned int nEventsTotal(eventFileList.back().m_firstEvent + eventFileList.back().m_nEvents);
 
-    while ((c = getopt(argc, argv, "r:i:e:g:n:s:pNh")) != -1)
+    if (event >= nEventsTotal)
     {
-        switch (c)
+        std::cerr << "LArReco, event " << event << " not found, input files hold " << nEventsTotal << " events" << std::endl;
+        return false;
+    }
+
+    const EventFile &eventFile(eventFileList.at(FindEventFile(eventFileList, event)));
+    const std::string eventSuffix("_event" + std::to_string(event));
+
+    SetEventRange(eventFileList, firstEvent, event, event + 1, parameters);
+    parameters.m_outputFileName = GetDerivedFileName(outputFileName, eventSuffix);
+
+    if (!parameters.m_timingReportFile.empty())
+        parameters.m_timingReportFile = GetDerivedFileName(parameters.m_timingReportFile, eventSuffix);
+
+    if (!parameters.m_memoryReportFile.empty())
+        parameters.m_memoryReportFile = GetDerivedFileName(parameters.m_memoryReportFile, eventSuffix);
+
+    // Binary files are indexed, so the event can be copied straight out of the file list, else the reader skips through to it
+    if (EventFileIndex::IsIndexable(eventFile.m_fileName))
+    {
+        const char *const pTemporaryDirectory(std::getenv("TMPDIR"));
+        std::string fileNameTemplate(std::string(pTemporaryDirectory ? pTemporaryDirectory : "/tmp") + "/LArRecoEventXXXXXX.pndr");
+        const int fileDescriptor(mkstemps(&fileNameTemplate[0], 5));
+
+        if (fileDescriptor < 0)
         {
-        case 'r':
-            recoOption = optarg;
-            break;
-        case 'i':
-            parameters.m_settingsFile = optarg;
-            break;
-        case 'e':
-            parameters.m_eventFileNameList = optarg;
-            break;
-        case 'g':
-            parameters.m_geometryFileName = optarg;
-            break;
-        case 'n':
-            parameters.m_nEventsToProcess = atoi(optarg);
-            break;
-        case 's':
-            parameters.m_nEventsToSkip = atoi(optarg);
-            break;
-        case 'p':
-            parameters.m_printOverallRecoStatus = true;
-            break;
-        case 'N':
-            parameters.m_shouldDisplayEventNumber = true;
-            break;
-        case 'h':
-        default:
-            return PrintOptions();
+            std::cerr << "LArReco, unable to create temporary event file " << fileNameTemplate << std::endl;
+            return false;
+        }
+
+        close(fileDescriptor);
+        temporaryFileName = fileNameTemplate;
+
+        try
+        {
+            EventFileIndex(eventFile.m_fileName).WriteEventFile(event - eventFile.m_firstEvent, temporaryFileName);
+        }
+        catch (const StatusCodeException &statusCodeException)
+        {
+            std::cerr << "Pandora StatusCodeException: " << statusCodeException.ToString() << statusCodeException.GetBackTrace() << std::endl;
+            std::remove(temporaryFileName.c_str());
+            temporaryFileName.clear();
+            return false;
         }
+
+        parameters.m_eventFileNameList = temporaryFileName;
+        parameters.m_nEventsToSkip = 0;
     }
 
-    return ProcessRecoOption(recoOption, parameters);
+    std::cout << "LArReco, event " << event << ", from file " << eventFile.m_fileName << ", output file " << parameters.m_outputFileName << std::endl;
+
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-bool PrintOptions()
+void SetEventRange(const EventFileList &eventFileList, const unsigned int firstEvent, const unsigned int beginEvent, const unsigned int endEvent,
+    Parameters &parameters)
 {
-    std::cout << std::endl << "./bin/PandoraInterface " << std::endl
-              << "    -r RecoOption          (required) [Full, AllHitsCR, AllHitsNu, CRRemHitsSliceCR, CRRemHitsSliceNu, AllHitsSliceCR, AllHitsSliceNu]" << std::endl
-              << "    -i Settings            (required) [algorithm description: xml]" << std::endl
-              << "    -e EventFileList       (optional) [colon-separated list of files: xml/pndr]" << std::endl
-              << "    -g GeometryFile        (optional) [detector geometry description: xml/pndr]" << std::endl
-              << "    -n NEventsToProcess    (optional) [no. of events to process]" << std::endl
-              << "    -s NEventsToSkip       (optional) [no. of events to skip in first file]" << std::endl
-              << "    -p                     (optional) [print status]" << std::endl
-              << "    -N                     (optional) [print event numbers]" << std::endl << std::endl;
+    const unsigned int iFile(FindEventFile(eventFileList, beginEvent));
+    parameters.m_eventFileNameList.clear();
 
-    return false;
+    for (unsigned int jFile = iFile; jFile < eventFileList.size(); ++jFile)
+        parameters.m_eventFileNameList += (parameters.m_eventFileNameList.empty() ? "" : ":") + eventFileList.at(jFile).m_fileName;
+
+    parameters.m_nEventsToSkip = static_cast<int>(beginEvent - eventFileList.at(iFile).m_firstEvent);
+    parameters.m_nEventsToProcess = static_cast<int>(endEvent - beginEvent);
+    parameters.m_firstEventId += beginEvent - firstEvent;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-bool ProcessRecoOption(const std::string &recoOption, Parameters &parameters)
+int ProcessEventsInWorkers(const Parameters &parameters)
 {
-    std::string chosenRecoOption(recoOption);
-    std::transform(chosenRecoOption.begin(), chosenRecoOption.end(), chosenRecoOption.begin(), ::tolower);
+    EventFileList eventFileList;
+    unsigned int firstEvent(0), nEventsToProcess(0);
+    std::string outputFileName;
 
-    if ("full" == chosenRecoOption)
+    if (!PrepareEventDivision(parameters, eventFileList, firstEvent, nEventsToProcess, outputFileName))
+        return 1;
+
+    // Give each worker a contiguous, disjoint block of events, which it may read across several files
+    const unsigned int nWorkers(parameters.m_nWorkerProcesses);
+    const std::string outputFileStem(outputFileName.substr(0, outputFileName.find_last_of('.')));
+    StringVector workerFileNames;
+    std::vector<pid_t> workerPids;
+    int errorNo(0);
+    std::cout.flush();
+    std::cerr.flush();
+
+    for (unsigned int iWorker = 0; iWorker < nWorkers; ++iWorker)
     {
-        parameters.m_shouldRunAllHitsCosmicReco = true;
-        parameters.m_shouldRunStitching = true;
-        parameters.m_shouldRunCosmicHitRemoval = true;
-        parameters.m_shouldRunSlicing = true;
-        parameters.m_shouldRunNeutrinoRecoOption = true;
-        parameters.m_shouldRunCosmicRecoOption = true;
-        parameters.m_shouldPerformSliceId = true;
+        const unsigned int beginEvent(firstEvent + (static_cast<unsigned long>(nEventsToProcess) * iWorker) / nWorkers);
+        const unsigned int endEvent(firstEvent + (static_cast<unsigned long>(nEventsToProcess) * (iWorker + 1)) / nWorkers);
+
+        if (beginEvent == endEvent)
+            continue;
+
+        Parameters workerParameters(parameters);
+        workerParameters.m_nWorkerProcesses = 1;
+        SetEventRange(eventFileList, firstEvent, beginEvent, endEvent, workerParameters);
+        workerParameters.m_outputFileName = outputFileStem + "_worker" + std::to_string(iWorker) + ".root";
+
+        if (!parameters.m_timingReportFile.empty())
+            workerParameters.m_timingReportFile = GetDerivedFileName(parameters.m_timingReportFile, "_worker" + std::to_string(iWorker));
+
+        if (!parameters.m_memoryReportFile.empty())
+            workerParameters.m_memoryReportFile = GetDerivedFileName(parameters.m_memoryReportFile, "_worker" + std::to_string(iWorker));
+
+        const pid_t pid(fork());
+
+        if (pid < 0)
+        {
+            std::cerr << "LArReco, unable to fork worker process " << iWorker << std::endl;
+            errorNo = 1;
+            break;
+        }
+
+        if (0 == pid)
+        {
+            const int workerErrorNo((workerParameters.m_nReadAheadEvents > 0) ? ProcessEventsWithReadAhead(workerParameters) : RunPandora(workerParameters));
+            Logger::Flush();
+            std::cout.flush();
+            std::cerr.flush();
+            _exit(workerErrorNo);
+        }
+
+        std::cout << "LArReco, started worker process " << iWorker << " (pid " << pid << "), events " << beginEvent << " to " << (endEvent - 1) << std::endl;
+        workerFileNames.push_back(workerParameters.m_outputFileName);
+        workerPids.push_back(pid);
     }
-    else if ("allhitscr" == chosenRecoOption)
+
+    // Supervise the workers, collecting their exit codes
+    for (const pid_t pid : workerPids)
     {
-        parameters.m_shouldRunAllHitsCosmicReco = true;
-        parameters.m_shouldRunStitching = true;
-        parameters.m_shouldRunCosmicHitRemoval = false;
-        parameters.m_shouldRunSlicing = false;
-        parameters.m_shouldRunNeutrinoRecoOption = false;
-        parameters.m_shouldRunCosmicRecoOption = false;
-        parameters.m_shouldPerformSliceId = false;
+        int status(0);
+
+        if ((waitpid(pid, &status, 0) < 0) || !WIFEXITED(status) || (0 != WEXITSTATUS(status)))
+        {
+            std::cerr << "LArReco, worker process " << pid << " failed" << (WIFSIGNALED(status) ? " (signal " + std::to_string(WTERMSIG(status)) + ")" : "") << std::endl;
+            errorNo = 1;
+        }
     }
-    else if ("allhitsnu" == chosenRecoOption)
+
+    if (0 != errorNo)
     {
-        parameters.m_shouldRunAllHitsCosmicReco = false;
-        parameters.m_shouldRunStitching = false;
-        parameters.m_shouldRunCosmicHitRemoval = false;
-        parameters.m_shouldRunSlicing = false;
-        parameters.m_shouldRunNeutrinoRecoOption = true;
-        parameters.m_shouldRunCosmicRecoOption = false;
-        parameters.m_shouldPerformSliceId = false;
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "LArReco, worker output files have been left unmerged");
+        return errorNo;
     }
-    else if ("crremhitsslicecr" == chosenRecoOption)
+
+    // Depending upon the OutputFormat setting, each worker may have written a root file, a columnar file, or both
+    StringVector existingFileNames, existingColumnFileNames;
+
+    for (const std::string &workerFileName : workerFileNames)
     {
-        parameters.m_shouldRunAllHitsCosmicReco = true;
-        parameters.m_shouldRunStitching = true;
-        parameters.m_shouldRunCosmicHitRemoval = true;
-        parameters.m_shouldRunSlicing = true;
-        parameters.m_shouldRunNeutrinoRecoOption = false;
-        parameters.m_shouldRunCosmicRecoOption = true;
-        parameters.m_shouldPerformSliceId = false;
+        if (0 == access(workerFileName.c_str(), F_OK))
+            existingFileNames.push_back(workerFileName);
+
+        if (0 == access(GetColumnFileName(workerFileName).c_str(), F_OK))
+            existingColumnFileNames.push_back(GetColumnFileName(workerFileName));
     }
-    else if ("crremhitsslicenu" == chosenRecoOption)
+
+    OutputTuning outputTuning;
+    ReadOutputTuning(parameters, outputTuning);
+
+    if (!existingFileNames.empty() && !MergeOutputFiles(existingFileNames, outputFileName, outputTuning))
     {
-        parameters.m_shouldRunAllHitsCosmicReco = true;
-        parameters.m_shouldRunStitching = true;
-        parameters.m_shouldRunCosmicHitRemoval = true;
-        parameters.m_shouldRunSlicing = true;
-        parameters.m_shouldRunNeutrinoRecoOption = true;
-        parameters.m_shouldRunCosmicRecoOption = false;
-        parameters.m_shouldPerformSliceId = false;
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "LArReco, unable to merge worker output files into " << outputFileName);
+        return 1;
     }
-    else if ("allhitsslicecr" == chosenRecoOption)
+
+    if (!existingColumnFileNames.empty() && !MergeColumnFiles(existingColumnFileNames, std::vector<UIntVector>(), GetColumnFileName(outputFileName)))
     {
-        parameters.m_shouldRunAllHitsCosmicReco = false;
-        parameters.m_shouldRunStitching = false;
-        parameters.m_shouldRunCosmicHitRemoval = false;
-        parameters.m_shouldRunSlicing = true;
-        parameters.m_shouldRunNeutrinoRecoOption = false;
-        parameters.m_shouldRunCosmicRecoOption = true;
-        parameters.m_shouldPerformSliceId = false;
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "LArReco, unable to merge worker columnar files into " << GetColumnFileName(outputFileName));
+        return 1;
     }
-    else if ("allhitsslicenu" == chosenRecoOption)
+
+    for (const std::string &workerFileName : existingFileNames)
+        std::remove(workerFileName.c_str());
+
+    for (const std::string &workerColumnFileName : existingColumnFileNames)
+        std::remove(workerColumnFileName.c_str());
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int ProcessEventsInThreads(const Parameters &parameters)
+{
+    EventFileList eventFileList;
+    unsigned int firstEvent(0), nEventsToProcess(0);
+    std::string outputFileName;
+
+    if (!PrepareEventDivision(parameters, eventFileList, firstEvent, nEventsToProcess, outputFileName))
+        return 1;
+
+    // Each thread owns a full set of pandora instances, created up front as MultiPandoraApi book-keeping is not thread safe
+    ROOT::EnableThreadSafety();
+
+    std::vector<const Pandora*> primaryPandoraList;
+    StringVector threadFileNames;
+    std::unique_ptr<AlgorithmTimer> pAlgorithmTimer(parameters.m_timingReportFile.empty() ? nullptr : new AlgorithmTimer(parameters.m_timingReportFile));
+    int errorNo(0);
+
+    try
     {
-        parameters.m_shouldRunAllHitsCosmicReco = false;
-        parameters.m_shouldRunStitching = false;
-        parameters.m_shouldRunCosmicHitRemoval = false;
-        parameters.m_shouldRunSlicing = true;
-        parameters.m_shouldRunNeutrinoRecoOption = true;
-        parameters.m_shouldRunCosmicRecoOption = false;
-        parameters.m_shouldPerformSliceId = false;
+        CreatePandoraInstanceSets(parameters, outputFileName, "_thread", parameters.m_nWorkerThreads, pAlgorithmTimer.get(), primaryPandoraList, threadFileNames);
     }
-    else
+    catch (const StatusCodeException &statusCodeException)
     {
-        std::cout << "LArReco, Unrecognized reconstruction option: " << recoOption << std::endl << std::endl;
-        return PrintOptions();
+        std::cerr << "Pandora StatusCodeException: " << statusCodeException.ToString() << statusCodeException.GetBackTrace() << std::endl;
+        errorNo = 1;
     }
 
-    return true;
+    // Threads pull event numbers from a shared, lock-free queue; a failing thread drains the queue to stop the others
+    const unsigned int endEvent(firstEvent + nEventsToProcess);
+    std::atomic<unsigned int> nextEvent((0 == errorNo) ? firstEvent : endEvent);
+    std::vector<UIntVector> threadEventLists(primaryPandoraList.size());
+    IntVector threadErrorNos(primaryPandoraList.size(), 0);
+    std::vector<std::thread> threads;
+
+    for (unsigned int iThread = 0; iThread < primaryPandoraList.size(); ++iThread)
+    {
+        threads.emplace_back([&, iThread]()
+        {
+            try
+            {
+                ProcessEventQueue(parameters, primaryPandoraList.at(iThread), eventFileList, endEvent, nextEvent, threadEventLists.at(iThread));
+            }
+            catch (const StatusCodeException &statusCodeException)
+            {
+                std::cerr << "Pandora StatusCodeException: " << statusCodeException.ToString() << statusCodeException.GetBackTrace() << std::endl;
+                threadErrorNos.at(iThread) = 1;
+                nextEvent = endEvent;
+            }
+            catch (...)
+            {
+                std::cerr << "Unknown exception: " << std::endl;
+                threadErrorNos.at(iThread) = 1;
+                nextEvent = endEvent;
+            }
+        });
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    // Deleting the instances closes the per-thread output files
+    for (const Pandora *const pPrimaryPandora : primaryPandoraList)
+        MultiPandoraApi::DeletePandoraInstances(pPrimaryPandora);
+
+    // The timer is shared by all threads, so the report covers every event processed
+    if (pAlgorithmTimer)
+        pAlgorithmTimer->WriteReport();
+
+    for (const int threadErrorNo : threadErrorNos)
+        errorNo = std::max(errorNo, threadErrorNo);
+
+    if (0 != errorNo)
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "LArReco, thread output files have been left unmerged");
+        return errorNo;
+    }
+
+    if (0 != GetStopSignal())
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_INFO, "LArReco, received signal " << GetStopSignal() << ", merging the events processed so far");
+
+    return GetStoppedExitCode(MergeOutputFilesByEvent(parameters, firstEvent, threadFileNames, threadEventLists, outputFileName));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void ProcessExternalParameters(const Parameters &parameters, const Pandora *const pPandora)
+int ProcessEventsWithReadAhead(const Parameters &parameters)
 {
-    auto pEventReadingParameters = new lar_content::EventReadingAlgorithm::ExternalEventReadingParameters;
-    pEventReadingParameters->m_geometryFileName = parameters.m_geometryFileName;
-    pEventReadingParameters->m_eventFileNameList = parameters.m_eventFileNameList;
-    if (parameters.m_nEventsToSkip.IsInitialized()) pEventReadingParameters->m_skipToEvent = parameters.m_nEventsToSkip.Get();
-    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetExternalParameters(*pPandora, "LArEventReading", pEventReadingParameters));
+    EventFileList eventFileList;
+    unsigned int firstEvent(0), nEventsToProcess(0);
+    std::string outputFileName;
 
-    pEventReadingParameters = new lar_content::EventReadingAlgorithm::ExternalEventReadingParameters;
-    pEventReadingParameters->m_eventFileNameList = parameters.m_eventFileNameList;
-    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetExternalParameters(*pPandora, "MyTrackShowerIdAlgorithm", pEventReadingParameters));
-
-    auto *const pEventSteeringParameters = new lar_content::MasterAlgorithm::ExternalSteeringParameters;
-    pEventSteeringParameters->m_shouldRunAllHitsCosmicReco = parameters.m_shouldRunAllHitsCosmicReco;
-    pEventSteeringParameters->m_shouldRunStitching = parameters.m_shouldRunStitching;
-    pEventSteeringParameters->m_shouldRunCosmicHitRemoval = parameters.m_shouldRunCosmicHitRemoval;
-    pEventSteeringParameters->m_shouldRunSlicing = parameters.m_shouldRunSlicing;
-    pEventSteeringParameters->m_shouldRunNeutrinoRecoOption = parameters.m_shouldRunNeutrinoRecoOption;
-    pEventSteeringParameters->m_shouldRunCosmicRecoOption = parameters.m_shouldRunCosmicRecoOption;
-    pEventSteeringParameters->m_shouldPerformSliceId = parameters.m_shouldPerformSliceId;
-    pEventSteeringParameters->m_printOverallRecoStatus = parameters.m_printOverallRecoStatus;
-    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetExternalParameters(*pPandora, "LArMaster", pEventSteeringParameters));
+    if (!PrepareEventDivision(parameters, eventFileList, firstEvent, nEventsToProcess, outputFileName))
+        return 1;
+
+    // Events are read into otherwise idle sets of pandora instances by a decoding thread, while the event in the busy set is reconstructed
+    std::vector<const Pandora*> primaryPandoraList;
+    StringVector slotFileNames;
+    std::unique_ptr<AlgorithmTimer> pAlgorithmTimer(parameters.m_timingReportFile.empty() ? nullptr : new AlgorithmTimer(parameters.m_timingReportFile));
+    int errorNo(0);
+
+    try
+    {
+        CreatePandoraInstanceSets(parameters, outputFileName, "_readahead", parameters.m_nReadAheadEvents + 1, pAlgorithmTimer.get(), primaryPandoraList,
+            slotFileNames);
+    }
+    catch (const StatusCodeException &statusCodeException)
+    {
+        std::cerr << "Pandora StatusCodeException: " << statusCodeException.ToString() << statusCodeException.GetBackTrace() << std::endl;
+        errorNo = 1;
+    }
+
+    // Slots cycle from the free queue, through decoding, to the ready queue, and back once reconstructed; the ready queue is in event order
+    const unsigned int endEvent(firstEvent + nEventsToProcess);
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<unsigned int> freeSlots;
+    std::deque<std::pair<unsigned int, unsigned int>> readySlots;
+    bool isDecodingFinished(false), isProcessingStopped(0 != errorNo);
+    int decodingErrorNo(0);
+
+    for (unsigned int iSlot = 0; iSlot < primaryPandoraList.size(); ++iSlot)
+        freeSlots.push_back(iSlot);
+
+    std::thread decodingThread([&]()
+    {
+        // Each slot keeps its reader position, and the events given to a slot increase, so each slot makes a single pass over each file
+        std::vector<std::unique_ptr<EventFileCursor>> eventFileCursors;
+
+        for (const Pandora *const pPrimaryPandora : primaryPandoraList)
+            eventFileCursors.emplace_back(new EventFileCursor(*pPrimaryPandora, eventFileList));
+
+        try
+        {
+            for (unsigned int event = firstEvent; event < endEvent; ++event)
+            {
+                std::unique_lock<std::mutex> queueLock(queueMutex);
+                queueCondition.wait(queueLock, [&]() {return (isProcessingStopped || !freeSlots.empty());});
+
+                if (isProcessingStopped)
+                    break;
+
+                const unsigned int iSlot(freeSlots.front());
+                freeSlots.pop_front();
+                queueLock.unlock();
+
+                eventFileCursors.at(iSlot)->ReadEvent(event);
+
+                queueLock.lock();
+                readySlots.emplace_back(iSlot, event);
+                queueCondition.notify_all();
+            }
+        }
+        catch (const StatusCodeException &statusCodeException)
+        {
+            std::cerr << "Pandora StatusCodeException: " << statusCodeException.ToString() << statusCodeException.GetBackTrace() << std::endl;
+            decodingErrorNo = 1;
+        }
+        catch (...)
+        {
+            std::cerr << "Unknown exception: " << std::endl;
+            decodingErrorNo = 1;
+        }
+
+        std::lock_guard<std::mutex> queueLock(queueMutex);
+        isDecodingFinished = true;
+        queueCondition.notify_all();
+    });
+
+    std::vector<UIntVector> slotEventLists(primaryPandoraList.size());
+
+    try
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> queueLock(queueMutex);
+            queueCondition.wait(queueLock, [&]() {return (isProcessingStopped || isDecodingFinished || !readySlots.empty());});
+
+            if (isProcessingStopped || readySlots.empty() || (0 != GetStopSignal()))
+                break;
+
+            const unsigned int iSlot(readySlots.front().first), event(readySlots.front().second);
+            readySlots.pop_front();
+            queueLock.unlock();
+
+            if (parameters.m_shouldDisplayEventNumber)
+                std::cout << std::endl << "   PROCESSING EVENT: " << event << std::endl << std::endl;
+
+            PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*primaryPandoraList.at(iSlot)));
+            PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(*primaryPandoraList.at(iSlot)));
+            slotEventLists.at(iSlot).push_back(event);
+
+            queueLock.lock();
+            freeSlots.push_back(iSlot);
+            queueCondition.notify_all();
+        }
+    }
+    catch (const StatusCodeException &statusCodeException)
+    {
+        std::cerr << "Pandora StatusCodeException: " << statusCodeException.ToString() << statusCodeException.GetBackTrace() << std::endl;
+        errorNo = 1;
+    }
+    catch (const StopProcessingException &)
+    {
+        // Exit gracefully, keeping the events reconstructed so far
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception: " << std::endl;
+        errorNo = 1;
+    }
+
+    {
+        std::lock_guard<std::mutex> queueLock(queueMutex);
+        isProcessingStopped = true;
+        queueCondition.notify_all();
+    }
+
+    decodingThread.join();
+    errorNo = std::max(errorNo, decodingErrorNo);
+
+    // Deleting the instances closes the per-slot output files
+    for (const Pandora *const pPrimaryPandora : primaryPandoraList)
+        MultiPandoraApi::DeletePandoraInstances(pPrimaryPandora);
+
+    if (pAlgorithmTimer)
+        pAlgorithmTimer->WriteReport();
+
+    if (0 != errorNo)
+    {
+        std::cerr << "LArReco, read-ahead output files have been left unmerged" << std::endl;
+        return errorNo;
+    }
+
+    if (0 != GetStopSignal())
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_INFO, "LArReco, received signal " << GetStopSignal() << ", merging the events processed so far");
+
+    return GetStoppedExitCode(MergeOutputFilesByEvent(parameters, firstEvent, slotFileNames, slotEventLists, outputFileName));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int ProcessEventsWithResume(const Parameters &parameters)
+{
+    EventFileList eventFileList;
+    unsigned int firstEvent(0), nEventsToProcess(0);
+    std::string outputFileName;
+
+    if (!PrepareEventDivision(parameters, eventFileList, firstEvent, nEventsToProcess, outputFileName))
+        return 1;
+
+    // The output of the interrupted job is set aside while the remaining events are processed into a separate file, then the two are merged
+    const std::string checkpointFileName(GetDerivedFileName(outputFileName, "_checkpoint"));
+    const std::string resumedFileName(GetDerivedFileName(outputFileName, "_resumed"));
+    OutputTuning outputTuning;
+    ReadOutputTuning(parameters, outputTuning);
+
+    // A resumed job may itself have been interrupted before its files were merged
+    if (0 == access(checkpointFileName.c_str(), F_OK))
+    {
+        if (0 == access(outputFileName.c_str(), F_OK))
+        {
+            std::remove(checkpointFileName.c_str());
+            std::remove(GetColumnFileName(checkpointFileName).c_str());
+            std::remove(resumedFileName.c_str());
+            std::remove(GetColumnFileName(resumedFileName).c_str());
+        }
+        else if (!MergeResumedOutputFiles(checkpointFileName, resumedFileName, outputFileName, outputTuning))
+        {
+            return 1;
+        }
+    }
+
+    if (0 != access(outputFileName.c_str(), F_OK))
+    {
+        std::cout << "LArReco, no output file " << outputFileName << " to resume, processing all events" << std::endl;
+        return RunPandora(parameters);
+    }
+
+    OutputCheckpoint::Record record{0, 0, 0};
+
+    if (!ReadOutputCheckpoint(outputFileName, record) || (record.m_nextEventId < parameters.m_firstEventId))
+    {
+        std::cerr << "LArReco, output file " << outputFileName << " holds no checkpoint, so cannot be resumed (see the CheckpointEvents setting)" << std::endl;
+        return 1;
+    }
+
+    const unsigned int nEventsDone(record.m_nextEventId - parameters.m_firstEventId);
+
+    if (nEventsDone >= nEventsToProcess)
+    {
+        std::cout << "LArReco, output file " << outputFileName << " already holds all " << nEventsToProcess << " events" << std::endl;
+        return 0;
+    }
+
+    if ((0 != std::rename(outputFileName.c_str(), checkpointFileName.c_str())) ||
+        ((0 == access(GetColumnFileName(outputFileName).c_str(), F_OK)) &&
+            (0 != std::rename(GetColumnFileName(outputFileName).c_str(), GetColumnFileName(checkpointFileName).c_str()))))
+    {
+        std::cerr << "LArReco, unable to set aside output file " << outputFileName << std::endl;
+        return 1;
+    }
+
+    Parameters resumedParameters(parameters);
+    SetEventRange(eventFileList, firstEvent, firstEvent + nEventsDone, firstEvent + nEventsToProcess, resumedParameters);
+    resumedParameters.m_outputFileName = resumedFileName;
+
+    std::cout << "LArReco, resuming " << outputFileName << " after " << nEventsDone << " events, at event id " << record.m_nextEventId << std::endl;
+    const int errorNo(RunPandora(resumedParameters));
+
+    // Merge even if this job was also interrupted, so that a further resume continues from its last checkpoint
+    if (!MergeResumedOutputFiles(checkpointFileName, resumedFileName, outputFileName, outputTuning))
+        return 1;
+
+    return errorNo;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ProcessEventQueue(const Parameters &parameters, const Pandora *const pPrimaryPandora, const EventFileList &eventFileList, const unsigned int endEvent,
+    std::atomic<unsigned int> &nextEvent, UIntVector &processedEvents)
+{
+    // The events claimed by a thread increase, so its cursor skips forward over those claimed by other threads rather than rescanning
+    EventFileCursor eventFileCursor(*pPrimaryPandora, eventFileList);
+
+    for (unsigned int event = nextEvent++; event < endEvent; event = nextEvent++)
+    {
+        if (0 != GetStopSignal())
+            break;
+
+        if (parameters.m_shouldDisplayEventNumber)
+            std::cout << std::endl << "   PROCESSING EVENT: " << event << std::endl << std::endl;
+
+        eventFileCursor.ReadEvent(event);
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*pPrimaryPandora));
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(*pPrimaryPandora));
+        processedEvents.push_back(event);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void CreatePandoraInstances(const Parameters &parameters, const Pandora *&pPrimaryPandora, AlgorithmTimer *const pAlgorithmTimer)
+{
+    // A binary copy of the geometry stands in for the xml original when a cache is in use
+    Parameters instanceParameters(parameters);
+
+    if (!parameters.m_cacheDirectory.empty())
+    {
+        const ConfigurationCache configurationCache(parameters.m_cacheDirectory);
+        instanceParameters.m_geometryFileName = configurationCache.GetCachedGeometryFile(parameters.m_geometryFileName);
+    }
+
+    pPrimaryPandora = new Pandora();
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, LArContent::RegisterAlgorithms(*pPrimaryPandora));
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, LArContent::RegisterBasicPlugins(*pPrimaryPandora));
+
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(*pPrimaryPandora,
+        "MyTrackShowerIdAlgorithm", new MyTrackShowerIdAlgorithm::Factory));
+
+    if (pAlgorithmTimer)
+    {
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(*pPrimaryPandora,
+            AlgorithmTimer::MARKER_ALGORITHM_TYPE, new TimingMarkerAlgorithm::Factory(pAlgorithmTimer)));
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(*pPrimaryPandora,
+            AlgorithmTimer::MASTER_ALGORITHM_TYPE, new TimingMasterAlgorithm::Factory(pAlgorithmTimer)));
+    }
+
+    if (!pPrimaryPandora)
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+
+    MultiPandoraApi::AddPrimaryPandoraInstance(pPrimaryPandora);
+
+    ProcessExternalParameters(instanceParameters, pPrimaryPandora);
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetPseudoLayerPlugin(*pPrimaryPandora, new lar_content::LArPseudoLayerPlugin));
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetLArTransformationPlugin(*pPrimaryPandora, new lar_content::LArRotationalTransformationPlugin));
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::ReadSettings(*pPrimaryPandora,
+        pAlgorithmTimer ? pAlgorithmTimer->GetInstrumentedSettingsFile(instanceParameters.m_settingsFile) : instanceParameters.m_settingsFile));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void CreatePandoraInstanceSets(const Parameters &parameters, const std::string &outputFileName, const std::string &suffix, const unsigned int nSets,
+    AlgorithmTimer *const pAlgorithmTimer, std::vector<const Pandora*> &primaryPandoraList, StringVector &outputFileNames)
+{
+    const std::string outputFileStem(outputFileName.substr(0, outputFileName.find_last_of('.')));
+
+    for (unsigned int iSet = 0; iSet < nSets; ++iSet)
+    {
+        // Events are read by the caller, so the event reading algorithm just provides the geometry
+        Parameters setParameters(parameters);
+        setParameters.m_eventFileNameList.clear();
+        setParameters.m_nEventsToSkip = 0;
+        setParameters.m_firstEventId = 0;
+        setParameters.m_outputFileName = outputFileStem + suffix + std::to_string(iSet) + ".root";
+
+        const Pandora *pPrimaryPandora(nullptr);
+
+        try
+        {
+            CreatePandoraInstances(setParameters, pPrimaryPandora, pAlgorithmTimer);
+        }
+        catch (const StatusCodeException &)
+        {
+            // Hand any partially configured instances to the caller for deletion
+            if (pPrimaryPandora)
+                primaryPandoraList.push_back(pPrimaryPandora);
+
+            throw;
+        }
+
+        primaryPandoraList.push_back(pPrimaryPandora);
+        outputFileNames.push_back(setParameters.m_outputFileName);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ProcessEvents(const Parameters &parameters, const Pandora *const pPrimaryPandora, MemoryMonitor *const pMemoryMonitor)
+{
+    int nEvents(0);
+
+    while ((nEvents++ < parameters.m_nEventsToProcess) || (0 > parameters.m_nEventsToProcess))
+    {
+        if (0 != GetStopSignal())
+        {
+            std::cout << "LArReco, received signal " << GetStopSignal() << ", stopping after " << (nEvents - 1) << " events" << std::endl;
+            break;
+        }
+
+        if (parameters.m_shouldDisplayEventNumber)
+            std::cout << std::endl << "   PROCESSING EVENT: " << (nEvents - 1) << std::endl << std::endl;
+
+        if (pMemoryMonitor)
+            pMemoryMonitor->BeginEvent(parameters.m_firstEventId + nEvents - 1);
+
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*pPrimaryPandora));
+
+        if (pMemoryMonitor)
+            pMemoryMonitor->EndEventProcessing();
+
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::Reset(*pPrimaryPandora));
+
+        if (pMemoryMonitor)
+            pMemoryMonitor->EndEvent();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool ParseCommandLine(int argc, char *argv[], Parameters &parameters)
+{
+    if (1 == argc)
+        return PrintOptions();
+
+    int c(0);
+    std::string recoOption;
+    const struct option longOptions[] = {{"shard", required_argument, nullptr, 'S'}, {"event", required_argument, nullptr, 'E'},
+        {"resume", no_argument, nullptr, 'R'}, {nullptr, 0, nullptr, 0}};
+
+    while ((c = getopt_long(argc, argv, "r:i:e:g:n:s:j:t:q:T:M:c:pNh", longOptions, nullptr)) != -1)
+    {
+        switch (c)
+        {
+        case 'r':
+            recoOption = optarg;
+            break;
+        case 'i':
+            parameters.m_settingsFile = optarg;
+            break;
+        case 'e':
+            parameters.m_eventFileNameList = optarg;
+            break;
+        case 'g':
+            parameters.m_geometryFileName = optarg;
+            break;
+        case 'n':
+            parameters.m_nEventsToProcess = atoi(optarg);
+            break;
+        case 's':
+            parameters.m_nEventsToSkip = atoi(optarg);
+            break;
+        case 'p':
+            parameters.m_printOverallRecoStatus = true;
+            break;
+        case 'N':
+            parameters.m_shouldDisplayEventNumber = true;
+            break;
+        case 'j':
+            parameters.m_nWorkerProcesses = atoi(optarg);
+            break;
+        case 't':
+            parameters.m_nWorkerThreads = atoi(optarg);
+            break;
+        case 'q':
+            parameters.m_nReadAheadEvents = atoi(optarg);
+            break;
+        case 'T':
+            parameters.m_timingReportFile = optarg;
+            break;
+        case 'M':
+            parameters.m_memoryReportFile = optarg;
+            break;
+        case 'c':
+            parameters.m_cacheDirectory = optarg;
+            break;
+        case 'S':
+            if (!ParseShardOption(optarg, parameters))
+                return PrintOptions();
+            break;
+        case 'E':
+            parameters.m_selectedEvent = atoi(optarg);
+            if (parameters.m_selectedEvent < 0)
+                return PrintOptions();
+            break;
+        case 'R':
+            parameters.m_shouldResume = true;
+            break;
+        case 'h':
+        default:
+            return PrintOptions();
+        }
+    }
+
+    if ((parameters.m_nWorkerProcesses > 1) && (parameters.m_nWorkerThreads > 1))
+    {
+        std::cout << "LArReco, worker processes and worker threads cannot be combined" << std::endl << std::endl;
+        return PrintOptions();
+    }
+
+    if ((parameters.m_nReadAheadEvents > 0) && (parameters.m_nWorkerThreads > 1))
+    {
+        std::cout << "LArReco, read-ahead and worker threads cannot be combined" << std::endl << std::endl;
+        return PrintOptions();
+    }
+
+    if (!parameters.m_memoryReportFile.empty() && ((parameters.m_nReadAheadEvents > 0) || (parameters.m_nWorkerThreads > 1)))
+    {
+        std::cout << "LArReco, memory tracking requires events to be processed one at a time, without read-ahead or worker threads" << std::endl << std::endl;
+        return PrintOptions();
+    }
+
+    if ((parameters.m_selectedEvent >= 0) && ((parameters.m_nShards > 1) || (parameters.m_nWorkerProcesses > 1) || (parameters.m_nWorkerThreads > 1) ||
+        (parameters.m_nReadAheadEvents > 0) || parameters.m_nEventsToSkip.IsInitialized()))
+    {
+        std::cout << "LArReco, a selected event cannot be combined with event skipping, shards, worker processes, worker threads or read-ahead"
+                  << std::endl << std::endl;
+        return PrintOptions();
+    }
+
+    if (parameters.m_shouldResume && ((parameters.m_nWorkerProcesses > 1) || (parameters.m_nWorkerThreads > 1) || (parameters.m_nReadAheadEvents > 0) ||
+        (parameters.m_selectedEvent >= 0)))
+    {
+        std::cout << "LArReco, resuming requires events to be processed in order by a single process, without worker processes, worker threads, "
+                  << "read-ahead or a selected event" << std::endl << std::endl;
+        return PrintOptions();
+    }
+
+    return ProcessRecoOption(recoOption, parameters);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool PrintOptions()
+{
+    std::cout << std::endl << "./bin/PandoraInterface " << std::endl
+              << "    -r RecoOption          (required) [Full, AllHitsCR, AllHitsNu, CRRemHitsSliceCR, CRRemHitsSliceNu, AllHitsSliceCR, AllHitsSliceNu]" << std::endl
+              << "    -i Settings            (required) [algorithm description: xml]" << std::endl
+              << "    -e EventFileList       (optional) [colon-separated list of files: xml/pndr]" << std::endl
+              << "    -g GeometryFile        (optional) [detector geometry description: xml/pndr]" << std::endl
+              << "    -n NEventsToProcess    (optional) [no. of events to process]" << std::endl
+              << "    -s NEventsToSkip       (optional) [no. of events to skip in first file]" << std::endl
+              << "    -p                     (optional) [print status]" << std::endl
+              << "    -N                     (optional) [print event numbers]" << std::endl
+              << "    -j NWorkerProcesses    (optional) [no. of worker processes between which to divide events]" << std::endl
+              << "    -t NWorkerThreads      (optional) [no. of threads, each with its own pandora instances, between which to share events]" << std::endl
+              << "    -q ReadAheadDepth      (optional) [no. of events to decode in the background ahead of reconstruction]" << std::endl
+              << "    -T TimingReportFile    (optional) [per-algorithm timing summary: csv/json]" << std::endl
+              << "    -M MemoryReportFile    (optional) [per-event rss and heap growth, largest first: csv/json]" << std::endl
+              << "    -c CacheDirectory      (optional) [directory in which to cache binary copies of xml geometry]" << std::endl
+              << "    --shard i/N            (optional) [process only shard i (from 0) of N, dividing events evenly across all files]" << std::endl
+              << "    --event N              (optional) [process only event N (from 0), numbered across all files]" << std::endl
+              << "    --resume               (optional) [continue an interrupted job from the last checkpoint of its output file]" << std::endl << std::endl;
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool ParseShardOption(const std::string &shardOption, Parameters &parameters)
+{
+    const size_t separatorPosition(shardOption.find('/'));
+
+    try
+    {
+        if (std::string::npos != separatorPosition)
+        {
+            const int shardIndex(std::stoi(shardOption.substr(0, separatorPosition)));
+            const int nShards(std::stoi(shardOption.substr(separatorPosition + 1)));
+
+            if ((shardIndex >= 0) && (nShards > 0) && (shardIndex < nShards))
+            {
+                parameters.m_shardIndex = static_cast<unsigned int>(shardIndex);
+                parameters.m_nShards = static_cast<unsigned int>(nShards);
+                return true;
+            }
+        }
+    }
+    catch (const std::exception &)
+    {
+    }
+
+    std::cout << "LArReco, invalid shard " << shardOption << ", expected i/N with 0 <= i < N" << std::endl << std::endl;
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool ProcessRecoOption(const std::string &recoOption, Parameters &parameters)
+{
+    std::string chosenRecoOption(recoOption);
+    std::transform(chosenRecoOption.begin(), chosenRecoOption.end(), chosenRecoOption.begin(), ::tolower);
+
+    if ("full" == chosenRecoOption)
+    {
+        parameters.m_shouldRunAllHitsCosmicReco = true;
+        parameters.m_shouldRunStitching = true;
+        parameters.m_shouldRunCosmicHitRemoval = true;
+        parameters.m_shouldRunSlicing = true;
+        parameters.m_shouldRunNeutrinoRecoOption = true;
+        parameters.m_shouldRunCosmicRecoOption = true;
+        parameters.m_shouldPerformSliceId = true;
+    }
+    else if ("allhitscr" == chosenRecoOption)
+    {
+        parameters.m_shouldRunAllHitsCosmicReco = true;
+        parameters.m_shouldRunStitching = true;
+        parameters.m_shouldRunCosmicHitRemoval = false;
+        parameters.m_shouldRunSlicing = false;
+        parameters.m_shouldRunNeutrinoRecoOption = false;
+        parameters.m_shouldRunCosmicRecoOption = false;
+        parameters.m_shouldPerformSliceId = false;
+    }
+    else if ("allhitsnu" == chosenRecoOption)
+    {
+        parameters.m_shouldRunAllHitsCosmicReco = false;
+        parameters.m_shouldRunStitching = false;
+        parameters.m_shouldRunCosmicHitRemoval = false;
+        parameters.m_shouldRunSlicing = false;
+        parameters.m_shouldRunNeutrinoRecoOption = true;
+        parameters.m_shouldRunCosmicRecoOption = false;
+        parameters.m_shouldPerformSliceId = false;
+    }
+    else if ("crremhitsslicecr" == chosenRecoOption)
+    {
+        parameters.m_shouldRunAllHitsCosmicReco = true;
+        parameters.m_shouldRunStitching = true;
+        parameters.m_shouldRunCosmicHitRemoval = true;
+        parameters.m_shouldRunSlicing = true;
+        parameters.m_shouldRunNeutrinoRecoOption = false;
+        parameters.m_shouldRunCosmicRecoOption = true;
+        parameters.m_shouldPerformSliceId = false;
+    }
+    else if ("crremhitsslicenu" == chosenRecoOption)
+    {
+        parameters.m_shouldRunAllHitsCosmicReco = true;
+        parameters.m_shouldRunStitching = true;
+        parameters.m_shouldRunCosmicHitRemoval = true;
+        parameters.m_shouldRunSlicing = true;
+        parameters.m_shouldRunNeutrinoRecoOption = true;
+        parameters.m_shouldRunCosmicRecoOption = false;
+        parameters.m_shouldPerformSliceId = false;
+    }
+    else if ("allhitsslicecr" == chosenRecoOption)
+    {
+        parameters.m_shouldRunAllHitsCosmicReco = false;
+        parameters.m_shouldRunStitching = false;
+        parameters.m_shouldRunCosmicHitRemoval = false;
+        parameters.m_shouldRunSlicing = true;
+        parameters.m_shouldRunNeutrinoRecoOption = false;
+        parameters.m_shouldRunCosmicRecoOption = true;
+        parameters.m_shouldPerformSliceId = false;
+    }
+    else if ("allhitsslicenu" == chosenRecoOption)
+    {
+        parameters.m_shouldRunAllHitsCosmicReco = false;
+        parameters.m_shouldRunStitching = false;
+        parameters.m_shouldRunCosmicHitRemoval = false;
+        parameters.m_shouldRunSlicing = true;
+        parameters.m_shouldRunNeutrinoRecoOption = true;
+        parameters.m_shouldRunCosmicRecoOption = false;
+        parameters.m_shouldPerformSliceId = false;
+    }
+    else
+    {
+        std::cout << "LArReco, Unrecognized reconstruction option: " << recoOption << std::endl << std::endl;
+        return PrintOptions();
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool PrepareEventDivision(const Parameters &parameters, EventFileList &eventFileList, unsigned int &firstEvent, unsigned int &nEventsToProcess,
+    std::string &outputFileName)
+{
+    try
+    {
+        GetEventFileList(parameters.m_eventFileNameList, eventFileList);
+        outputFileName = GetOutputFileName(parameters);
+    }
+    catch (const StatusCodeException &statusCodeException)
+    {
+        std::cerr << "Pandora StatusCodeException: " << statusCodeException.ToString() << statusCodeException.GetBackTrace() << std::endl;
+        return false;
+    }
+
+    if (eventFileList.empty())
+    {
+        std::cerr << "LArReco, parallel processing requires an event file list" << std::endl;
+        return false;
+    }
+
+    // Events are numbered consecutively across all files, starting after any events skipped in the first file
+    const unsigned int nEventsTotal(eventFileList.back().m_firstEvent + eventFileList.back().m_nEvents);
+    firstEvent = parameters.m_nEventsToSkip.IsInitialized() ? std::min(static_cast<unsigned int>(std::max(parameters.m_nEventsToSkip.Get(), 0)),
+        eventFileList.front().m_nEvents) : 0;
+    nEventsToProcess = nEventsTotal - firstEvent;
+
+    if (parameters.m_nEventsToProcess >= 0)
+        nEventsToProcess = std::min(nEventsToProcess, static_cast<unsigned int>(parameters.m_nEventsToProcess));
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void GetEventFileList(const std::string &eventFileNameList, EventFileList &eventFileList)
+{
+    StringVector eventFileNames;
+    XmlHelper::TokenizeString(eventFileNameList, eventFileNames, ":");
+
+    const Pandora pandora;
+    unsigned int firstEvent(0);
+
+    for (const std::string &eventFileName : eventFileNames)
+    {
+        EventFile eventFile;
+        eventFile.m_fileName = eventFileName;
+        eventFile.m_nEvents = CountEvents(pandora, eventFileName);
+        eventFile.m_firstEvent = firstEvent;
+        eventFileList.push_back(eventFile);
+        firstEvent += eventFile.m_nEvents;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int FindEventFile(const EventFileList &eventFileList, const unsigned int event)
+{
+    unsigned int iFile(0);
+
+    while ((iFile + 1 < eventFileList.size()) && (eventFileList.at(iFile + 1).m_firstEvent <= event))
+        ++iFile;
+
+    return iFile;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventFileCursor::EventFileCursor(const Pandora &pandora, const EventFileList &eventFileList) :
+    m_pandora(pandora),
+    m_eventFileList(eventFileList),
+    m_pFileReader(nullptr),
+    m_readerFile(eventFileList.size()),
+    m_readerEvent(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+EventFileCursor::~EventFileCursor()
+{
+    delete m_pFileReader;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void EventFileCursor::ReadEvent(const unsigned int event)
+{
+    const unsigned int iFile(FindEventFile(m_eventFileList, event));
+    const unsigned int fileEvent(event - m_eventFileList.at(iFile).m_firstEvent);
+
+    // Until the event is read, the reader position is unknown, so a failure below leaves the cursor to seek again from the start of a file
+    const unsigned int readerFile(m_readerFile);
+    m_readerFile = m_eventFileList.size();
+
+    if (iFile != readerFile)
+    {
+        delete m_pFileReader;
+        m_pFileReader = nullptr;
+        m_pFileReader = CreateEventFileReader(m_pandora, m_eventFileList.at(iFile).m_fileName);
+    }
+
+    if ((iFile != readerFile) || (fileEvent < m_readerEvent))
+    {
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, m_pFileReader->GoToEvent(fileEvent));
+    }
+    else
+    {
+        for (unsigned int skippedEvent = m_readerEvent; skippedEvent < fileEvent; ++skippedEvent)
+            PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, m_pFileReader->GoToNextEvent());
+    }
+
+    // Reading an event leaves the reader positioned at the next
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, m_pFileReader->ReadEvent());
+    m_readerFile = iFile;
+    m_readerEvent = fileEvent + 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int CountEvents(const Pandora &pandora, const std::string &fileName)
+{
+    if (EventFileIndex::IsIndexable(fileName))
+        return EventFileIndex(fileName).GetNEvents();
+
+    if (!HasEvent(pandora, fileName, 0))
+        return 0;
+
+    // Bracket the last event number, then bisect, so that only O(log n) passes over the file are needed
+    unsigned int lastFound(0), firstMissing(1);
+
+    while (HasEvent(pandora, fileName, firstMissing))
+    {
+        lastFound = firstMissing;
+        firstMissing *= 2;
+    }
+
+    while (firstMissing - lastFound > 1)
+    {
+        const unsigned int eventNumber(lastFound + (firstMissing - lastFound) / 2);
+        (HasEvent(pandora, fileName, eventNumber) ? lastFound : firstMissing) = eventNumber;
+    }
+
+    return lastFound + 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool HasEvent(const Pandora &pandora, const std::string &fileName, const unsigned int eventNumber)
+{
+    // Use a fresh reader for each query, so that no stream state survives a failed search
+    std::unique_ptr<FileReader> pFileReader(CreateEventFileReader(pandora, fileName));
+
+    try
+    {
+        return (STATUS_CODE_SUCCESS == pFileReader->GoToEvent(eventNumber));
+    }
+    catch (const StatusCodeException &)
+    {
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+FileReader *CreateEventFileReader(const Pandora &pandora, const std::string &fileName)
+{
+    FileReader *pFileReader(nullptr);
+
+    if (std::string::npos != fileName.find(".xml"))
+    {
+        pFileReader = new XmlFileReader(pandora, fileName);
+    }
+    else if (std::string::npos != fileName.find(".pndr"))
+    {
+        pFileReader = new BinaryFileReader(pandora, fileName);
+    }
+    else
+    {
+        std::cout << "LArReco, unrecognized event file type: " << fileName << std::endl;
+        throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+    }
+
+    // Match the object factories used by the event reading algorithm
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, pFileReader->SetFactory(new lar_content::LArCaloHitFactory));
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, pFileReader->SetFactory(new lar_content::LArMCParticleFactory));
+
+    return pFileReader;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string GetOutputFileName(const Parameters &parameters)
+{
+    if (!parameters.m_outputFileName.empty())
+        return parameters.m_outputFileName;
+
+    // Mirror the choice made in MyTrackShowerIdAlgorithm::ReadSettings
+    TiXmlDocument xmlDocument;
+    TiXmlElement *const pXmlElement(FindTrackShowerIdSettings(parameters, xmlDocument));
+    std::string outputFileName;
+
+    if (pXmlElement && (STATUS_CODE_SUCCESS == XmlHelper::ReadValue(TiXmlHandle(pXmlElement), "OutputFile", outputFileName)))
+        return outputFileName;
+
+    return MyTrackShowerIdAlgorithm::GetFileName(parameters.m_eventFileNameList).append(".root");
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ReadOutputTuning(const Parameters &parameters, OutputTuning &outputTuning)
+{
+    TiXmlDocument xmlDocument;
+    TiXmlElement *const pXmlElement(FindTrackShowerIdSettings(parameters, xmlDocument));
+
+    if (pXmlElement)
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, outputTuning.ReadSettings(TiXmlHandle(pXmlElement)));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+TiXmlElement *FindTrackShowerIdSettings(const Parameters &parameters, TiXmlDocument &xmlDocument)
+{
+    if (!xmlDocument.LoadFile(parameters.m_settingsFile.c_str()))
+    {
+        std::cout << "LArReco, unable to load settings file " << parameters.m_settingsFile << std::endl;
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+    }
+
+    const TiXmlHandle xmlDocumentHandle(&xmlDocument);
+
+    for (TiXmlElement *pXmlElement = xmlDocumentHandle.FirstChild("pandora").FirstChild("algorithm").Element(); nullptr != pXmlElement;
+        pXmlElement = pXmlElement->NextSiblingElement("algorithm"))
+    {
+        const char *const pAlgorithmType(pXmlElement->Attribute("type"));
+
+        if (pAlgorithmType && (std::string("MyTrackShowerIdAlgorithm") == pAlgorithmType))
+            return pXmlElement;
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool MergeOutputFiles(const StringVector &inputFileNames, const std::string &outputFileName, const OutputTuning &outputTuning)
+{
+    // Index trees hold entries relative to their own file, so are rebuilt below rather than concatenated; checkpoints are not merged
+    StringVector indexedTreeNames, checkpointedTreeNames;
+    TFileMerger fileMerger(false);
+    {
+        std::unique_ptr<TFile> pInputFile(TFile::Open(inputFileNames.front().c_str(), "READ"));
+
+        if (!pInputFile || pInputFile->IsZombie())
+            return false;
+
+        TIter keyIter(pInputFile->GetListOfKeys());
+
+        while (const TKey *const pKey = static_cast<TKey*>(keyIter()))
+        {
+            TTree *pIndexTree(nullptr), *pCheckpointTree(nullptr);
+
+            if (std::string("TTree") == pKey->GetClassName())
+            {
+                pInputFile->GetObject(PfoEntryIndex::GetIndexTreeName(pKey->GetName()).c_str(), pIndexTree);
+                pInputFile->GetObject(OutputCheckpoint::GetCheckpointTreeName(pKey->GetName()).c_str(), pCheckpointTree);
+            }
+
+            if (pIndexTree && PfoEntryIndex::IsIndexTree(pIndexTree) &&
+                (indexedTreeNames.end() == std::find(indexedTreeNames.begin(), indexedTreeNames.end(), pKey->GetName())))
+            {
+                indexedTreeNames.push_back(pKey->GetName());
+                fileMerger.AddObjectNames(PfoEntryIndex::GetIndexTreeName(pKey->GetName()).c_str());
+            }
+
+            if (pCheckpointTree && OutputCheckpoint::IsCheckpointTree(pCheckpointTree) &&
+                (checkpointedTreeNames.end() == std::find(checkpointedTreeNames.begin(), checkpointedTreeNames.end(), pKey->GetName())))
+            {
+                checkpointedTreeNames.push_back(pKey->GetName());
+                fileMerger.AddObjectNames(OutputCheckpoint::GetCheckpointTreeName(pKey->GetName()).c_str());
+            }
+        }
+    }
+
+    // Without compression settings, keep the merger default
+    const bool isOpen(outputTuning.HasCompressionSettings() ?
+        fileMerger.OutputFile(outputFileName.c_str(), "RECREATE", outputTuning.GetCompressionSettings()) :
+        fileMerger.OutputFile(outputFileName.c_str(), "RECREATE"));
+
+    if (!isOpen)
+        return false;
+
+    for (const std::string &inputFileName : inputFileNames)
+    {
+        if (!fileMerger.AddFile(inputFileName.c_str(), false))
+            return false;
+    }
+
+    LAR_RECO_LOG(Logger::GetDefault(), LOG_INFO, "LArReco, merging " << inputFileNames.size() << " worker output files into " << outputFileName);
+
+    if (!fileMerger.PartialMerge(TFileMerger::kAll | TFileMerger::kRegular | TFileMerger::kSkipListed))
+        return false;
+
+    return (indexedTreeNames.empty() || MergeEntryIndices(inputFileNames, indexedTreeNames, outputFileName));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool MergeEntryIndices(const StringVector &inputFileNames, const StringVector &pfoTreeNames, const std::string &outputFileName)
+{
+    TFile outputFile(outputFileName.c_str(), "UPDATE");
+
+    if (outputFile.IsZombie())
+        return false;
+
+    for (const std::string &pfoTreeName : pfoTreeNames)
+    {
+        // The merged tree holds the entries of each input tree in turn, so each input index is offset by the entries before it
+        PfoEntryIndex outputIndex;
+        Long64_t entryOffset(0);
+        outputFile.cd();
+        TTree *const pIndexTree(outputIndex.CreateTree(pfoTreeName));
+
+        for (const std::string &inputFileName : inputFileNames)
+        {
+            std::unique_ptr<TFile> pInputFile(TFile::Open(inputFileName.c_str(), "READ"));
+            TTree *pInputTree(nullptr);
+            PfoEntryIndex inputIndex;
+
+            if (pInputFile && !pInputFile->IsZombie())
+                pInputFile->GetObject(pfoTreeName.c_str(), pInputTree);
+
+            if (!pInputTree || !PfoEntryIndex::Read(pInputFile.get(), pfoTreeName, inputIndex))
+                return false;
+
+            outputIndex.Append(inputIndex, entryOffset);
+            outputIndex.EndEvent();
+            entryOffset += pInputTree->GetEntries();
+        }
+
+        outputFile.cd();
+        pIndexTree->Write(nullptr, TObject::kOverwrite);
+    }
+
+    outputFile.Close();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int MergeOutputFilesByEvent(const Parameters &parameters, const unsigned int firstEvent, const StringVector &inputFileNames,
+    const std::vector<UIntVector> &eventLists, const std::string &outputFileName)
+{
+    // Renumber events by their position in the input, so that event ids do not depend upon how the events were shared out
+    StringVector existingFileNames, existingColumnFileNames;
+    std::vector<UIntVector> existingEventIdLists, existingColumnEventIdLists;
+
+    for (unsigned int iFile = 0; iFile < inputFileNames.size(); ++iFile)
+    {
+        UIntVector eventIds;
+
+        for (const unsigned int event : eventLists.at(iFile))
+            eventIds.push_back(parameters.m_firstEventId + event - firstEvent);
+
+        if (0 == access(inputFileNames.at(iFile).c_str(), F_OK))
+        {
+            existingFileNames.push_back(inputFileNames.at(iFile));
+            existingEventIdLists.push_back(eventIds);
+        }
+
+        if (0 == access(GetColumnFileName(inputFileNames.at(iFile)).c_str(), F_OK))
+        {
+            existingColumnFileNames.push_back(GetColumnFileName(inputFileNames.at(iFile)));
+            existingColumnEventIdLists.push_back(eventIds);
+        }
+    }
+
+    OutputTuning outputTuning;
+    ReadOutputTuning(parameters, outputTuning);
+
+    if (!existingFileNames.empty() && !MergeOutputFilesInEventOrder(existingFileNames, existingEventIdLists, outputFileName, outputTuning))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "LArReco, unable to merge output files into " << outputFileName);
+        return 1;
+    }
+
+    if (!existingColumnFileNames.empty() && !MergeColumnFiles(existingColumnFileNames, existingColumnEventIdLists, GetColumnFileName(outputFileName)))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "LArReco, unable to merge columnar files into " << GetColumnFileName(outputFileName));
+        return 1;
+    }
+
+    for (const std::string &existingFileName : existingFileNames)
+        std::remove(existingFileName.c_str());
+
+    for (const std::string &existingColumnFileName : existingColumnFileNames)
+        std::remove(existingColumnFileName.c_str());
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool MergeOutputFilesInEventOrder(const StringVector &inputFileNames, const std::vector<UIntVector> &eventIdLists, const std::string &outputFileName,
+    const OutputTuning &outputTuning)
+{
+    std::vector<std::unique_ptr<TFile>> inputFiles;
+
+    for (const std::string &inputFileName : inputFileNames)
+    {
+        inputFiles.emplace_back(TFile::Open(inputFileName.c_str(), "READ"));
+
+        if (!inputFiles.back() || inputFiles.back()->IsZombie())
+            return false;
+    }
+
+    StringVector treeNames;
+    TIter keyIter(inputFiles.front()->GetListOfKeys());
+
+    while (const TKey *const pKey = static_cast<TKey*>(keyIter()))
+    {
+        if (std::string("TTree") == pKey->GetClassName())
+            treeNames.push_back(pKey->GetName());
+    }
+
+    TFile outputFile(outputFileName.c_str(), "RECREATE");
+
+    if (outputFile.IsZombie())
+        return false;
+
+    outputTuning.ApplyToFile(&outputFile);
+    LAR_RECO_LOG(Logger::GetDefault(), LOG_INFO, "LArReco, merging " << inputFileNames.size() << " thread output files into " << outputFileName);
+
+    for (const std::string &treeName : treeNames)
+    {
+        std::vector<TTree*> inputTrees;
+
+        for (const std::unique_ptr<TFile> &pInputFile : inputFiles)
+        {
+            TTree *pInputTree(nullptr);
+            pInputFile->GetObject(treeName.c_str(), pInputTree);
+
+            if (!pInputTree)
+                return false;
+
+            inputTrees.push_back(pInputTree);
+        }
+
+        // Index trees hold entries relative to their own file, so are rebuilt below as their pfo trees are merged; checkpoints are dropped
+        if (PfoEntryIndex::IsIndexTree(inputTrees.front()) || OutputCheckpoint::IsCheckpointTree(inputTrees.front()))
+            continue;
+
+        // Each input file holds a thread's events in the order it processed them, with event ids counting up from zero
+        typedef std::pair<unsigned int, std::pair<unsigned int, Long64_t>> EventIdEntry;
+        std::vector<EventIdEntry> eventIdEntries;
+        std::vector<UIntVector> pfoIdLists(inputTrees.size());
+        const bool isPfoTree(!PfoEventTreeWriter::IsEventTree(inputTrees.front()));
+        unsigned int localEventId(0), pfoId(0);
+
+        for (unsigned int iTree = 0; iTree < inputTrees.size(); ++iTree)
+        {
+            inputTrees.at(iTree)->SetBranchAddress("eventId", &localEventId);
+
+            if (isPfoTree)
+                inputTrees.at(iTree)->SetBranchAddress("pfoId", &pfoId);
+
+            for (Long64_t iEntry = 0; iEntry < inputTrees.at(iTree)->GetEntries(); ++iEntry)
+            {
+                inputTrees.at(iTree)->GetBranch("eventId")->GetEntry(iEntry);
+
+                if (localEventId >= eventIdLists.at(iTree).size())
+                    return false;
+
+                eventIdEntries.push_back(EventIdEntry(eventIdLists.at(iTree).at(localEventId), std::make_pair(iTree, iEntry)));
+
+                if (isPfoTree)
+                {
+                    inputTrees.at(iTree)->GetBranch("pfoId")->GetEntry(iEntry);
+                    pfoIdLists.at(iTree).push_back(pfoId);
+                }
+            }
+
+            inputTrees.at(iTree)->ResetBranchAddresses();
+        }
+
+        std::stable_sort(eventIdEntries.begin(), eventIdEntries.end(),
+            [](const EventIdEntry &lhs, const EventIdEntry &rhs) { return lhs.first < rhs.first; });
+
+        outputFile.cd();
+        TTree *const pOutputTree(inputTrees.front()->CloneTree(0));
+
+        for (TTree *const pInputTree : inputTrees)
+            pOutputTree->CopyAddresses(pInputTree);
+
+        outputTuning.ApplyToTree(pOutputTree);
+        unsigned int eventId(0);
+        pOutputTree->SetBranchAddress("eventId", &eventId);
+
+        // Event layout trees hold a single entry per event, now in event id order, so need no index
+        PfoEntryIndex pfoEntryIndex;
+        TTree *const pIndexTree(isPfoTree ? pfoEntryIndex.CreateTree(treeName) : nullptr);
+
+        for (const EventIdEntry &eventIdEntry : eventIdEntries)
+        {
+            inputTrees.at(eventIdEntry.second.first)->GetEntry(eventIdEntry.second.second);
+            eventId = eventIdEntry.first;
+
+            if (isPfoTree)
+                pfoEntryIndex.AddEntry(eventId, pfoIdLists.at(eventIdEntry.second.first).at(eventIdEntry.second.second), pOutputTree->GetEntries());
+
+            pOutputTree->Fill();
+        }
+
+        for (TTree *const pInputTree : inputTrees)
+            pInputTree->ResetBranchAddresses();
+
+        pOutputTree->Write();
+
+        if (pIndexTree)
+        {
+            pfoEntryIndex.EndEvent();
+            pIndexTree->Write(nullptr, TObject::kOverwrite);
+        }
+    }
+
+    outputFile.Close();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool MergeColumnFiles(const StringVector &inputFileNames, const std::vector<UIntVector> &eventIdLists, const std::string &outputFileName)
+{
+    try
+    {
+        std::vector<std::unique_ptr<PfoColumnReader>> inputReaders;
+
+        for (const std::string &inputFileName : inputFileNames)
+            inputReaders.emplace_back(new PfoColumnReader(inputFileName));
+
+        const StringVector &columnNames(inputReaders.front()->GetColumnNames());
+
+        for (const std::unique_ptr<PfoColumnReader> &pInputReader : inputReaders)
+        {
+            if (pInputReader->GetColumnNames() != columnNames)
+                return false;
+
+            for (const std::string &columnName : columnNames)
+            {
+                if ((pInputReader->GetColumnType(columnName) != inputReaders.front()->GetColumnType(columnName)) ||
+                    (pInputReader->IsJagged(columnName) != inputReaders.front()->IsJagged(columnName)))
+                {
+                    return false;
+                }
+            }
+        }
+
+        // Without event id lists, rows are concatenated in file order, keeping the stored event ids
+        typedef std::pair<unsigned int, std::pair<unsigned int, uint64_t>> EventIdRow;
+        std::vector<EventIdRow> eventIdRows;
+
+        for (unsigned int iFile = 0; iFile < inputReaders.size(); ++iFile)
+        {
+            const ColumnView<unsigned int> localEventIds(inputReaders.at(iFile)->GetValues<unsigned int>("eventId"));
+
+            for (uint64_t row = 0; row < inputReaders.at(iFile)->GetNRows(); ++row)
+            {
+                if (eventIdLists.empty())
+                {
+                    eventIdRows.push_back(EventIdRow(localEventIds[row], std::make_pair(iFile, row)));
+                }
+                else
+                {
+                    if (localEventIds[row] >= eventIdLists.at(iFile).size())
+                        return false;
+
+                    eventIdRows.push_back(EventIdRow(eventIdLists.at(iFile).at(localEventIds[row]), std::make_pair(iFile, row)));
+                }
+            }
+        }
+
+        if (!eventIdLists.empty())
+        {
+            std::stable_sort(eventIdRows.begin(), eventIdRows.end(),
+                [](const EventIdRow &lhs, const EventIdRow &rhs) { return lhs.first < rhs.first; });
+        }
+
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_INFO, "LArReco, merging " << inputFileNames.size() << " columnar files into " << outputFileName);
+        PfoColumnWriter columnWriter(outputFileName);
+        UIntVector columnIndices;
+
+        for (const std::string &columnName : columnNames)
+        {
+            columnIndices.push_back(columnWriter.AddColumn(columnName, inputReaders.front()->GetColumnType(columnName),
+                inputReaders.front()->IsJagged(columnName)));
+        }
+
+        for (const EventIdRow &eventIdRow : eventIdRows)
+        {
+            const PfoColumnReader &inputReader(*inputReaders.at(eventIdRow.second.first));
+
+            for (unsigned int iColumn = 0; iColumn < columnNames.size(); ++iColumn)
+            {
+                if ("eventId" == columnNames.at(iColumn))
+                {
+                    columnWriter.AppendValues(columnIndices.at(iColumn), &eventIdRow.first, 1);
+                    continue;
+                }
+
+                const ColumnView<uint32_t> rowValues(inputReader.GetRawRowValues(columnNames.at(iColumn), eventIdRow.second.second));
+                columnWriter.AppendValues(columnIndices.at(iColumn), rowValues.begin(), rowValues.size());
+            }
+
+            columnWriter.EndRow();
+        }
+
+        columnWriter.Close();
+    }
+    catch (const StatusCodeException &)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool ReadOutputCheckpoint(const std::string &fileName, OutputCheckpoint::Record &record)
+{
+    std::unique_ptr<TFile> pTFile(TFile::Open(fileName.c_str(), "READ"));
+
+    if (!pTFile || pTFile->IsZombie())
+        return false;
+
+    TIter keyIter(pTFile->GetListOfKeys());
+
+    while (const TKey *const pKey = static_cast<TKey*>(keyIter()))
+    {
+        if ((std::string("TTree") == pKey->GetClassName()) && OutputCheckpoint::Read(pTFile.get(), pKey->GetName(), record))
+            return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool MergeResumedOutputFiles(const std::string &checkpointFileName, const std::string &resumedFileName, const std::string &outputFileName,
+    const OutputTuning &outputTuning)
+{
+    // A file without a checkpoint holds no complete events, e.g. if its job was killed early, so its events will be processed again
+    StringVector inputFileNames, columnFileNames;
+
+    for (const std::string &fileName : {checkpointFileName, resumedFileName})
+    {
+        OutputCheckpoint::Record record{0, 0, 0};
+
+        if (0 != access(fileName.c_str(), F_OK))
+            continue;
+
+        if (!ReadOutputCheckpoint(fileName, record))
+        {
+            LAR_RECO_LOG(Logger::GetDefault(), LOG_WARNING, "LArReco, output file " << fileName << " holds no checkpoint, its events will be processed again");
+            continue;
+        }
+
+        inputFileNames.push_back(fileName);
+
+        if (0 == access(GetColumnFileName(fileName).c_str(), F_OK))
+            columnFileNames.push_back(GetColumnFileName(fileName));
+    }
+
+    if (inputFileNames.empty())
+        return true;
+
+    if (!MergeCheckpointedOutputFiles(inputFileNames, outputFileName, outputTuning))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "LArReco, unable to merge checkpointed output files into " << outputFileName);
+        return false;
+    }
+
+    // Columnar files are only written as a job ends, so survive a stop signal but not a kill
+    if (columnFileNames.size() == inputFileNames.size())
+    {
+        if (!MergeColumnFiles(columnFileNames, std::vector<UIntVector>(), GetColumnFileName(outputFileName)))
+        {
+            LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "LArReco, unable to merge columnar files into " << GetColumnFileName(outputFileName));
+            return false;
+        }
+
+        for (const std::string &columnFileName : columnFileNames)
+            std::remove(columnFileName.c_str());
+    }
+    else if (!columnFileNames.empty())
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "LArReco, the columnar output of a killed job was lost, columnar files have been left unmerged");
+    }
+
+    std::remove(checkpointFileName.c_str());
+    std::remove(resumedFileName.c_str());
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool MergeCheckpointedOutputFiles(const StringVector &inputFileNames, const std::string &outputFileName, const OutputTuning &outputTuning)
+{
+    std::vector<std::unique_ptr<TFile>> inputFiles;
+
+    for (const std::string &inputFileName : inputFileNames)
+    {
+        inputFiles.emplace_back(TFile::Open(inputFileName.c_str(), "READ"));
+
+        if (!inputFiles.back() || inputFiles.back()->IsZombie())
+            return false;
+    }
+
+    StringVector treeNames;
+    TIter keyIter(inputFiles.front()->GetListOfKeys());
+
+    while (const TKey *const pKey = static_cast<TKey*>(keyIter()))
+    {
+        if ((std::string("TTree") == pKey->GetClassName()) && (treeNames.end() == std::find(treeNames.begin(), treeNames.end(), pKey->GetName())))
+            treeNames.push_back(pKey->GetName());
+    }
+
+    TFile outputFile(outputFileName.c_str(), "RECREATE");
+
+    if (outputFile.IsZombie())
+        return false;
+
+    outputTuning.ApplyToFile(&outputFile);
+    LAR_RECO_LOG(Logger::GetDefault(), LOG_INFO, "LArReco, merging " << inputFileNames.size() << " checkpointed output files into " << outputFileName);
+
+    for (const std::string &treeName : treeNames)
+    {
+        std::vector<TTree*> inputTrees;
+        std::vector<OutputCheckpoint::Record> records;
+
+        for (const std::unique_ptr<TFile> &pInputFile : inputFiles)
+        {
+            TTree *pInputTree(nullptr);
+            OutputCheckpoint::Record record{0, 0, 0};
+            pInputFile->GetObject(treeName.c_str(), pInputTree);
+
+            if (!pInputTree)
+                return false;
+
+            // Index and checkpoint trees are rebuilt below, for the entries copied
+            if (PfoEntryIndex::IsIndexTree(pInputTree) || OutputCheckpoint::IsCheckpointTree(pInputTree))
+                break;
+
+            if (!OutputCheckpoint::Read(pInputFile.get(), treeName, record) || (record.m_nEntries > pInputTree->GetEntries()))
+                return false;
+
+            inputTrees.push_back(pInputTree);
+            records.push_back(record);
+        }
+
+        if (inputTrees.size() != inputFiles.size())
+            continue;
+
+        // Entries written after the last checkpoint of each file may belong to an incomplete event, so are dropped
+        const bool isPfoTree(!PfoEventTreeWriter::IsEventTree(inputTrees.front()));
+        UIntVector eventIds, pfoIds;
+        unsigned int eventId(0), pfoId(0);
+
+        if (isPfoTree)
+        {
+            for (unsigned int iTree = 0; iTree < inputTrees.size(); ++iTree)
+            {
+                inputTrees.at(iTree)->SetBranchAddress("eventId", &eventId);
+                inputTrees.at(iTree)->SetBranchAddress("pfoId", &pfoId);
+
+                for (Long64_t iEntry = 0; iEntry < records.at(iTree).m_nEntries; ++iEntry)
+                {
+                    inputTrees.at(iTree)->GetBranch("eventId")->GetEntry(iEntry);
+                    inputTrees.at(iTree)->GetBranch("pfoId")->GetEntry(iEntry);
+                    eventIds.push_back(eventId);
+                    pfoIds.push_back(pfoId);
+                }
+
+                inputTrees.at(iTree)->ResetBranchAddresses();
+            }
+        }
+
+        outputFile.cd();
+        TTree *const pOutputTree(inputTrees.front()->CloneTree(0));
+
+        for (TTree *const pInputTree : inputTrees)
+            pOutputTree->CopyAddresses(pInputTree);
+
+        outputTuning.ApplyToTree(pOutputTree);
+        PfoEntryIndex pfoEntryIndex;
+        TTree *const pIndexTree(isPfoTree ? pfoEntryIndex.CreateTree(treeName) : nullptr);
+
+        for (unsigned int iTree = 0; iTree < inputTrees.size(); ++iTree)
+        {
+            for (Long64_t iEntry = 0; iEntry < records.at(iTree).m_nEntries; ++iEntry)
+            {
+                inputTrees.at(iTree)->GetEntry(iEntry);
+
+                if (isPfoTree)
+                    pfoEntryIndex.AddEntry(eventIds.at(pOutputTree->GetEntries()), pfoIds.at(pOutputTree->GetEntries()), pOutputTree->GetEntries());
+
+                pOutputTree->Fill();
+            }
+        }
+
+        for (TTree *const pInputTree : inputTrees)
+            pInputTree->ResetBranchAddresses();
+
+        if (pIndexTree)
+            pfoEntryIndex.EndEvent();
+
+        // The merged file is checkpointed in turn, so that it may be resumed again
+        OutputCheckpoint outputCheckpoint(treeName, pOutputTree, pIndexTree, 0, 0, records.back().m_nextEventId);
+        outputCheckpoint.EndEvent(records.back().m_nextEventId);
+        outputCheckpoint.Write();
+
+        pOutputTree->Write(nullptr, TObject::kOverwrite);
+
+        if (pIndexTree)
+            pIndexTree->Write(nullptr, TObject::kOverwrite);
+    }
+
+    outputFile.Close();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ProcessExternalParameters(const Parameters &parameters, const Pandora *const pPandora)
+{
+    // With timing enabled, the master algorithm may be replaced by its timing variant, which must receive the same steering
+    StringVector masterAlgorithmTypes(1, "LArMaster");
+
+    if (!parameters.m_timingReportFile.empty())
+        masterAlgorithmTypes.push_back(AlgorithmTimer::MASTER_ALGORITHM_TYPE);
+
+    auto pEventReadingParameters = new lar_content::EventReadingAlgorithm::ExternalEventReadingParameters;
+    pEventReadingParameters->m_geometryFileName = parameters.m_geometryFileName;
+    pEventReadingParameters->m_eventFileNameList = parameters.m_eventFileNameList;
+    if (parameters.m_nEventsToSkip.IsInitialized()) pEventReadingParameters->m_skipToEvent = parameters.m_nEventsToSkip.Get();
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetExternalParameters(*pPandora, "LArEventReading", pEventReadingParameters));
+
+    auto *const pTrackShowerIdParameters = new MyTrackShowerIdAlgorithm::ExternalTrackShowerIdParameters;
+    pTrackShowerIdParameters->m_eventFileNameList = parameters.m_eventFileNameList;
+    pTrackShowerIdParameters->m_outputFileName = parameters.m_outputFileName;
+    pTrackShowerIdParameters->m_firstEventId = parameters.m_firstEventId;
+    PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetExternalParameters(*pPandora, "MyTrackShowerIdAlgorithm", pTrackShowerIdParameters));
+
+    for (const std::string &masterAlgorithmType : masterAlgorithmTypes)
+    {
+        auto *const pEventSteeringParameters = new lar_content::MasterAlgorithm::ExternalSteeringParameters;
+        pEventSteeringParameters->m_shouldRunAllHitsCosmicReco = parameters.m_shouldRunAllHitsCosmicReco;
+        pEventSteeringParameters->m_shouldRunStitching = parameters.m_shouldRunStitching;
+        pEventSteeringParameters->m_shouldRunCosmicHitRemoval = parameters.m_shouldRunCosmicHitRemoval;
+        pEventSteeringParameters->m_shouldRunSlicing = parameters.m_shouldRunSlicing;
+        pEventSteeringParameters->m_shouldRunNeutrinoRecoOption = parameters.m_shouldRunNeutrinoRecoOption;
+        pEventSteeringParameters->m_shouldRunCosmicRecoOption = parameters.m_shouldRunCosmicRecoOption;
+        pEventSteeringParameters->m_shouldPerformSliceId = parameters.m_shouldPerformSliceId;
+        pEventSteeringParameters->m_printOverallRecoStatus = parameters.m_printOverallRecoStatus;
+        PANDORA_THROW_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::SetExternalParameters(*pPandora, masterAlgorithmType, pEventSteeringParameters));
+    }
 }
 
 } // namespace lar_reco
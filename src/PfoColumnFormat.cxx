@@ -0,0 +1,33 @@
+/**
+ *  @file   LArReco/src/PfoColumnFormat.cxx
+ *
+ *  @brief  Implementation of the columnar pfo file format helpers.
+ *
+ *  $Log: $
+ */
+
+#include "PfoColumnFormat.h"
+
+namespace lar_reco
+{
+
+std::string GetColumnFileName(const std::string &outputFileName)
+{
+    const std::string rootExtension(".root"), columnExtension(".pfocol");
+
+    if ((outputFileName.size() >= columnExtension.size()) &&
+        (0 == outputFileName.compare(outputFileName.size() - columnExtension.size(), columnExtension.size(), columnExtension)))
+    {
+        return outputFileName;
+    }
+
+    if ((outputFileName.size() >= rootExtension.size()) &&
+        (0 == outputFileName.compare(outputFileName.size() - rootExtension.size(), rootExtension.size(), rootExtension)))
+    {
+        return outputFileName.substr(0, outputFileName.size() - rootExtension.size()) + columnExtension;
+    }
+
+    return outputFileName + columnExtension;
+}
+
+} // namespace lar_reco
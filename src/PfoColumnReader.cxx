@@ -0,0 +1,204 @@
+/**
+ *  @file   LArReco/src/PfoColumnReader.cxx
+ *
+ *  @brief  Implementation of the pfo column reader class.
+ *
+ *  $Log: $
+ */
+
+#include "PfoColumnReader.h"
+#include "Logger.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+PfoColumnReader::PfoColumnReader(const std::string &fileName) :
+    m_fileName(fileName),
+    m_pData(nullptr),
+    m_fileSize(0),
+    m_footerOffset(0),
+    m_nRows(0)
+{
+    const int fileDescriptor(open(fileName.c_str(), O_RDONLY));
+    struct stat fileStatus;
+
+    if ((fileDescriptor < 0) || (0 != fstat(fileDescriptor, &fileStatus)))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnReader: unable to open " << fileName);
+
+        if (fileDescriptor >= 0)
+            close(fileDescriptor);
+
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+    }
+
+    m_fileSize = fileStatus.st_size;
+
+    if (m_fileSize < COLUMN_FILE_HEADER_SIZE + COLUMN_FILE_TRAILER_SIZE)
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnReader: " << fileName << " is too short to be a columnar pfo file");
+        close(fileDescriptor);
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+
+    // The mapping outlives the descriptor, and is page aligned, so every block is aligned for its values
+    void *const pMapping(mmap(nullptr, m_fileSize, PROT_READ, MAP_SHARED, fileDescriptor, 0));
+    close(fileDescriptor);
+
+    if (MAP_FAILED == pMapping)
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnReader: unable to map " << fileName);
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+
+    m_pData = static_cast<const char*>(pMapping);
+
+    try
+    {
+        this->ReadFooter();
+    }
+    catch (const StatusCodeException &)
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnReader: " << fileName << " is not a valid columnar pfo file");
+        munmap(const_cast<char*>(m_pData), m_fileSize);
+        throw;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PfoColumnReader::~PfoColumnReader()
+{
+    munmap(const_cast<char*>(m_pData), m_fileSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+ColumnView<uint64_t> PfoColumnReader::GetOffsets(const std::string &name) const
+{
+    const Column &column(this->GetColumn(name));
+
+    if (!column.m_isJagged)
+        throw StatusCodeException(STATUS_CODE_NOT_ALLOWED);
+
+    return ColumnView<uint64_t>(reinterpret_cast<const uint64_t*>(m_pData + column.m_offsetsOffset), m_nRows + 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnReader::ReadFooter()
+{
+    uint32_t version(0);
+    std::memcpy(&version, m_pData + sizeof(COLUMN_FILE_MAGIC), sizeof(version));
+
+    if ((0 != std::memcmp(m_pData, COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC))) ||
+        (0 != std::memcmp(m_pData + m_fileSize - sizeof(COLUMN_FILE_MAGIC), COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC))) ||
+        (COLUMN_FILE_VERSION != version))
+    {
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+
+    std::memcpy(&m_footerOffset, m_pData + m_fileSize - COLUMN_FILE_TRAILER_SIZE, sizeof(m_footerOffset));
+
+    if ((m_footerOffset < COLUMN_FILE_HEADER_SIZE) || (m_footerOffset > m_fileSize - COLUMN_FILE_TRAILER_SIZE))
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+
+    uint64_t position(m_footerOffset);
+    uint32_t nColumns(0);
+    this->ReadFooterBytes(position, &m_nRows, sizeof(m_nRows));
+    this->ReadFooterBytes(position, &nColumns, sizeof(nColumns));
+
+    for (uint32_t iColumn = 0; iColumn < nColumns; ++iColumn)
+    {
+        uint32_t nameLength(0), columnType(0), isJagged(0);
+        this->ReadFooterBytes(position, &nameLength, sizeof(nameLength));
+
+        std::string name(nameLength, '\0');
+        this->ReadFooterBytes(position, &name[0], nameLength);
+
+        Column column;
+        this->ReadFooterBytes(position, &columnType, sizeof(columnType));
+        this->ReadFooterBytes(position, &isJagged, sizeof(isJagged));
+        this->ReadFooterBytes(position, &column.m_valuesOffset, sizeof(column.m_valuesOffset));
+        this->ReadFooterBytes(position, &column.m_nValues, sizeof(column.m_nValues));
+        this->ReadFooterBytes(position, &column.m_offsetsOffset, sizeof(column.m_offsetsOffset));
+
+        if (columnType > COLUMN_UINT32)
+            throw StatusCodeException(STATUS_CODE_FAILURE);
+
+        column.m_columnType = static_cast<ColumnType>(columnType);
+        column.m_isJagged = (0 != isJagged);
+
+        // Blocks must be aligned and lie between the header and the footer
+        if ((0 != column.m_valuesOffset % COLUMN_BLOCK_ALIGNMENT) || (column.m_valuesOffset < COLUMN_FILE_HEADER_SIZE) ||
+            (column.m_valuesOffset > m_footerOffset) || (column.m_nValues > (m_footerOffset - column.m_valuesOffset) / COLUMN_VALUE_SIZE))
+        {
+            throw StatusCodeException(STATUS_CODE_FAILURE);
+        }
+
+        if (!column.m_isJagged && (column.m_nValues != m_nRows))
+            throw StatusCodeException(STATUS_CODE_FAILURE);
+
+        if (column.m_isJagged)
+        {
+            if ((0 != column.m_offsetsOffset % COLUMN_BLOCK_ALIGNMENT) || (column.m_offsetsOffset < COLUMN_FILE_HEADER_SIZE) ||
+                (column.m_offsetsOffset > m_footerOffset) || (m_nRows >= (m_footerOffset - column.m_offsetsOffset) / sizeof(uint64_t)))
+            {
+                throw StatusCodeException(STATUS_CODE_FAILURE);
+            }
+
+            const uint64_t *const pOffsets(reinterpret_cast<const uint64_t*>(m_pData + column.m_offsetsOffset));
+
+            if ((0 != pOffsets[0]) || (column.m_nValues != pOffsets[m_nRows]))
+                throw StatusCodeException(STATUS_CODE_FAILURE);
+
+            for (uint64_t row = 0; row < m_nRows; ++row)
+            {
+                if (pOffsets[row] > pOffsets[row + 1])
+                    throw StatusCodeException(STATUS_CODE_FAILURE);
+            }
+        }
+
+        if (!m_columnMap.insert(ColumnMap::value_type(name, column)).second)
+            throw StatusCodeException(STATUS_CODE_FAILURE);
+
+        m_columnNames.push_back(name);
+    }
+
+    if (position != m_fileSize - COLUMN_FILE_TRAILER_SIZE)
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnReader::ReadFooterBytes(uint64_t &position, void *const pValue, const uint64_t nBytes) const
+{
+    if (nBytes > m_fileSize - COLUMN_FILE_TRAILER_SIZE - position)
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+
+    std::memcpy(pValue, m_pData + position, nBytes);
+    position += nBytes;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const PfoColumnReader::Column &PfoColumnReader::GetColumn(const std::string &name) const
+{
+    const ColumnMap::const_iterator iter(m_columnMap.find(name));
+
+    if (m_columnMap.end() == iter)
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+
+    return iter->second;
+}
+
+} // namespace lar_reco
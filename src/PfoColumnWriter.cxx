@@ -0,0 +1,355 @@
+/**
+ *  @file   LArReco/src/PfoColumnWriter.cxx
+ *
+ *  @brief  Implementation of the pfo column writer class.
+ *
+ *  $Log: $
+ */
+
+#include "PfoColumnWriter.h"
+#include "Logger.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+PfoColumnWriter::PfoColumnWriter(const std::string &fileName) :
+    m_fileName(fileName),
+    m_nRows(0),
+    m_isClosed(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PfoColumnWriter::~PfoColumnWriter()
+{
+    this->CloseSpillFiles();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int PfoColumnWriter::AddColumn(const std::string &name, const ColumnType columnType, const bool isJagged)
+{
+    this->AddBoundColumn(name, columnType, isJagged, nullptr, 0);
+    return m_columnList.size() - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnWriter::Fill()
+{
+    for (unsigned int columnIndex = 0; columnIndex < m_columnList.size(); ++columnIndex)
+    {
+        const Column &column(m_columnList.at(columnIndex));
+
+        if (!column.m_pAddress)
+            continue;
+
+        if (!column.m_isJagged)
+        {
+            this->AppendValues(columnIndex, column.m_pAddress, 1);
+        }
+        else if (column.m_nBoundValues > 0)
+        {
+            this->AppendValues(columnIndex, column.m_pAddress, column.m_nBoundValues);
+        }
+        else
+        {
+            switch (column.m_columnType)
+            {
+            case COLUMN_FLOAT32:
+                this->AppendVectorValues<float>(columnIndex);
+                break;
+            case COLUMN_INT32:
+                this->AppendVectorValues<int>(columnIndex);
+                break;
+            case COLUMN_UINT32:
+                this->AppendVectorValues<unsigned int>(columnIndex);
+                break;
+            default:
+                throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+            }
+        }
+    }
+
+    this->EndRow();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnWriter::AppendValues(const unsigned int columnIndex, const void *const pValues, const std::size_t nValues)
+{
+    if (m_isClosed)
+        throw StatusCodeException(STATUS_CODE_NOT_ALLOWED);
+
+    Column &column(m_columnList.at(columnIndex));
+
+    if (nValues > 0 && (std::fwrite(pValues, COLUMN_VALUE_SIZE, nValues, column.m_pSpillFile) != nValues))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnWriter: unable to spill values of column " << column.m_name);
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+
+    column.m_nValues += nValues;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnWriter::EndRow()
+{
+    for (Column &column : m_columnList)
+    {
+        if (column.m_isJagged)
+        {
+            AppendOffset(column, column.m_nValues);
+        }
+        else if (column.m_nValues != m_nRows + 1)
+        {
+            LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnWriter: scalar column " << column.m_name << " has " << column.m_nValues << " values after " << (m_nRows + 1) << " rows");
+            throw StatusCodeException(STATUS_CODE_FAILURE);
+        }
+    }
+
+    ++m_nRows;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnWriter::Close()
+{
+    if (m_isClosed)
+        throw StatusCodeException(STATUS_CODE_NOT_ALLOWED);
+
+    // Write to a temporary file, renamed into place once complete, so that readers never map a partial file
+    const std::string temporaryFileName(m_fileName + ".tmp");
+    std::FILE *const pFile(std::fopen(temporaryFileName.c_str(), "wb"));
+
+    if (!pFile)
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnWriter: unable to open " << temporaryFileName << " for writing");
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+
+    try
+    {
+        uint64_t position(0);
+        const uint32_t version(COLUMN_FILE_VERSION), reserved(0);
+        WriteBytes(pFile, COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC), position);
+        WriteBytes(pFile, &version, sizeof(version), position);
+        WriteBytes(pFile, &reserved, sizeof(reserved), position);
+
+        std::vector<uint64_t> valuesOffsets, offsetsOffsets;
+
+        for (const Column &column : m_columnList)
+        {
+            valuesOffsets.push_back(CopyBlock(pFile, column.m_pSpillFile, column.m_nValues * COLUMN_VALUE_SIZE, position));
+            offsetsOffsets.push_back(column.m_isJagged ? CopyBlock(pFile, column.m_pOffsetsSpillFile, (m_nRows + 1) * sizeof(uint64_t), position) : 0);
+        }
+
+        const uint64_t footerOffset(position);
+        const uint32_t nColumns(m_columnList.size());
+        WriteBytes(pFile, &m_nRows, sizeof(m_nRows), position);
+        WriteBytes(pFile, &nColumns, sizeof(nColumns), position);
+
+        for (unsigned int columnIndex = 0; columnIndex < m_columnList.size(); ++columnIndex)
+        {
+            const Column &column(m_columnList.at(columnIndex));
+            const uint32_t nameLength(column.m_name.size()), columnType(column.m_columnType), isJagged(column.m_isJagged ? 1 : 0);
+            WriteBytes(pFile, &nameLength, sizeof(nameLength), position);
+            WriteBytes(pFile, column.m_name.data(), nameLength, position);
+            WriteBytes(pFile, &columnType, sizeof(columnType), position);
+            WriteBytes(pFile, &isJagged, sizeof(isJagged), position);
+            WriteBytes(pFile, &valuesOffsets.at(columnIndex), sizeof(uint64_t), position);
+            WriteBytes(pFile, &column.m_nValues, sizeof(column.m_nValues), position);
+            WriteBytes(pFile, &offsetsOffsets.at(columnIndex), sizeof(uint64_t), position);
+        }
+
+        WriteBytes(pFile, &footerOffset, sizeof(footerOffset), position);
+        WriteBytes(pFile, COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC), position);
+    }
+    catch (const StatusCodeException &)
+    {
+        std::fclose(pFile);
+        std::remove(temporaryFileName.c_str());
+        throw;
+    }
+
+    if ((0 != std::fclose(pFile)) || (0 != std::rename(temporaryFileName.c_str(), m_fileName.c_str())))
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnWriter: unable to write " << m_fileName);
+        std::remove(temporaryFileName.c_str());
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+
+    m_isClosed = true;
+    this->CloseSpillFiles();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnWriter::AddBoundColumn(const std::string &name, const ColumnType columnType, const bool isJagged, const void *const pAddress,
+    const unsigned int nBoundValues)
+{
+    if (m_nRows > 0 || m_isClosed)
+        throw StatusCodeException(STATUS_CODE_NOT_ALLOWED);
+
+    for (const Column &column : m_columnList)
+    {
+        if (name == column.m_name)
+            throw StatusCodeException(STATUS_CODE_ALREADY_PRESENT);
+    }
+
+    // The offsets table of a jagged column grows by a row at a time too, so is spilled like the values, leaving memory use flat
+    Column column;
+    column.m_name = name;
+    column.m_columnType = columnType;
+    column.m_isJagged = isJagged;
+    column.m_pAddress = pAddress;
+    column.m_nBoundValues = nBoundValues;
+    column.m_pSpillFile = CreateSpillFile(name);
+    column.m_pOffsetsSpillFile = nullptr;
+    column.m_nValues = 0;
+
+    try
+    {
+        if (isJagged)
+        {
+            column.m_pOffsetsSpillFile = CreateSpillFile(name);
+            AppendOffset(column, 0);
+        }
+    }
+    catch (const StatusCodeException &)
+    {
+        std::fclose(column.m_pSpillFile);
+
+        if (column.m_pOffsetsSpillFile)
+            std::fclose(column.m_pOffsetsSpillFile);
+
+        throw;
+    }
+
+    m_columnList.push_back(column);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::FILE *PfoColumnWriter::CreateSpillFile(const std::string &columnName)
+{
+    // Spill files are unlinked as soon as they are created, so they are cleaned up however the process ends
+    const char *const pTemporaryDirectory(std::getenv("TMPDIR"));
+    std::string spillFileName(std::string((pTemporaryDirectory && *pTemporaryDirectory) ? pTemporaryDirectory : "/tmp") + "/LArRecoColumnXXXXXX");
+    const int fileDescriptor(mkstemp(&spillFileName[0]));
+    std::FILE *const pSpillFile((fileDescriptor < 0) ? nullptr : fdopen(fileDescriptor, "w+b"));
+
+    if (!pSpillFile)
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnWriter: unable to create a temporary file for column " << columnName);
+
+        if (fileDescriptor >= 0)
+        {
+            close(fileDescriptor);
+            unlink(spillFileName.c_str());
+        }
+
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+
+    unlink(spillFileName.c_str());
+    return pSpillFile;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnWriter::AppendOffset(const Column &column, const uint64_t offset)
+{
+    if (std::fwrite(&offset, sizeof(offset), 1, column.m_pOffsetsSpillFile) != 1)
+    {
+        LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "PfoColumnWriter: unable to spill offsets of column " << column.m_name);
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+void PfoColumnWriter::AppendVectorValues(const unsigned int columnIndex)
+{
+    const std::vector<T> *const pVector(*static_cast<std::vector<T> *const *>(m_columnList.at(columnIndex).m_pAddress));
+
+    if (pVector)
+        this->AppendValues(columnIndex, pVector->data(), pVector->size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+uint64_t PfoColumnWriter::WriteBlock(std::FILE *const pFile, const void *const pBytes, const uint64_t nBytes, uint64_t &position)
+{
+    static const char padding[COLUMN_BLOCK_ALIGNMENT] = {0};
+    WriteBytes(pFile, padding, (COLUMN_BLOCK_ALIGNMENT - position % COLUMN_BLOCK_ALIGNMENT) % COLUMN_BLOCK_ALIGNMENT, position);
+
+    const uint64_t blockOffset(position);
+    WriteBytes(pFile, pBytes, nBytes, position);
+    return blockOffset;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+uint64_t PfoColumnWriter::CopyBlock(std::FILE *const pFile, std::FILE *const pSpillFile, const uint64_t nBytes, uint64_t &position)
+{
+    const uint64_t blockOffset(WriteBlock(pFile, nullptr, 0, position));
+
+    if ((0 != std::fflush(pSpillFile)) || (0 != std::fseek(pSpillFile, 0, SEEK_SET)))
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+
+    std::vector<char> buffer(1 << 20);
+    uint64_t nBytesCopied(0);
+
+    while (nBytesCopied < nBytes)
+    {
+        const std::size_t nBytesToCopy(std::min(static_cast<uint64_t>(buffer.size()), nBytes - nBytesCopied));
+
+        if (std::fread(buffer.data(), 1, nBytesToCopy, pSpillFile) != nBytesToCopy)
+            throw StatusCodeException(STATUS_CODE_FAILURE);
+
+        WriteBytes(pFile, buffer.data(), nBytesToCopy, position);
+        nBytesCopied += nBytesToCopy;
+    }
+
+    return blockOffset;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnWriter::WriteBytes(std::FILE *const pFile, const void *const pBytes, const uint64_t nBytes, uint64_t &position)
+{
+    if (nBytes > 0 && (std::fwrite(pBytes, 1, nBytes, pFile) != nBytes))
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+
+    position += nBytes;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoColumnWriter::CloseSpillFiles()
+{
+    for (Column &column : m_columnList)
+    {
+        if (column.m_pSpillFile)
+            std::fclose(column.m_pSpillFile);
+
+        if (column.m_pOffsetsSpillFile)
+            std::fclose(column.m_pOffsetsSpillFile);
+
+        column.m_pSpillFile = nullptr;
+        column.m_pOffsetsSpillFile = nullptr;
+    }
+}
+
+} // namespace lar_reco
@@ -0,0 +1,174 @@
+/**
+ *  @file   LArReco/src/PfoEntryIndex.cxx
+ *
+ *  @brief  Implementation of the pfo entry index class.
+ *
+ *  $Log: $
+ */
+
+#include "PfoEntryIndex.h"
+
+#include "TFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace pandora;
+
+namespace
+{
+
+const char *const INDEX_TREE_TITLE("PfoEntryIndex");
+
+/**
+ *  @brief  Compare records by (eventId, pfoId)
+ */
+bool SortByEventAndPfoId(const lar_reco::PfoEntryIndex::Record &lhs, const lar_reco::PfoEntryIndex::Record &rhs)
+{
+    if (lhs.m_eventId != rhs.m_eventId)
+        return (lhs.m_eventId < rhs.m_eventId);
+
+    return (lhs.m_pfoId < rhs.m_pfoId);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_reco
+{
+
+const Long64_t PfoEntryIndex::AUTO_SAVE_RECORDS(100000);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PfoEntryIndex::PfoEntryIndex() :
+    m_nSortedRecords(0),
+    m_pIndexTree(nullptr),
+    m_treeRecord{0, 0, 0}
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+TTree *PfoEntryIndex::CreateTree(const std::string &pfoTreeName)
+{
+    m_pIndexTree = new TTree(GetIndexTreeName(pfoTreeName).c_str(), INDEX_TREE_TITLE);
+    m_pIndexTree->Branch("eventId", &m_treeRecord.m_eventId, "eventId/i");
+    m_pIndexTree->Branch("pfoId", &m_treeRecord.m_pfoId, "pfoId/i");
+    m_pIndexTree->Branch("entry", &m_treeRecord.m_entry, "entry/L");
+    m_pIndexTree->SetAutoSave(AUTO_SAVE_RECORDS);
+
+    return m_pIndexTree;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoEntryIndex::AddEntry(const unsigned int eventId, const unsigned int pfoId, const Long64_t entry)
+{
+    m_records.push_back(Record{eventId, pfoId, entry});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoEntryIndex::EndEvent()
+{
+    // The index tree receives each event's records sorted, so is itself sorted if events end in event id order, as is usual
+    const std::size_t begin(m_nSortedRecords);
+    std::sort(m_records.begin() + begin, m_records.end(), SortByEventAndPfoId);
+
+    if (m_pIndexTree)
+    {
+        for (std::size_t iRecord = begin; iRecord < m_records.size(); ++iRecord)
+        {
+            m_treeRecord = m_records.at(iRecord);
+            m_pIndexTree->Fill();
+        }
+
+        // Once written to the index tree, records serve no lookup or merge, so only the current event's records are held in memory
+        m_records.clear();
+        m_nSortedRecords = 0;
+        return;
+    }
+
+    this->MergeFrom(begin);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoEntryIndex::Append(const PfoEntryIndex &other, const Long64_t entryOffset)
+{
+    for (const Record &record : other.GetRecords())
+        m_records.push_back(Record{record.m_eventId, record.m_pfoId, record.m_entry + entryOffset});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+Long64_t PfoEntryIndex::FindEntry(const unsigned int eventId, const unsigned int pfoId) const
+{
+    const Record target{eventId, pfoId, 0};
+    const RecordVector::const_iterator iter(std::lower_bound(m_records.begin(), m_records.begin() + m_nSortedRecords, target, SortByEventAndPfoId));
+
+    if ((m_records.begin() + m_nSortedRecords == iter) || (iter->m_eventId != eventId) || (iter->m_pfoId != pfoId))
+        return -1;
+
+    return iter->m_entry;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool PfoEntryIndex::Read(TFile *const pTFile, const std::string &pfoTreeName, PfoEntryIndex &pfoEntryIndex)
+{
+    TTree *pIndexTree(nullptr);
+    pTFile->GetObject(GetIndexTreeName(pfoTreeName).c_str(), pIndexTree);
+
+    if (!pIndexTree || !IsIndexTree(pIndexTree))
+        return false;
+
+    Record record{0, 0, 0};
+    pIndexTree->SetBranchAddress("eventId", &record.m_eventId);
+    pIndexTree->SetBranchAddress("pfoId", &record.m_pfoId);
+    pIndexTree->SetBranchAddress("entry", &record.m_entry);
+
+    const std::size_t begin(pfoEntryIndex.m_nSortedRecords);
+    pfoEntryIndex.m_records.reserve(pfoEntryIndex.m_records.size() + pIndexTree->GetEntries());
+
+    for (Long64_t iEntry = 0; iEntry < pIndexTree->GetEntries(); ++iEntry)
+    {
+        pIndexTree->GetEntry(iEntry);
+        pfoEntryIndex.m_records.push_back(record);
+    }
+
+    pIndexTree->ResetBranchAddresses();
+    std::sort(pfoEntryIndex.m_records.begin() + begin, pfoEntryIndex.m_records.end(), SortByEventAndPfoId);
+    pfoEntryIndex.MergeFrom(begin);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+std::string PfoEntryIndex::GetIndexTreeName(const std::string &pfoTreeName)
+{
+    return pfoTreeName + "Index";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool PfoEntryIndex::IsIndexTree(const TTree *const pTree)
+{
+    return (0 == std::strcmp(pTree->GetTitle(), INDEX_TREE_TITLE));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoEntryIndex::MergeFrom(const std::size_t begin)
+{
+    // Events arrive in event id order, so the new records normally follow the sorted ones and no merge is needed
+    if ((begin > 0) && (begin < m_records.size()) && SortByEventAndPfoId(m_records.at(begin), m_records.at(begin - 1)))
+        std::inplace_merge(m_records.begin(), m_records.begin() + begin, m_records.end(), SortByEventAndPfoId);
+
+    m_nSortedRecords = m_records.size();
+}
+
+} // namespace lar_reco
@@ -0,0 +1,74 @@
+/**
+ *  @file   LArReco/src/PfoEventTreeWriter.cxx
+ *
+ *  @brief  Implementation of the pfo event tree writer class.
+ *
+ *  $Log: $
+ */
+
+#include "PfoEventTreeWriter.h"
+
+#include <iostream>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+PfoEventTreeWriter::PfoEventTreeWriter(TTree *const pTree) :
+    m_pTree(pTree),
+    m_nPfos(0)
+{
+    m_pTree->Branch("nPfos", &m_nPfos);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoEventTreeWriter::AddPfo()
+{
+    for (const std::unique_ptr<Variable> &pVariable : m_variableList)
+        pVariable->Append();
+
+    for (unsigned int iGroup = 0; iGroup < m_offsetsGroupList.size(); ++iGroup)
+    {
+        OffsetsGroup &offsetsGroup(*m_offsetsGroupList.at(iGroup));
+        const std::size_t nValues(offsetsGroup.m_variables.front()->GetNValues());
+
+        for (const Variable *const pVariable : offsetsGroup.m_variables)
+        {
+            if (pVariable->GetNValues() != nValues)
+            {
+                std::cout << "PfoEventTreeWriter: vectors sharing offsets " << m_offsetsNames.at(iGroup) << " differ in length" << std::endl;
+                throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+            }
+        }
+
+        offsetsGroup.m_offsets.push_back(nValues);
+    }
+
+    ++m_nPfos;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoEventTreeWriter::Fill()
+{
+    m_pTree->Fill();
+
+    for (const std::unique_ptr<Variable> &pVariable : m_variableList)
+        pVariable->Clear();
+
+    for (const std::unique_ptr<OffsetsGroup> &pOffsetsGroup : m_offsetsGroupList)
+        pOffsetsGroup->m_offsets.resize(1);
+
+    m_nPfos = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool PfoEventTreeWriter::IsEventTree(TTree *const pTree)
+{
+    return (nullptr != pTree->GetBranch("nPfos"));
+}
+
+} // namespace lar_reco
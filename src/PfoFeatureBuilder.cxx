@@ -0,0 +1,299 @@
+/**
+ *  @file   LArReco/src/PfoFeatureBuilder.cxx
+ *
+ *  @brief  Implementation of the pfo feature builder class.
+ *
+ *  $Log: $
+ */
+
+#include "Helpers/XmlHelper.h"
+#include "Xml/tinyxml.h"
+
+#include "PfoFeatureBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+PfoFeatureBuilder::PfoFeatureBuilder() :
+    m_isEnabled(false),
+    m_nProfileBins(5)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode PfoFeatureBuilder::ReadSettings(const TiXmlHandle &xmlHandle)
+{
+    const TiXmlHandle featuresHandle(xmlHandle.FirstChild("PfoFeatures"));
+
+    if (!featuresHandle.Element())
+        return STATUS_CODE_SUCCESS;
+
+    m_isEnabled = true;
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(featuresHandle, "NProfileBins", m_nProfileBins));
+
+    if ((0 == m_nProfileBins) || (m_nProfileBins > PfoFeatures::MAX_PROFILE_BINS))
+    {
+        std::cout << "PfoFeatureBuilder: NProfileBins must be from 1 to " << PfoFeatures::MAX_PROFILE_BINS << std::endl;
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoFeatureBuilder::ComputeThreeD(const float *const pXCoords, const float *const pYCoords, const float *const pZCoords, const float *const pEnergies,
+    const unsigned int nHits, const float *const pVertex, PfoFeatures &features)
+{
+    const float *const pCoords[3] = {pXCoords, pYCoords, pZCoords};
+    this->Compute(pCoords, 3, pEnergies, nHits, pVertex, features);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoFeatureBuilder::ComputeTwoD(const float *const pDriftCoords, const float *const pWireCoords, const float *const pEnergies, const unsigned int nHits,
+    const float *const pVertex, PfoFeatures &features)
+{
+    const float *const pCoords[2] = {pDriftCoords, pWireCoords};
+    this->Compute(pCoords, 2, pEnergies, nHits, pVertex, features);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoFeatureBuilder::Compute(const float *const *const pCoords, const unsigned int nDimensions, const float *const pEnergies, const unsigned int nHits,
+    const float *const pVertex, PfoFeatures &features)
+{
+    std::fill(features.m_eigenvalues, features.m_eigenvalues + 3, 0.f);
+    std::fill(features.m_principalAxis, features.m_principalAxis + 3, 0.f);
+    std::fill(features.m_energyProfile, features.m_energyProfile + PfoFeatures::MAX_PROFILE_BINS, 0.f);
+    features.m_length = 0.f;
+    features.m_hitDensity = 0.f;
+    features.m_vertexDistanceMin = -1.f;
+    features.m_vertexDistanceMean = -1.f;
+    features.m_vertexDistanceRms = -1.f;
+    features.m_vertexDistanceMax = -1.f;
+
+    if (0 == nHits)
+        return;
+
+    // Each pass below runs over a single contiguous coordinate array, so that the element-wise passes vectorise; sums are kept in double
+    double centroid[3] = {0., 0., 0.};
+    double covariance[3][3] = {{0., 0., 0.}, {0., 0., 0.}, {0., 0., 0.}};
+
+    for (unsigned int iDim = 0; iDim < nDimensions; ++iDim)
+    {
+        double sum(0.);
+
+        for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+            sum += pCoords[iDim][iHit];
+
+        centroid[iDim] = sum / nHits;
+    }
+
+    for (unsigned int iDim = 0; iDim < nDimensions; ++iDim)
+    {
+        for (unsigned int jDim = iDim; jDim < nDimensions; ++jDim)
+        {
+            const float *const pI(pCoords[iDim]), *const pJ(pCoords[jDim]);
+            const double centroidI(centroid[iDim]), centroidJ(centroid[jDim]);
+            double sum(0.);
+
+            for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+                sum += (pI[iHit] - centroidI) * (pJ[iHit] - centroidJ);
+
+            covariance[iDim][jDim] = sum / nHits;
+            covariance[jDim][iDim] = sum / nHits;
+        }
+    }
+
+    double eigenvalues[3] = {0., 0., 0.};
+    double eigenvectors[3][3] = {{1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.}};
+    PfoFeatureBuilder::Diagonalise(covariance, nDimensions, eigenvalues, eigenvectors);
+
+    // Orient the axis away from the vertex, or towards larger z (wire) coordinates if there is none
+    double axis[3] = {eigenvectors[0][0], eigenvectors[1][0], eigenvectors[2][0]};
+    double orientation(axis[nDimensions - 1]);
+
+    if (pVertex)
+    {
+        orientation = 0.;
+
+        for (unsigned int iDim = 0; iDim < nDimensions; ++iDim)
+            orientation += (centroid[iDim] - pVertex[iDim]) * axis[iDim];
+    }
+
+    if (orientation < 0.)
+    {
+        for (unsigned int iDim = 0; iDim < nDimensions; ++iDim)
+            axis[iDim] = -axis[iDim];
+    }
+
+    for (unsigned int iDim = 0; iDim < nDimensions; ++iDim)
+    {
+        features.m_eigenvalues[iDim] = static_cast<float>(eigenvalues[iDim]);
+        features.m_principalAxis[iDim] = static_cast<float>(axis[iDim]);
+    }
+
+    // Positions along the axis, the extent and the energy profile
+    m_projections.assign(nHits, 0.f);
+    float *const pProjections(m_projections.data());
+
+    for (unsigned int iDim = 0; iDim < nDimensions; ++iDim)
+    {
+        const float *const pCoord(pCoords[iDim]);
+        const float centroidCoord(static_cast<float>(centroid[iDim])), axisCoord(static_cast<float>(axis[iDim]));
+
+        for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+            pProjections[iHit] += (pCoord[iHit] - centroidCoord) * axisCoord;
+    }
+
+    const std::pair<const float*, const float*> projectionRange(std::minmax_element(pProjections, pProjections + nHits));
+    const float minProjection(*projectionRange.first);
+    features.m_length = *projectionRange.second - minProjection;
+    features.m_hitDensity = (features.m_length > 0.f) ? nHits / features.m_length : 0.f;
+
+    const float binScale((features.m_length > 0.f) ? m_nProfileBins / features.m_length : 0.f);
+    const int lastBin(static_cast<int>(m_nProfileBins) - 1);
+    double totalEnergy(0.);
+
+    for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+    {
+        const int bin(std::min(static_cast<int>((pProjections[iHit] - minProjection) * binScale), lastBin));
+        features.m_energyProfile[bin] += pEnergies[iHit];
+        totalEnergy += pEnergies[iHit];
+    }
+
+    if (totalEnergy > 0.)
+    {
+        for (unsigned int iBin = 0; iBin < m_nProfileBins; ++iBin)
+            features.m_energyProfile[iBin] = static_cast<float>(features.m_energyProfile[iBin] / totalEnergy);
+    }
+
+    if (!pVertex)
+        return;
+
+    // Distances from the vertex
+    m_distances.assign(nHits, 0.f);
+    float *const pDistances(m_distances.data());
+
+    for (unsigned int iDim = 0; iDim < nDimensions; ++iDim)
+    {
+        const float *const pCoord(pCoords[iDim]);
+        const float vertexCoord(pVertex[iDim]);
+
+        for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+            pDistances[iHit] += (pCoord[iHit] - vertexCoord) * (pCoord[iHit] - vertexCoord);
+    }
+
+    for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+        pDistances[iHit] = std::sqrt(pDistances[iHit]);
+
+    double distanceSum(0.), distanceSquaredSum(0.);
+
+    for (unsigned int iHit = 0; iHit < nHits; ++iHit)
+    {
+        distanceSum += pDistances[iHit];
+        distanceSquaredSum += pDistances[iHit] * pDistances[iHit];
+    }
+
+    const double meanDistance(distanceSum / nHits);
+    const std::pair<const float*, const float*> distanceRange(std::minmax_element(pDistances, pDistances + nHits));
+    features.m_vertexDistanceMin = *distanceRange.first;
+    features.m_vertexDistanceMax = *distanceRange.second;
+    features.m_vertexDistanceMean = static_cast<float>(meanDistance);
+    features.m_vertexDistanceRms = static_cast<float>(std::sqrt(std::max(0., distanceSquaredSum / nHits - meanDistance * meanDistance)));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoFeatureBuilder::Diagonalise(double matrix[3][3], const unsigned int nDimensions, double eigenvalues[3], double eigenvectors[3][3])
+{
+    for (unsigned int iDim = 0; iDim < 3; ++iDim)
+    {
+        for (unsigned int jDim = 0; jDim < 3; ++jDim)
+            eigenvectors[iDim][jDim] = (iDim == jDim) ? 1. : 0.;
+    }
+
+    // Cyclic Jacobi sweeps, each rotation zeroing one off-diagonal element; a handful of sweeps converge for a matrix of this size
+    for (unsigned int iSweep = 0; iSweep < 50; ++iSweep)
+    {
+        double offDiagonal(0.), diagonal(0.);
+
+        for (unsigned int p = 0; p < nDimensions; ++p)
+        {
+            diagonal += matrix[p][p] * matrix[p][p];
+
+            for (unsigned int q = p + 1; q < nDimensions; ++q)
+                offDiagonal += matrix[p][q] * matrix[p][q];
+        }
+
+        if (offDiagonal <= 1.e-24 * diagonal)
+            break;
+
+        for (unsigned int p = 0; p < nDimensions; ++p)
+        {
+            for (unsigned int q = p + 1; q < nDimensions; ++q)
+            {
+                if (0. == matrix[p][q])
+                    continue;
+
+                const double theta((matrix[q][q] - matrix[p][p]) / (2. * matrix[p][q]));
+                const double t(((theta < 0.) ? -1. : 1.) / (std::fabs(theta) + std::sqrt(theta * theta + 1.)));
+                const double c(1. / std::sqrt(t * t + 1.)), s(t * c);
+
+                for (unsigned int k = 0; k < nDimensions; ++k)
+                {
+                    const double kp(matrix[k][p]), kq(matrix[k][q]);
+                    matrix[k][p] = c * kp - s * kq;
+                    matrix[k][q] = s * kp + c * kq;
+                }
+
+                for (unsigned int k = 0; k < nDimensions; ++k)
+                {
+                    const double pk(matrix[p][k]), qk(matrix[q][k]);
+                    matrix[p][k] = c * pk - s * qk;
+                    matrix[q][k] = s * pk + c * qk;
+                }
+
+                for (unsigned int k = 0; k < nDimensions; ++k)
+                {
+                    const double kp(eigenvectors[k][p]), kq(eigenvectors[k][q]);
+                    eigenvectors[k][p] = c * kp - s * kq;
+                    eigenvectors[k][q] = s * kp + c * kq;
+                }
+            }
+        }
+    }
+
+    for (unsigned int iDim = 0; iDim < nDimensions; ++iDim)
+        eigenvalues[iDim] = matrix[iDim][iDim];
+
+    // Order the eigenvalues, and their eigenvector columns, largest first
+    for (unsigned int iDim = 0; iDim < nDimensions; ++iDim)
+    {
+        unsigned int largest(iDim);
+
+        for (unsigned int jDim = iDim + 1; jDim < nDimensions; ++jDim)
+        {
+            if (eigenvalues[jDim] > eigenvalues[largest])
+                largest = jDim;
+        }
+
+        if (largest == iDim)
+            continue;
+
+        std::swap(eigenvalues[iDim], eigenvalues[largest]);
+
+        for (unsigned int k = 0; k < 3; ++k)
+            std::swap(eigenvectors[k][iDim], eigenvectors[k][largest]);
+    }
+}
+
+} // namespace lar_reco
@@ -0,0 +1,156 @@
+/**
+ *  @file   LArReco/src/PfoHitCache.cxx
+ *
+ *  @brief  Implementation of the pfo hit cache class.
+ *
+ *  $Log: $
+ */
+
+#include "Pandora/AlgorithmHeaders.h"
+
+#include "larpandoracontent/LArHelpers/LArClusterHelper.h"
+
+#include "PfoHitCache.h"
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+void PfoHitCache::Fill(const PfoList &pfoList)
+{
+    // Buffers are cleared rather than released, so their capacity carries over from one event to the next
+    m_pfoToViewBoundariesMap.clear();
+    m_caloHits.clear();
+    m_xCoords.clear();
+    m_yCoords.clear();
+    m_zCoords.clear();
+    m_xCoordErrors.clear();
+    m_energies.clear();
+
+    m_pfoToViewBoundariesMap.reserve(pfoList.size());
+
+    for (const ParticleFlowObject *const pPfo : pfoList)
+        this->AddPfo(pPfo);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PfoHitCache::HitRange PfoHitCache::GetHitRange(const ParticleFlowObject *const pPfo, const HitType hitType) const
+{
+    const unsigned int viewIndex(PfoHitCache::GetViewIndex(hitType));
+
+    if (N_VIEWS == viewIndex)
+        throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+
+    const ViewBoundaries &viewBoundaries(this->GetViewBoundaries(pPfo));
+
+    HitRange hitRange;
+    hitRange.m_begin = viewBoundaries.at(viewIndex);
+    hitRange.m_end = viewBoundaries.at(viewIndex + 1);
+    return hitRange;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PfoHitCache::HitRange PfoHitCache::GetTwoDHitRange(const ParticleFlowObject *const pPfo) const
+{
+    const ViewBoundaries &viewBoundaries(this->GetViewBoundaries(pPfo));
+
+    HitRange hitRange;
+    hitRange.m_begin = viewBoundaries.at(PfoHitCache::GetViewIndex(TPC_VIEW_U));
+    hitRange.m_end = viewBoundaries.at(PfoHitCache::GetViewIndex(TPC_VIEW_W) + 1);
+    return hitRange;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoHitCache::AddPfo(const ParticleFlowObject *const pPfo)
+{
+    if (m_pfoToViewBoundariesMap.count(pPfo))
+        return;
+
+    // A single walk over the clusters sorts them by view, keeping their order within each view
+    for (std::vector<const Cluster*> &clusterList : m_viewClusterLists)
+        clusterList.clear();
+
+    for (const Cluster *const pCluster : pPfo->GetClusterList())
+    {
+        const unsigned int viewIndex(PfoHitCache::GetViewIndex(lar_content::LArClusterHelper::GetClusterHitType(pCluster)));
+
+        if (N_VIEWS != viewIndex)
+            m_viewClusterLists.at(viewIndex).push_back(pCluster);
+    }
+
+    ViewBoundaries viewBoundaries;
+
+    for (unsigned int viewIndex = 0; viewIndex < N_VIEWS; ++viewIndex)
+    {
+        viewBoundaries.at(viewIndex) = m_caloHits.size();
+
+        for (const Cluster *const pCluster : m_viewClusterLists.at(viewIndex))
+        {
+            for (const OrderedCaloHitList::value_type &layerEntry : pCluster->GetOrderedCaloHitList())
+            {
+                for (const CaloHit *const pCaloHit : *layerEntry.second)
+                    this->AddCaloHit(pCaloHit);
+            }
+        }
+
+        for (const Cluster *const pCluster : m_viewClusterLists.at(viewIndex))
+        {
+            for (const CaloHit *const pCaloHit : pCluster->GetIsolatedCaloHitList())
+                this->AddCaloHit(pCaloHit);
+        }
+    }
+
+    viewBoundaries.at(N_VIEWS) = m_caloHits.size();
+    m_pfoToViewBoundariesMap.emplace(pPfo, viewBoundaries);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoHitCache::AddCaloHit(const CaloHit *const pCaloHit)
+{
+    const CartesianVector &positionVector(pCaloHit->GetPositionVector());
+
+    m_caloHits.push_back(pCaloHit);
+    m_xCoords.push_back(positionVector.GetX());
+    m_yCoords.push_back(positionVector.GetY());
+    m_zCoords.push_back(positionVector.GetZ());
+    m_xCoordErrors.push_back(pCaloHit->GetCellSize1());
+    m_energies.push_back(pCaloHit->GetInputEnergy());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const PfoHitCache::ViewBoundaries &PfoHitCache::GetViewBoundaries(const ParticleFlowObject *const pPfo) const
+{
+    const PfoToViewBoundariesMap::const_iterator iter(m_pfoToViewBoundariesMap.find(pPfo));
+
+    if (m_pfoToViewBoundariesMap.end() == iter)
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+
+    return iter->second;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int PfoHitCache::GetViewIndex(const HitType hitType)
+{
+    switch (hitType)
+    {
+    case TPC_VIEW_U:
+        return 0;
+    case TPC_VIEW_V:
+        return 1;
+    case TPC_VIEW_W:
+        return 2;
+    case TPC_3D:
+        return 3;
+    default:
+        return N_VIEWS;
+    }
+}
+
+} // namespace lar_reco
@@ -0,0 +1,135 @@
+/**
+ *  @file   LArReco/src/PfoTaskPool.cxx
+ *
+ *  @brief  Implementation of the pfo task pool class.
+ *
+ *  $Log: $
+ */
+
+#include "PfoTaskPool.h"
+
+#include <algorithm>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+PfoTaskPool::PfoTaskPool(const unsigned int nWorkers) :
+    m_nWorkers(std::max(1u, nWorkers)),
+    m_pTaskFunction(nullptr),
+    m_nTasks(0),
+    m_nextTask(0),
+    m_nActiveWorkers(0),
+    m_batch(0),
+    m_isStopping(false)
+{
+    for (unsigned int iWorker = 1; iWorker < m_nWorkers; ++iWorker)
+        m_threads.emplace_back(&PfoTaskPool::ThreadLoop, this, iWorker);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PfoTaskPool::~PfoTaskPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+
+    m_batchCondition.notify_all();
+
+    for (std::thread &thread : m_threads)
+        thread.join();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoTaskPool::Run(const unsigned int nTasks, const TaskFunction &taskFunction)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_pTaskFunction = &taskFunction;
+        m_nTasks = nTasks;
+        m_nextTask = 0;
+        m_nActiveWorkers = m_threads.size();
+        m_exception = nullptr;
+        ++m_batch;
+    }
+
+    m_batchCondition.notify_all();
+    this->RunTasks(0);
+
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this]() { return (0 == m_nActiveWorkers); });
+        m_pTaskFunction = nullptr;
+        exception = m_exception;
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoTaskPool::RunTasks(const unsigned int iWorker)
+{
+    while (true)
+    {
+        unsigned int iTask(0);
+        {
+            // Tasks are coarse, so a locked counter costs nothing measurable, and a failed batch stops handing out tasks
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            if ((m_nextTask >= m_nTasks) || m_exception)
+                return;
+
+            iTask = m_nextTask++;
+        }
+
+        try
+        {
+            (*m_pTaskFunction)(iTask, iWorker);
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            if (!m_exception)
+                m_exception = std::current_exception();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PfoTaskPool::ThreadLoop(const unsigned int iWorker)
+{
+    unsigned long long lastBatch(0);
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_batchCondition.wait(lock, [&]() { return (m_isStopping || (m_batch != lastBatch)); });
+
+            if (m_isStopping)
+                return;
+
+            lastBatch = m_batch;
+        }
+
+        this->RunTasks(iWorker);
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            --m_nActiveWorkers;
+        }
+
+        m_doneCondition.notify_one();
+    }
+}
+
+} // namespace lar_reco
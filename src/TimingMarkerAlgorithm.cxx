@@ -0,0 +1,42 @@
+/**
+ *  @file   LArReco/src/TimingMarkerAlgorithm.cxx
+ *
+ *  @brief  Implementation of the timing marker algorithm class.
+ *
+ *  $Log: $
+ */
+
+#include "Pandora/AlgorithmHeaders.h"
+
+#include "AlgorithmTimer.h"
+#include "TimingMarkerAlgorithm.h"
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+TimingMarkerAlgorithm::TimingMarkerAlgorithm(AlgorithmTimer *const pAlgorithmTimer) :
+    m_pAlgorithmTimer(pAlgorithmTimer)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode TimingMarkerAlgorithm::Run()
+{
+    m_pAlgorithmTimer->Mark(&this->GetPandora(), m_instanceLabel, m_timedAlgorithm);
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode TimingMarkerAlgorithm::ReadSettings(const TiXmlHandle xmlHandle)
+{
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, XmlHelper::ReadValue(xmlHandle, "InstanceLabel", m_instanceLabel));
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle, "TimedAlgorithm", m_timedAlgorithm));
+
+    return STATUS_CODE_SUCCESS;
+}
+
+} // namespace lar_reco
@@ -0,0 +1,36 @@
+/**
+ *  @file   LArReco/src/TimingMasterAlgorithm.cxx
+ *
+ *  @brief  Implementation of the timing master algorithm class.
+ *
+ *  $Log: $
+ */
+
+#include "Api/PandoraApi.h"
+#include "Pandora/AlgorithmHeaders.h"
+
+#include "AlgorithmTimer.h"
+#include "TimingMarkerAlgorithm.h"
+#include "TimingMasterAlgorithm.h"
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+TimingMasterAlgorithm::TimingMasterAlgorithm(AlgorithmTimer *const pAlgorithmTimer) :
+    m_pAlgorithmTimer(pAlgorithmTimer)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+StatusCode TimingMasterAlgorithm::RegisterCustomContent(const Pandora *const pPandora) const
+{
+    PANDORA_RETURN_RESULT_IF(STATUS_CODE_SUCCESS, !=, PandoraApi::RegisterAlgorithmFactory(*pPandora, AlgorithmTimer::MARKER_ALGORITHM_TYPE,
+        new TimingMarkerAlgorithm::Factory(m_pAlgorithmTimer)));
+
+    return STATUS_CODE_SUCCESS;
+}
+
+} // namespace lar_reco
@@ -0,0 +1,185 @@
+/**
+ *  @file   LArReco/src/WriteBehindQueue.cxx
+ *
+ *  @brief  Implementation of the write-behind queue class.
+ *
+ *  $Log: $
+ */
+
+#include "WriteBehindQueue.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+using namespace pandora;
+
+namespace lar_reco
+{
+
+WriteBehindQueue::WriteBehindQueue(const unsigned int nSlots) :
+    m_slots(std::max(nSlots, 1U)),
+    m_head(0),
+    m_nQueued(0),
+    m_isClosing(false),
+    m_hasFailed(false)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+WriteBehindQueue::~WriteBehindQueue()
+{
+    try
+    {
+        this->Close();
+    }
+    catch (const StatusCodeException &)
+    {
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void WriteBehindQueue::Start(const OutputFunction &fillFunction, const OutputFunction &endEventFunction)
+{
+    if (m_thread.joinable())
+        throw StatusCodeException(STATUS_CODE_ALREADY_INITIALIZED);
+
+    m_fillFunction = fillFunction;
+    m_endEventFunction = endEventFunction;
+    m_thread = std::thread(&WriteBehindQueue::Run, this);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void WriteBehindQueue::PushRecord()
+{
+    this->Push(false);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void WriteBehindQueue::PushEndEvent()
+{
+    this->Push(true);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void WriteBehindQueue::Close()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isClosing = true;
+        }
+
+        m_queuedCondition.notify_one();
+        m_thread.join();
+    }
+
+    this->CheckOutputThread();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void WriteBehindQueue::Push(const bool isEndEvent)
+{
+    if (!m_thread.joinable())
+        throw StatusCodeException(STATUS_CODE_NOT_INITIALIZED);
+
+    // Back pressure: wait for the output thread to free a slot. The slot after the queued ones is then owned by this thread until queued
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_freeCondition.wait(lock, [this]() { return (m_nQueued < m_slots.size()) || m_hasFailed; });
+
+    if (m_hasFailed)
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+
+    Record &record(m_slots.at((m_head + m_nQueued) % m_slots.size()));
+    lock.unlock();
+
+    // End of event markers carry only the event-level variables, so that event-level outputs see the values at the end of the event
+    record.m_isEndEvent = isEndEvent;
+    record.m_bytes.clear();
+
+    if (isEndEvent)
+    {
+        for (const Binding *const pBinding : m_eventBindingList)
+            pBinding->Save(record.m_bytes);
+    }
+    else
+    {
+        for (const std::unique_ptr<Binding> &pBinding : m_bindingList)
+            pBinding->Save(record.m_bytes);
+    }
+
+    lock.lock();
+    ++m_nQueued;
+    lock.unlock();
+    m_queuedCondition.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void WriteBehindQueue::CheckOutputThread() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_hasFailed)
+        throw StatusCodeException(STATUS_CODE_FAILURE);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void WriteBehindQueue::Run()
+{
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queuedCondition.wait(lock, [this]() { return (m_nQueued > 0) || m_isClosing; });
+
+        if (0 == m_nQueued)
+            return;
+
+        // The head slot is owned by this thread until freed, so is written out without holding the lock
+        lock.unlock();
+        const Record &record(m_slots.at(m_head));
+
+        try
+        {
+            const char *pBytes(record.m_bytes.data());
+
+            if (record.m_isEndEvent)
+            {
+                for (Binding *const pBinding : m_eventBindingList)
+                    pBinding->Restore(pBytes);
+
+                m_endEventFunction();
+            }
+            else
+            {
+                for (const std::unique_ptr<Binding> &pBinding : m_bindingList)
+                    pBinding->Restore(pBytes);
+
+                m_fillFunction();
+            }
+        }
+        catch (const StatusCodeException &statusCodeException)
+        {
+            LAR_RECO_LOG(Logger::GetDefault(), LOG_ERROR, "WriteBehindQueue: output failed, " << statusCodeException.ToString());
+            lock.lock();
+            m_hasFailed = true;
+            m_freeCondition.notify_one();
+            return;
+        }
+
+        lock.lock();
+        m_head = (m_head + 1) % m_slots.size();
+        --m_nQueued;
+        lock.unlock();
+        m_freeCondition.notify_one();
+    }
+}
+
+} // namespace lar_reco